@@ -0,0 +1,13 @@
+#ifndef _flv_iovec_h_
+#define _flv_iovec_h_
+
+#include <stddef.h>
+
+/// scatter-gather buffer: tag header/NALU length or payload slice(same layout as rtmp_iovec_t)
+struct flv_iovec_t
+{
+	const void* base;
+	size_t len;
+};
+
+#endif /* !_flv_iovec_h_ */
@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include "flv-iovec.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -17,9 +18,22 @@ typedef struct flv_muxer_t flv_muxer_t;
 ///@return 0-ok, other-error
 typedef int (*flv_muxer_handler)(void* param, int type, const void* data, size_t bytes, uint32_t timestamp);
 
+///Scatter-gather output, same tag data as flv_muxer_handler without copy
+///Video: vec[0] VideoTagHeader, then 4-bytes NALU length + NALU(slice of flv_muxer_avc/flv_muxer_hevc input) pairs
+///Audio: vec[0] AudioTagHeader, vec[1] frame data(slice of input)
+///@param[in] vec valid in callback only, sequence header/metadata in one buffer
+///@param[in] type 8-audio, 9-video, 18-script
+///@return 0-ok, other-error
+typedef int (*flv_muxer_handlerv)(void* param, int type, const struct flv_iovec_t* vec, int n, uint32_t timestamp);
+
 flv_muxer_t* flv_muxer_create(flv_muxer_handler handler, void* param);
 void flv_muxer_destroy(flv_muxer_t* muxer);
 
+/// Output all tags with handlerv instead of handler(flv_muxer_create param)
+/// @param[in] handler NULL-contiguous output(default)
+/// @return 0-ok, other-error
+int flv_muxer_set_handlerv(flv_muxer_t* muxer, flv_muxer_handlerv handler);
+
 /// re-create AAC/AVC sequence header
 int flv_muxer_reset(flv_muxer_t* muxer);
 
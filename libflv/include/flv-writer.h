@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include "flv-iovec.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -20,6 +21,9 @@ void flv_writer_destroy(void* flv);
 /// @return 0-ok, other-error
 int flv_writer_input(void* flv, int type, const void* data, size_t bytes, uint32_t timestamp);
 
+/// same as flv_writer_input, FLV Audio/Video Data in scatter-gather buffers(flv_muxer_handlerv)
+int flv_writer_inputv(void* flv, int type, const struct flv_iovec_t* vec, int n, uint32_t timestamp);
+
 #if defined(__cplusplus)
 }
 #endif
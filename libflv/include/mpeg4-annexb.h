@@ -0,0 +1,158 @@
+#ifndef _mpeg4_annexb_h_
+#define _mpeg4_annexb_h_
+
+// H.264/H.265 Annex B byte stream start code(00 00 01) scanner.
+// Header only, so libmpeg/librtp/libhls can use it without linking libflv.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+		#define MPEG4_ANNEXB_SSE2
+	#endif
+	#if defined(__AVX2__)
+		#include <immintrin.h>
+		#define MPEG4_ANNEXB_AVX2
+	#elif (defined(__GNUC__) && __GNUC__ >= 5 && !defined(__INTEL_COMPILER)) || defined(__clang__)
+		#include <immintrin.h>
+		#define MPEG4_ANNEXB_AVX2
+		#define MPEG4_ANNEXB_AVX2_RUNTIME // built without -mavx2, check cpu at runtime
+	#endif
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+	#include <arm_neon.h>
+	#define MPEG4_ANNEXB_NEON
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+static inline int mpeg4_annexb_ctz(uint32_t mask)
+{
+#if defined(_MSC_VER)
+	unsigned long i;
+	_BitScanForward(&i, mask);
+	return (int)i;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+static inline const uint8_t* mpeg4_annexb_startcode_c(const uint8_t* p, const uint8_t* end)
+{
+	while (end - p >= 3)
+	{
+		if (p[2] > 1)
+			p += 3; // p[2] can't be any byte of a start code at p, p+1, p+2
+		else if (0 != p[1])
+			p += 2;
+		else if (0 != p[0] || 1 != p[2])
+			p += 1;
+		else
+			return p;
+	}
+	return NULL;
+}
+
+#if defined(MPEG4_ANNEXB_SSE2)
+static inline const uint8_t* mpeg4_annexb_startcode_sse2(const uint8_t* p, const uint8_t* end)
+{
+	uint32_t mask;
+	__m128i zero, one, a, b, c;
+
+	zero = _mm_setzero_si128();
+	one = _mm_set1_epi8(1);
+	for (; end - p >= 18; p += 16)
+	{
+		a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), zero);
+		b = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 1)), zero);
+		c = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 2)), one);
+		mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(a, b), c));
+		if (mask)
+			return p + mpeg4_annexb_ctz(mask);
+	}
+	return mpeg4_annexb_startcode_c(p, end);
+}
+#endif
+
+#if defined(MPEG4_ANNEXB_AVX2)
+#if defined(MPEG4_ANNEXB_AVX2_RUNTIME)
+__attribute__((target("avx2")))
+#endif
+static inline const uint8_t* mpeg4_annexb_startcode_avx2(const uint8_t* p, const uint8_t* end)
+{
+	uint32_t mask;
+	__m256i zero, one, a, b, c;
+
+	zero = _mm256_setzero_si256();
+	one = _mm256_set1_epi8(1);
+	for (; end - p >= 34; p += 32)
+	{
+		a = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), zero);
+		b = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + 1)), zero);
+		c = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + 2)), one);
+		mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(a, b), c));
+		if (mask)
+			return p + mpeg4_annexb_ctz(mask);
+	}
+	return mpeg4_annexb_startcode_c(p, end);
+}
+#endif
+
+#if defined(MPEG4_ANNEXB_NEON)
+static inline const uint8_t* mpeg4_annexb_startcode_neon(const uint8_t* p, const uint8_t* end)
+{
+	uint8x16_t zero, one, a, b, c;
+
+	zero = vdupq_n_u8(0);
+	one = vdupq_n_u8(1);
+	for (; end - p >= 18; p += 16)
+	{
+		a = vceqq_u8(vld1q_u8(p), zero);
+		b = vceqq_u8(vld1q_u8(p + 1), zero);
+		c = vceqq_u8(vld1q_u8(p + 2), one);
+		if (vmaxvq_u8(vandq_u8(vandq_u8(a, b), c)))
+			return mpeg4_annexb_startcode_c(p, p + 18); // no movemask, locate it in the block
+	}
+	return mpeg4_annexb_startcode_c(p, end);
+}
+#endif
+
+/// Find the first start code(00 00 01) in [p, end)
+/// @return pointer to the first 0x00 of the start code, NULL if not found
+static inline const uint8_t* mpeg4_annexb_startcode(const uint8_t* p, const uint8_t* end)
+{
+#if defined(MPEG4_ANNEXB_AVX2_RUNTIME)
+	if (__builtin_cpu_supports("avx2"))
+		return mpeg4_annexb_startcode_avx2(p, end);
+#endif
+
+#if defined(MPEG4_ANNEXB_AVX2) && !defined(MPEG4_ANNEXB_AVX2_RUNTIME)
+	return mpeg4_annexb_startcode_avx2(p, end);
+#elif defined(MPEG4_ANNEXB_SSE2)
+	return mpeg4_annexb_startcode_sse2(p, end);
+#elif defined(MPEG4_ANNEXB_NEON)
+	return mpeg4_annexb_startcode_neon(p, end);
+#else
+	return mpeg4_annexb_startcode_c(p, end);
+#endif
+}
+
+/// Find the first NALU which has at least one byte after the start code
+/// @return pointer to the NALU(after 00 00 01), NULL if not found
+static inline const uint8_t* mpeg4_annexb_nalu_find(const uint8_t* p, const uint8_t* end)
+{
+	p = end - p > 3 ? mpeg4_annexb_startcode(p, end - 1) : NULL;
+	return p ? p + 3 : NULL;
+}
+
+#if defined(__cplusplus)
+}
+#endif
+#endif /* !_mpeg4_annexb_h_ */
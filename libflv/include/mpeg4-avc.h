@@ -48,6 +48,10 @@ int mpeg4_avc_to_nalu(const struct mpeg4_avc_t* avc, uint8_t* data, size_t bytes
 
 int mpeg4_avc_codecs(const struct mpeg4_avc_t* avc, char* codecs, size_t bytes);
 
+/// update SPS/PPS with one NALU(without start code), other NALU ignored
+/// @return 1-SPS/PPS changed, 0-no change, <0-error
+int mpeg4_avc_update(struct mpeg4_avc_t* avc, const uint8_t* nalu, int bytes);
+
 /// @param[out] vcl 0-non VCL, 1-IDR, 2-P/B
 /// @return <=0-error, >0-output bytes
 int h264_annexbtomp4(struct mpeg4_avc_t* avc, const void* data, int bytes, void* out, int size, int* vcl, int* update);
@@ -16,9 +16,14 @@
 
 #define FLV_MUXER "libflv"
 
+#define H264_NAL_AUD		9 // Access unit delimiter
+#define H265_NAL_VPS		32
+#define H265_NAL_AUD		35
+
 struct flv_muxer_t
 {
 	flv_muxer_handler handler;
+	flv_muxer_handlerv handlerv; // scatter-gather output
 	void* param;
 
 	uint8_t audio_sequence_header;
@@ -41,6 +46,18 @@ struct flv_muxer_t
 	uint8_t* ptr;
 	int bytes;
 	int capacity;
+
+	// handlerv: vec[0] tag header, then NALU length(in ptr) + NALU(in input) pairs
+	struct flv_iovec_t* vec;
+	int vec_count;
+	int vec_capacity;
+};
+
+struct flv_muxer_nalu_t
+{
+	struct flv_muxer_t* flv;
+	int codecid; // FLV_VIDEO_H264/FLV_VIDEO_H265
+	int errcode;
 };
 
 struct flv_muxer_t* flv_muxer_create(flv_muxer_handler handler, void* param)
@@ -65,9 +82,22 @@ void flv_muxer_destroy(struct flv_muxer_t* flv)
 		flv->ptr = NULL;
 	}
 
+	if (flv->vec)
+	{
+		assert(flv->vec_capacity > 0);
+		free(flv->vec);
+		flv->vec = NULL;
+	}
+
 	free(flv);
 }
 
+int flv_muxer_set_handlerv(struct flv_muxer_t* flv, flv_muxer_handlerv handler)
+{
+	flv->handlerv = handler;
+	return 0;
+}
+
 int flv_muxer_reset(struct flv_muxer_t* flv)
 {
 	memset(&flv->v, 0, sizeof(flv->v));
@@ -88,6 +118,36 @@ static int flv_muxer_alloc(struct flv_muxer_t* flv, int bytes)
 	return 0;
 }
 
+/// @param[in] data tag data(sequence header/metadata) in flv->ptr
+static int flv_muxer_write(struct flv_muxer_t* flv, int type, const void* data, size_t bytes, uint32_t timestamp)
+{
+	struct flv_iovec_t vec;
+	if (!flv->handlerv)
+		return flv->handler(flv->param, type, data, bytes, timestamp);
+
+	vec.base = data;
+	vec.len = bytes;
+	return flv->handlerv(flv->param, type, &vec, 1, timestamp);
+}
+
+/// @param[in] n tag header length in flv->ptr
+/// @param[in] data frame data, copy after tag header if no handlerv
+static int flv_muxer_write2(struct flv_muxer_t* flv, int type, int n, const void* data, size_t bytes, uint32_t timestamp)
+{
+	struct flv_iovec_t vec[2];
+	if (!flv->handlerv)
+	{
+		memcpy(flv->ptr + n, data, bytes);
+		return flv->handler(flv->param, type, flv->ptr, n + bytes, timestamp);
+	}
+
+	vec[0].base = flv->ptr;
+	vec[0].len = n;
+	vec[1].base = data;
+	vec[1].len = bytes;
+	return flv->handlerv(flv->param, type, vec, 2, timestamp);
+}
+
 int flv_muxer_mp3(struct flv_muxer_t* flv, const void* data, size_t sz, uint32_t pts, uint32_t dts)
 {
     int bytes;
@@ -123,8 +183,7 @@ int flv_muxer_mp3(struct flv_muxer_t* flv, const void* data, size_t sz, uint32_t
 	audio.codecid = FLV_AUDIO_MP3;
 	audio.avpacket = FLV_AVPACKET;
 	flv_audio_tag_header_write(&audio, flv->ptr, 1);
-	memcpy(flv->ptr + 1, data, bytes); // MP3
-	return flv->handler(flv->param, FLV_TYPE_AUDIO, flv->ptr, bytes + 1, dts);
+	return flv_muxer_write2(flv, FLV_TYPE_AUDIO, 1, data, bytes, dts); // MP3
 }
 
 int flv_muxer_aac(struct flv_muxer_t* flv, const void* data, size_t sz, uint32_t pts, uint32_t dts)
@@ -158,20 +217,19 @@ int flv_muxer_aac(struct flv_muxer_t* flv, const void* data, size_t sz, uint32_t
 		flv_audio_tag_header_write(&audio, flv->ptr, flv->capacity);
 		m = mpeg4_aac_audio_specific_config_save(&flv->a.aac, flv->ptr + 2, flv->capacity - 2);
 		assert(m + 2 <= (int)flv->capacity);
-		r = flv->handler(flv->param, FLV_TYPE_AUDIO, flv->ptr, m + 2, dts);
+		r = flv_muxer_write(flv, FLV_TYPE_AUDIO, flv->ptr, m + 2, dts);
 		if (0 != r) return r;
 	}
 
 	audio.avpacket = FLV_AVPACKET;
 	flv_audio_tag_header_write(&audio, flv->ptr, flv->capacity);
-	memcpy(flv->ptr + 2, (uint8_t*)data + n, bytes - n); // AAC exclude ADTS
 	assert(bytes - n + 2 <= (int)flv->capacity);
-	return flv->handler(flv->param, FLV_TYPE_AUDIO, flv->ptr, bytes - n + 2, dts);
+	return flv_muxer_write2(flv, FLV_TYPE_AUDIO, 2, (uint8_t*)data + n, bytes - n, dts); // AAC exclude ADTS
 }
 
 int flv_muxer_opus(flv_muxer_t* flv, const void* data, size_t sz, uint32_t pts, uint32_t dts)
 {
-	int r, m, bytes;
+	int m, bytes;
 	struct flv_audio_tag_header_t audio;
 	(void)pts;
 
@@ -198,16 +256,130 @@ int flv_muxer_opus(flv_muxer_t* flv, const void* data, size_t sz, uint32_t pts,
 		// Opus Head
 		m = flv_audio_tag_header_write(&audio, flv->ptr, flv->capacity);
 		assert(m + bytes <= (int)flv->capacity);
-		memcpy(flv->ptr + m, data, bytes);
-		r = flv->handler(flv->param, FLV_TYPE_AUDIO, flv->ptr, m + bytes, dts);
-		return r;
+		return flv_muxer_write2(flv, FLV_TYPE_AUDIO, m, data, bytes, dts);
 	}
 
 	audio.avpacket = FLV_AVPACKET;
 	m = flv_audio_tag_header_write(&audio, flv->ptr, flv->capacity);
-	memcpy(flv->ptr + m, (uint8_t*)data, bytes);
 	assert(bytes - m <= (int)flv->capacity);
-	return flv->handler(flv->param, FLV_TYPE_AUDIO, flv->ptr, bytes + m, dts);
+	return flv_muxer_write2(flv, FLV_TYPE_AUDIO, m, data, bytes, dts);
+}
+
+static void flv_muxer_nalu(void* param, const uint8_t* nalu, int bytes)
+{
+	int r;
+	void* p;
+	uint8_t nalutype;
+	struct flv_muxer_t* flv;
+	struct flv_muxer_nalu_t* h;
+	h = (struct flv_muxer_nalu_t*)param;
+	flv = h->flv;
+
+	if (FLV_VIDEO_H265 == h->codecid)
+	{
+		nalutype = (nalu[0] >> 1) & 0x3f;
+#if defined(H2645_FILTER_AUD)
+		if (H265_NAL_AUD == nalutype)
+			return; // ignore AUD
+#endif
+		r = mpeg4_hevc_update(&flv->v.hevc, nalu, bytes);
+
+		// IRAP-1, B/P-2, other-0
+		if (nalutype < H265_NAL_VPS)
+			flv->vcl = 16 <= nalutype && nalutype <= 23 ? 1 : 2;
+	}
+	else
+	{
+		nalutype = nalu[0] & 0x1f;
+#if defined(H2645_FILTER_AUD)
+		if (H264_NAL_AUD == nalutype)
+			return; // ignore AUD
+#endif
+		r = mpeg4_avc_update(&flv->v.avc, nalu, bytes);
+
+		// IDR-1, B/P-2, other-0
+		if (1 <= nalutype && nalutype <= 5)
+			flv->vcl = 5 == nalutype ? 1 : 2;
+	}
+
+	if (1 == r)
+		flv->update = 1;
+	else if (r < 0)
+		h->errcode = r;
+
+	if (flv->vec_count + 2 > flv->vec_capacity)
+	{
+		p = realloc(flv->vec, (flv->vec_capacity * 2 + 16) * sizeof(struct flv_iovec_t));
+		if (!p)
+		{
+			h->errcode = ENOMEM;
+			return;
+		}
+		flv->vec = (struct flv_iovec_t*)p;
+		flv->vec_capacity = flv->vec_capacity * 2 + 16;
+	}
+
+	if (flv->bytes + 4 > flv->capacity && 0 != flv_muxer_alloc(flv, flv->capacity * 2 + 64))
+	{
+		h->errcode = ENOMEM;
+		return;
+	}
+
+	// NALU length in flv->ptr(offset only, flv->ptr may be realloc), NALU data in place
+	flv->ptr[flv->bytes + 0] = (uint8_t)((bytes >> 24) & 0xFF);
+	flv->ptr[flv->bytes + 1] = (uint8_t)((bytes >> 16) & 0xFF);
+	flv->ptr[flv->bytes + 2] = (uint8_t)((bytes >> 8) & 0xFF);
+	flv->ptr[flv->bytes + 3] = (uint8_t)((bytes >> 0) & 0xFF);
+	flv->vec[flv->vec_count].base = NULL;
+	flv->vec[flv->vec_count].len = flv->bytes;
+	flv->vec[flv->vec_count + 1].base = nalu;
+	flv->vec[flv->vec_count + 1].len = bytes;
+	flv->vec_count += 2;
+	flv->bytes += 4;
+}
+
+/// Annex B => vec(NALU length + input slice), same as h264_annexbtomp4/h265_annexbtomp4 without copy
+static int flv_muxer_nalus(struct flv_muxer_t* flv, int codecid, const void* data, size_t bytes)
+{
+	int i;
+	struct flv_muxer_nalu_t h;
+
+	h.flv = flv;
+	h.codecid = codecid;
+	h.errcode = 0;
+	flv->vcl = 0;
+	flv->update = 0;
+	flv->bytes = 5; // VideoTagHeader
+	flv->vec_count = 1;
+	if (flv->capacity < 256 && 0 != flv_muxer_alloc(flv, 256))
+		return ENOMEM;
+
+	mpeg4_h264_annexb_nalu(data, (int)bytes, flv_muxer_nalu, &h);
+	if (0 != h.errcode || flv->vec_count < 2)
+		return ENOMEM;
+
+	if (FLV_VIDEO_H265 == codecid)
+	{
+		flv->v.hevc.configurationVersion = 1;
+		flv->v.hevc.lengthSizeMinusOne = 3; // 4 bytes
+	}
+	else
+	{
+		flv->v.avc.nalu = 4;
+	}
+
+	// sequence header after NALU length
+	if (flv->capacity < flv->bytes + (int)sizeof(flv->v) && 0 != flv_muxer_alloc(flv, flv->bytes + sizeof(flv->v)))
+		return ENOMEM;
+
+	flv->vec[0].base = flv->ptr;
+	flv->vec[0].len = 5;
+	for (i = 1; i < flv->vec_count; i += 2)
+	{
+		flv->vec[i].base = flv->ptr + flv->vec[i].len;
+		flv->vec[i].len = 4;
+	}
+	return 0;
 }
 
 static int flv_muxer_h264(struct flv_muxer_t* flv, uint32_t pts, uint32_t dts)
@@ -229,7 +401,7 @@ static int flv_muxer_h264(struct flv_muxer_t* flv, uint32_t pts, uint32_t dts)
 
 		flv->video_sequence_header = 1; // once only
 		assert(flv->bytes + m + 5 <= (int)flv->capacity);
-		r = flv->handler(flv->param, FLV_TYPE_VIDEO, flv->ptr + flv->bytes, m + 5, dts);
+		r = flv_muxer_write(flv, FLV_TYPE_VIDEO, flv->ptr + flv->bytes, m + 5, dts);
 		if (0 != r) return r;
 	}
 
@@ -241,6 +413,8 @@ static int flv_muxer_h264(struct flv_muxer_t* flv, uint32_t pts, uint32_t dts)
 		video.avpacket = FLV_AVPACKET;
 		flv_video_tag_header_write(&video, flv->ptr, flv->capacity);
 		assert(flv->bytes <= (int)flv->capacity);
+		if (flv->handlerv)
+			return flv->handlerv(flv->param, FLV_TYPE_VIDEO, flv->vec, flv->vec_count, dts);
 		return flv->handler(flv->param, FLV_TYPE_VIDEO, flv->ptr, flv->bytes, dts);
 	}
 	return 0;
@@ -248,6 +422,13 @@ static int flv_muxer_h264(struct flv_muxer_t* flv, uint32_t pts, uint32_t dts)
 
 int flv_muxer_avc(struct flv_muxer_t* flv, const void* data, size_t bytes, uint32_t pts, uint32_t dts)
 {
+	if (flv->handlerv)
+	{
+		if (0 != flv_muxer_nalus(flv, FLV_VIDEO_H264, data, bytes))
+			return ENOMEM;
+		return flv_muxer_h264(flv, pts, dts);
+	}
+
 	if (flv->capacity < (int)bytes + sizeof(flv->v.avc) /*AVCDecoderConfigurationRecord*/)
 	{
 		if (0 != flv_muxer_alloc(flv, (int)bytes + sizeof(flv->v.avc)))
@@ -281,7 +462,7 @@ static int flv_muxer_h265(struct flv_muxer_t* flv, uint32_t pts, uint32_t dts)
 
 		flv->video_sequence_header = 1; // once only
 		assert(flv->bytes + m + 5 <= (int)flv->capacity);
-		r = flv->handler(flv->param, FLV_TYPE_VIDEO, flv->ptr + flv->bytes, m + 5, dts);
+		r = flv_muxer_write(flv, FLV_TYPE_VIDEO, flv->ptr + flv->bytes, m + 5, dts);
 		if (0 != r) return r;
 	}
 
@@ -293,6 +474,8 @@ static int flv_muxer_h265(struct flv_muxer_t* flv, uint32_t pts, uint32_t dts)
 		video.avpacket = FLV_AVPACKET;
 		flv_video_tag_header_write(&video, flv->ptr, flv->capacity);
 		assert(flv->bytes <= (int)flv->capacity);
+		if (flv->handlerv)
+			return flv->handlerv(flv->param, FLV_TYPE_VIDEO, flv->vec, flv->vec_count, dts);
 		return flv->handler(flv->param, FLV_TYPE_VIDEO, flv->ptr, flv->bytes, dts);
 	}
 	return 0;
@@ -300,6 +483,13 @@ static int flv_muxer_h265(struct flv_muxer_t* flv, uint32_t pts, uint32_t dts)
 
 int flv_muxer_hevc(struct flv_muxer_t* flv, const void* data, size_t bytes, uint32_t pts, uint32_t dts)
 {
+	if (flv->handlerv)
+	{
+		if (0 != flv_muxer_nalus(flv, FLV_VIDEO_H265, data, bytes))
+			return ENOMEM;
+		return flv_muxer_h265(flv, pts, dts);
+	}
+
 	if (flv->capacity < (int)bytes + sizeof(flv->v.hevc) /*HEVCDecoderConfigurationRecord*/)
 	{
 		if (0 != flv_muxer_alloc(flv, (int)bytes + sizeof(flv->v.hevc)))
@@ -368,5 +558,5 @@ int flv_muxer_metadata(flv_muxer_t* flv, const struct flv_metadata_t* metadata)
 	ptr = AMFWriteNamedString(ptr, end, "encoder", 7, FLV_MUXER, strlen(FLV_MUXER));
 	ptr = AMFWriteObjectEnd(ptr, end);
 
-	return flv->handler(flv->param, FLV_TYPE_SCRIPT, flv->ptr, ptr - flv->ptr, 0);
+	return flv_muxer_write(flv, FLV_TYPE_SCRIPT, flv->ptr, ptr - flv->ptr, 0);
 }
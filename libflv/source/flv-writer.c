@@ -115,3 +115,32 @@ int flv_writer_input(void* p, int type, const void* data, size_t bytes, uint32_t
 		return -1;
 	return 0;
 }
+
+int flv_writer_inputv(void* p, int type, const struct flv_iovec_t* vec, int n, uint32_t timestamp)
+{
+	int i;
+	size_t bytes;
+	uint8_t buf[FLV_TAG_HEADER_SIZE + 4];
+	struct flv_writer_t* flv;
+	struct flv_tag_header_t tag;
+	flv = (struct flv_writer_t*)p;
+
+	for (bytes = i = 0; i < n; i++)
+		bytes += vec[i].len;
+
+	memset(&tag, 0, sizeof(tag));
+	tag.size = (int)bytes;
+	tag.type = (uint8_t)type;
+	tag.timestamp = timestamp;
+	flv_tag_header_write(&tag, buf, FLV_TAG_HEADER_SIZE);
+	flv_tag_size_write(buf + FLV_TAG_HEADER_SIZE, 4, (uint32_t)bytes + FLV_TAG_HEADER_SIZE);
+
+	if (FLV_TAG_HEADER_SIZE != flv->write(flv->param, buf, FLV_TAG_HEADER_SIZE)) // FLV Tag Header
+		return -1;
+	for (i = 0; i < n; i++)
+	{
+		if (vec[i].len != (size_t)flv->write(flv->param, vec[i].base, (int)vec[i].len))
+			return -1;
+	}
+	return 4 == flv->write(flv->param, buf + FLV_TAG_HEADER_SIZE, 4) ? 0 : -1; // TAG size
+}
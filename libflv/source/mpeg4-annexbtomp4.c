@@ -6,6 +6,7 @@
 // 2. It is recommended encapsulating one NAL unit in one SL packet when it is delivered over lossy environment.
 
 #include "mpeg4-avc.h"
+#include "mpeg4-annexb.h"
 #include <string.h>
 #include <assert.h>
 #include <stdint.h>
@@ -28,18 +29,6 @@ struct h264_annexbtomp4_handle_t
 	int capacity;
 };
 
-static const uint8_t* h264_startcode(const uint8_t *data, int bytes)
-{
-	int i;
-	for (i = 2; i + 1 < bytes; i++)
-	{
-		if (0x01 == data[i] && 0x00 == data[i - 1] && 0x00 == data[i - 2])
-			return data + i + 1;
-	}
-
-	return NULL;
-}
-
 ///@param[in] h264 H.264 byte stream format data(A set of NAL units)
 void mpeg4_h264_annexb_nalu(const void* h264, int bytes, void (*handler)(void* param, const uint8_t* nalu, int bytes), void* param)
 {
@@ -47,11 +36,11 @@ void mpeg4_h264_annexb_nalu(const void* h264, int bytes, void (*handler)(void* p
 	const uint8_t* p, *next, *end;
 
 	end = (const uint8_t*)h264 + bytes;
-	p = h264_startcode((const uint8_t*)h264, bytes);
+	p = mpeg4_annexb_nalu_find((const uint8_t*)h264, end);
 
 	while (p)
 	{
-		next = h264_startcode(p, (int)(end - p));
+		next = mpeg4_annexb_nalu_find(p, end);
 		if (next)
 		{
 			n = next - p - 3;
@@ -0,0 +1,201 @@
+#include "flv-writer.h"
+#include "flv-reader.h"
+#include "flv-demuxer.h"
+#include "flv-muxer.h"
+#include "flv-proto.h"
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+
+#define N 100 // video frame count
+#define GOP 25
+
+// mpeg4-avc.c mpeg4_avc_test
+static const uint8_t s_h264_sps_pps[] = {
+	0x00,0x00,0x00,0x01,0x67,0x42,0xe0,0x1e,0xab,0x40,0xf0,0x28,0xd0,0x80,0x00,0x00,
+	0x00,0x80,0x00,0x00,0x19,0x70,0x20,0x00,0x78,0x00,0x00,0x0f,0x00,0x16,0xb1,0xb0,
+	0x3c,0x50,0xaa,0x80,0x80,0x00,0x00,0x00,0x01,0x28,0xce,0x3c,0x80
+};
+
+// mpeg4-hevc.c mpeg4_hevc_test
+static const uint8_t s_h265_vps_sps_pps[] = {
+	0x00,0x00,0x00,0x01,0x40,0x01,0x0c,0x01,0xff,0xff,0x01,0x60,0x00,0x00,0x03,
+	0x00,0x80,0x00,0x00,0x03,0x00,0x00,0x03,0x00,0xb4,0x9d,0xc0,0x90,0x00,0x00,
+	0x00,0x01,0x42,0x01,0x01,0x01,0x60,0x00,0x00,0x03,0x00,0x80,0x00,0x00,0x03,
+	0x00,0x00,0x03,0x00,0xb4,0xa0,0x01,0xe0,0x20,0x02,0x1c,0x59,0x67,0x79,0x24,
+	0x6d,0xae,0x01,0x00,0x00,0x03,0x03,0xe8,0x00,0x00,0x5d,0xc0,0x08,0x00,0x00,
+	0x00,0x01,0x44,0x01,0xc1,0x73,0xd1,0x89
+};
+
+struct flv_writer_iovec_test_t
+{
+	void* writer; // flv_writer_inputv
+	int tags;
+	int vectors;
+
+	int audio;
+	int video;
+};
+
+static int flv_onwrite(void* param, const void* buf, int len)
+{
+	std::vector<uint8_t>* flv = (std::vector<uint8_t>*)param;
+	flv->insert(flv->end(), (const uint8_t*)buf, (const uint8_t*)buf + len);
+	return len;
+}
+
+static int flv_onmuxer(void* flv, int type, const void* data, size_t bytes, uint32_t timestamp)
+{
+	return flv_writer_input(flv, type, data, bytes, timestamp);
+}
+
+static int flv_onmuxerv(void* param, int type, const struct flv_iovec_t* vec, int n, uint32_t timestamp)
+{
+	struct flv_writer_iovec_test_t* test = (struct flv_writer_iovec_test_t*)param;
+	test->tags++;
+	test->vectors += n;
+	return flv_writer_inputv(test->writer, type, vec, n, timestamp);
+}
+
+static int flv_ondemuxer(void* param, int codec, const void* /*data*/, size_t /*bytes*/, uint32_t /*pts*/, uint32_t /*dts*/, int /*flags*/)
+{
+	struct flv_writer_iovec_test_t* test = (struct flv_writer_iovec_test_t*)param;
+	if (FLV_AUDIO_AAC == codec)
+		test->audio++;
+	else if (FLV_VIDEO_H264 == codec || FLV_VIDEO_H265 == codec)
+		test->video++;
+	return 0;
+}
+
+static int flv_onread(void* param, void* buf, int len)
+{
+	std::vector<uint8_t>* flv = (std::vector<uint8_t>*)param;
+	len = len < (int)flv->size() ? len : (int)flv->size();
+	memcpy(buf, flv->data(), len);
+	flv->erase(flv->begin(), flv->begin() + len);
+	return len;
+}
+
+/// Annex B slice, payload without zero byte(no start code emulation)
+static void flv_writer_iovec_slice(std::vector<uint8_t>& au, int h265, int key, int bytes)
+{
+	int i;
+	static const uint8_t sc[] = { 0x00, 0x00, 0x01 };
+	au.insert(au.end(), sc, sc + sizeof(sc));
+	if (h265)
+	{
+		au.push_back(key ? 19 << 1 : 1 << 1); // IDR_W_RADL/TRAIL_R
+		au.push_back(0x01);
+	}
+	else
+	{
+		au.push_back(key ? 0x65 : 0x41); // IDR/non-IDR
+	}
+	au.push_back(0x80); // first_mb_in_slice = 0/first_slice_segment_in_pic_flag = 1
+	for (i = 0; i < bytes; i++)
+		au.push_back((uint8_t)(rand() | 0x01));
+}
+
+/// AAC-LC 44.1kHz stereo ADTS frame
+static int flv_writer_iovec_adts(uint8_t* adts, int bytes)
+{
+	int i;
+	adts[0] = 0xFF;
+	adts[1] = 0xF1;
+	adts[2] = 0x50;
+	adts[3] = (uint8_t)(0x80 | ((bytes >> 11) & 0x03));
+	adts[4] = (uint8_t)(bytes >> 3);
+	adts[5] = (uint8_t)(((bytes & 0x07) << 5) | 0x1F);
+	adts[6] = 0xFC;
+	for (i = 7; i < bytes; i++)
+		adts[i] = (uint8_t)rand();
+	return bytes;
+}
+
+static void flv_writer_iovec_test2(int h265)
+{
+	int i, j, n, r[2];
+	uint8_t adts[1024];
+	std::vector<uint8_t> au;
+	std::vector<uint8_t> flv[2]; // 0-flv_writer_input, 1-flv_writer_inputv
+	struct flv_metadata_t metadata;
+	struct flv_writer_iovec_test_t test;
+
+	memset(&test, 0, sizeof(test));
+	void* w = flv_writer_create2(flv_onwrite, &flv[0]);
+	test.writer = flv_writer_create2(flv_onwrite, &flv[1]);
+	flv_muxer_t* e[2];
+	e[0] = flv_muxer_create(flv_onmuxer, w);
+	e[1] = flv_muxer_create(NULL, &test);
+	r[0] = flv_muxer_set_handlerv(e[1], flv_onmuxerv);
+	assert(0 == r[0]);
+
+	memset(&metadata, 0, sizeof(metadata));
+	metadata.videocodecid = h265 ? FLV_VIDEO_H265 : FLV_VIDEO_H264;
+	metadata.width = 1280;
+	metadata.height = 720;
+	metadata.framerate = 25;
+	metadata.audiocodecid = FLV_AUDIO_AAC;
+	metadata.audiosamplerate = 44100;
+	for (j = 0; j < 2; j++)
+		r[j] = flv_muxer_metadata(e[j], &metadata);
+	assert(0 == r[0] && 0 == r[1]);
+
+	srand(1);
+	for (i = 0; i < N; i++)
+	{
+		au.clear();
+		if (0 == i % GOP)
+		{
+			if (h265)
+				au.assign(s_h265_vps_sps_pps, s_h265_vps_sps_pps + sizeof(s_h265_vps_sps_pps));
+			else
+				au.assign(s_h264_sps_pps, s_h264_sps_pps + sizeof(s_h264_sps_pps));
+		}
+
+		// slices: NALU length + payload vectors
+		n = 1 + rand() % 4;
+		for (j = 0; j < n; j++)
+			flv_writer_iovec_slice(au, h265, 0 == i % GOP, rand() % (0 == i % GOP ? 60000 : 8000));
+
+		for (j = 0; j < 2; j++)
+			r[j] = h265 ? flv_muxer_hevc(e[j], au.data(), au.size(), i * 40, i * 40) : flv_muxer_avc(e[j], au.data(), au.size(), i * 40, i * 40);
+		assert(0 == r[0] && 0 == r[1]);
+
+		n = flv_writer_iovec_adts(adts, 7 + rand() % (sizeof(adts) - 7));
+		for (j = 0; j < 2; j++)
+			r[j] = flv_muxer_aac(e[j], adts, n, i * 40 + 20, i * 40 + 20);
+		assert(0 == r[0] && 0 == r[1]);
+	}
+
+	for (j = 0; j < 2; j++)
+		flv_muxer_destroy(e[j]);
+	flv_writer_destroy(w);
+	flv_writer_destroy(test.writer);
+	assert(test.vectors > test.tags); // scatter-gather video tags
+	assert(flv[0].size() > 0 && flv[0] == flv[1]);
+
+	// read back
+	static char packet[256 * 1024];
+	int tag;
+	size_t taglen;
+	uint32_t timestamp;
+	void* reader = flv_reader_create2(flv_onread, &flv[1]);
+	flv_demuxer_t* d = flv_demuxer_create(flv_ondemuxer, &test);
+	while (1 == flv_reader_read(reader, &tag, &timestamp, &taglen, packet, sizeof(packet)))
+	{
+		r[0] = flv_demuxer_input(d, tag, packet, taglen, timestamp);
+		assert(0 == r[0]);
+	}
+	flv_demuxer_destroy(d);
+	flv_reader_destroy(reader);
+	assert(N == test.video && N == test.audio);
+}
+
+void flv_writer_iovec_test(void)
+{
+	flv_writer_iovec_test2(0);
+	flv_writer_iovec_test2(1);
+}
@@ -0,0 +1,96 @@
+#include "mpeg4-annexb.h"
+#include "sys/system.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define N_LOOP 20
+
+typedef const uint8_t* (*mpeg4_annexb_scan)(const uint8_t* p, const uint8_t* end);
+
+// byte-at-a-time scanner, as used before mpeg4-annexb.h
+static const uint8_t* mpeg4_annexb_startcode_byte(const uint8_t* p, const uint8_t* end)
+{
+	for (p += 2; p < end; p++)
+	{
+		if (0x01 == p[0] && 0x00 == p[-1] && 0x00 == p[-2])
+			return p - 2;
+	}
+	return NULL;
+}
+
+static uint64_t mpeg4_annexb_scan_all(mpeg4_annexb_scan scan, const uint8_t* data, size_t bytes, int* count)
+{
+	uint64_t sum;
+	const uint8_t* p, *end;
+
+	sum = 0;
+	*count = 0;
+	end = data + bytes;
+	for (p = scan(data, end); p; p = scan(p + 3, end))
+	{
+		sum += (uint64_t)(p - data);
+		++*count;
+	}
+	return sum;
+}
+
+static void mpeg4_annexb_benchmark(const char* name, mpeg4_annexb_scan scan, const uint8_t* data, size_t bytes, uint64_t sum)
+{
+	int i, count;
+	uint64_t clock, r;
+
+	r = 0;
+	clock = system_clock();
+	for (i = 0; i < N_LOOP; i++)
+	{
+		r = mpeg4_annexb_scan_all(scan, data, bytes, &count);
+		assert(r == sum); // same start codes as the byte scanner
+	}
+	clock = system_clock() - clock;
+
+	printf("mpeg4_annexb_startcode [%s]: %d start codes, %.2f ms, %.1f MB/s\n", name, count, (double)clock / N_LOOP, clock ? (double)bytes * N_LOOP / 1024 / 1024 * 1000 / clock : 0.0);
+	(void)r;
+}
+
+/// @param[in] file H.264/H.265 Annex B byte stream, e.g. 1080p/4K elementary stream
+void mpeg4_annexb_benchmark_test(const char* file)
+{
+	int count;
+	long bytes;
+	uint64_t sum;
+	uint8_t* data;
+	FILE* fp;
+
+	fp = fopen(file, "rb");
+	if (!fp)
+		return;
+	fseek(fp, 0, SEEK_END);
+	bytes = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	data = (uint8_t*)malloc(bytes > 0 ? bytes : 1);
+	bytes = (long)fread(data, 1, bytes > 0 ? bytes : 0, fp);
+	fclose(fp);
+
+	sum = mpeg4_annexb_scan_all(mpeg4_annexb_startcode_byte, data, bytes, &count);
+	printf("%s: %ld bytes, %d start codes\n", file, bytes, count);
+
+	mpeg4_annexb_benchmark("byte", mpeg4_annexb_startcode_byte, data, bytes, sum);
+	mpeg4_annexb_benchmark("c", mpeg4_annexb_startcode_c, data, bytes, sum);
+#if defined(MPEG4_ANNEXB_SSE2)
+	mpeg4_annexb_benchmark("sse2", mpeg4_annexb_startcode_sse2, data, bytes, sum);
+#endif
+#if defined(MPEG4_ANNEXB_AVX2_RUNTIME)
+	if (__builtin_cpu_supports("avx2"))
+		mpeg4_annexb_benchmark("avx2", mpeg4_annexb_startcode_avx2, data, bytes, sum);
+#elif defined(MPEG4_ANNEXB_AVX2)
+	mpeg4_annexb_benchmark("avx2", mpeg4_annexb_startcode_avx2, data, bytes, sum);
+#endif
+#if defined(MPEG4_ANNEXB_NEON)
+	mpeg4_annexb_benchmark("neon", mpeg4_annexb_startcode_neon, data, bytes, sum);
+#endif
+	mpeg4_annexb_benchmark("auto", mpeg4_annexb_startcode, data, bytes, sum);
+
+	free(data);
+}
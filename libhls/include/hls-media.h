@@ -26,7 +26,14 @@ hls_media_t* hls_media_create(int64_t duration, hls_media_handler handler, void*
 
 void hls_media_destroy(hls_media_t* hls);
 
-/// @param[in] avtype audio/video type (mpeg-ps.h STREAM_VIDEO_XXX/STREAM_AUDIO_XXX)
+/// Register a stream before the first hls_media_input, otherwise AAC + H.264 streams are added by default
+/// if the first input is AAC or H.264(other codec is added alone)
+/// @param[in] avtype audio/video type (mpeg-ps.h STREAM_VIDEO_XXX/STREAM_AUDIO_XXX), e.g. STREAM_VIDEO_H265, STREAM_AUDIO_OPUS
+/// @param[in] extradata codec extra data(mpeg-ts esinfo), NULL if don't have
+/// @return 0-ok, -EEXIST-avtype registered, -E2BIG-too many streams(8), -ENOMEM-alloc failed, other-error(e.g. mpeg-ts PMT full)
+int hls_media_add_stream(hls_media_t* hls, int avtype, const void* extradata, size_t bytes);
+
+/// @param[in] avtype audio/video type (mpeg-ps.h STREAM_VIDEO_XXX/STREAM_AUDIO_XXX), unregistered type is added on the fly(except NULL data)
 /// @param[in] data h264/h265 nalu with startcode(0x00000001), aac with adts
 /// @param[in] bytes data length in byte, NULL-force new segment
 /// @param[in] pts present timestamp in millisecond
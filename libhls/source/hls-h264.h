@@ -4,17 +4,11 @@
 #include <inttypes.h>
 #include <stdint.h>
 #include <stddef.h>
+#include "mpeg4-annexb.h"
 
 static inline const uint8_t* h264_startcode(const uint8_t *data, size_t bytes)
 {
-	size_t i;
-	for (i = 2; i + 1 < bytes; i++)
-	{
-		if (0x01 == data[i] && 0x00 == data[i - 1] && 0x00 == data[i - 2])
-			return data + i + 1;
-	}
-
-	return NULL;
+	return mpeg4_annexb_nalu_find(data, data + bytes);
 }
 
 static inline uint8_t h264_idr(const uint8_t *data, size_t bytes)
@@ -48,16 +42,13 @@ static inline uint8_t h264_idr(const uint8_t *data, size_t bytes)
 
 static inline int h265_irap(const uint8_t* p, size_t bytes)
 {
-	size_t i;
 	uint8_t type;
-	for (i = 2; i + 1 < bytes; i++)
+	const uint8_t* end;
+	for (end = p + bytes; NULL != (p = mpeg4_annexb_nalu_find(p, end)); )
 	{
-		if (0x01 == p[i] && 0x00 == p[i - 1] && 0x00 == p[i - 2])
-		{
-			type = (p[i + 1] >> 1) & 0x3f;
-			if (type < 32)
-				return (16 <= type && type <= 23) ? 1 : 0;
-		}
+		type = (p[0] >> 1) & 0x3f;
+		if (type < 32)
+			return (16 <= type && type <= 23) ? 1 : 0;
 	}
 
 	return 0;
@@ -5,9 +5,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <errno.h>
 
 #define N_TS_PACKET 188
 #define N_TS_FILESIZE (100 * 1024 * 1024) // 100M
+#define N_STREAM_MAX 8 // audio/video streams per segment
 
 #define VMAX(a, b) ((a) > (b) ? (a) : (b))
 
@@ -24,8 +26,13 @@ struct hls_media_t
 	int64_t dts;		// segment first dts
 	int64_t pts;		// segment first pts
 
-    int audio;          // audio stream id
-    int video;          // video stream id
+	struct hls_media_stream_t
+	{
+		int avtype;		// STREAM_VIDEO_XXX/STREAM_AUDIO_XXX
+		int stream;		// mpeg-ts stream id
+	} *streams;
+	int count;
+	int capacity_streams;
 	int audio_only_flag;// don't have video stream in segment
 
 	hls_media_handler handler;
@@ -36,7 +43,7 @@ static void* hls_ts_alloc(void* param, size_t bytes)
 {
 	struct hls_media_t* hls;
 	hls = (struct hls_media_t*)param;
-	assert(188 == bytes);
+	assert(0 == bytes % N_TS_PACKET);
 	assert(hls->capacity >= hls->bytes);
 	if (hls->capacity - hls->bytes < bytes)
 	{
@@ -53,27 +60,55 @@ static void hls_ts_free(void* param, void* packet)
 {
 	struct hls_media_t* hls;
 	hls = (struct hls_media_t*)param;
-	assert(packet == hls->ptr + hls->bytes - 188);
-	assert(hls->ptr <= (uint8_t*)packet && hls->ptr + hls->capacity > (uint8_t*)packet);
+	assert(hls->ptr <= (uint8_t*)packet && hls->ptr + hls->bytes > (uint8_t*)packet);
 }
 
 static int hls_ts_write(void* param, const void* packet, size_t bytes)
 {
 	struct hls_media_t* hls;
 	hls = (struct hls_media_t*)param;
-	assert(188 == bytes);
-	assert(hls->ptr <= (uint8_t*)packet && hls->ptr + hls->capacity > (uint8_t*)packet);
+	assert(0 == bytes % N_TS_PACKET);
+	assert(packet == hls->ptr + hls->bytes && hls->ptr + hls->capacity >= (uint8_t*)packet + bytes);
 	hls->bytes += bytes; // update packet length
 	return 0;
 }
 
+static int hls_media_is_video(int avtype)
+{
+	switch (avtype)
+	{
+	case STREAM_VIDEO_MPEG4:
+	case STREAM_VIDEO_H264:
+	case STREAM_VIDEO_H265:
+	case STREAM_VIDEO_SVAC:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static int hls_media_find(struct hls_media_t* hls, int avtype)
+{
+	int i;
+	for (i = 0; i < hls->count; i++)
+	{
+		if (hls->streams[i].avtype == avtype)
+			return i;
+	}
+	return -1;
+}
+
 static void* hls_ts_create(struct hls_media_t* hls)
 {
+	void* ts;
 	struct mpeg_ts_func_t handler;
 	handler.alloc = hls_ts_alloc;
 	handler.write = hls_ts_write;
 	handler.free = hls_ts_free;
-	return mpeg_ts_create(&handler, hls);
+	ts = mpeg_ts_create(&handler, hls);
+	if (ts)
+		mpeg_ts_set_batch(ts, 1); // one alloc/write per PES packet
+	return ts;
 }
 
 struct hls_media_t* hls_media_create(int64_t duration, hls_media_handler handler, void* param)
@@ -91,9 +126,6 @@ struct hls_media_t* hls_media_create(int64_t duration, hls_media_handler handler
 		return NULL;
 	}
 
-    hls->audio = mpeg_ts_add_stream(hls->ts, STREAM_AUDIO_AAC, NULL, 0);
-    hls->video = mpeg_ts_add_stream(hls->ts, STREAM_VIDEO_H264, NULL, 0);
-
 	hls->maxsize = N_TS_FILESIZE;
 	hls->dts = hls->pts = PTS_NO_VALUE;
 	hls->dts_last = PTS_NO_VALUE;
@@ -114,18 +146,65 @@ void hls_media_destroy(struct hls_media_t* hls)
 		free(hls->ptr);
 	}
 
+	if (hls->streams)
+		free(hls->streams);
+
 	free(hls);
 }
 
+int hls_media_add_stream(struct hls_media_t* hls, int avtype, const void* extradata, size_t bytes)
+{
+	int stream;
+	void* p;
+	if (hls_media_find(hls, avtype) >= 0)
+		return -EEXIST;
+
+	if (hls->count >= N_STREAM_MAX)
+		return -E2BIG;
+
+	if (hls->count >= hls->capacity_streams)
+	{
+		p = realloc(hls->streams, sizeof(hls->streams[0]) * (hls->capacity_streams + 4));
+		if (NULL == p)
+			return -ENOMEM;
+		hls->streams = (struct hls_media_stream_t*)p;
+		hls->capacity_streams += 4;
+	}
+
+	stream = mpeg_ts_add_stream(hls->ts, avtype, extradata, bytes);
+	if (stream < 0)
+		return stream;
+
+	hls->streams[hls->count].avtype = avtype;
+	hls->streams[hls->count].stream = stream;
+	hls->count++;
+	return 0;
+}
+
 int hls_media_input(struct hls_media_t* hls, int avtype, const void* data, size_t bytes, int64_t pts, int64_t dts, int flags)
 {
-	int r;
+	int i, r;
 	int segment;
 	int force_new_segment;
 	int64_t duration;
 
 	assert(dts < hls->dts_last + hls->duration || PTS_NO_VALUE == hls->dts_last);
 
+	if (0 == hls->count && (STREAM_AUDIO_AAC == avtype || STREAM_VIDEO_H264 == avtype) && data && bytes > 0)
+	{
+		// default streams: AAC + H.264, other codec registers itself only
+		hls_media_add_stream(hls, STREAM_AUDIO_AAC, NULL, 0);
+		hls_media_add_stream(hls, STREAM_VIDEO_H264, NULL, 0);
+	}
+
+	i = hls_media_find(hls, avtype);
+	if (i < 0 && data && bytes > 0)
+	{
+		r = hls_media_add_stream(hls, avtype, NULL, 0);
+		if (0 != r) return r;
+		i = hls->count - 1;
+	}
+
 	// PTS/DTS rewind
 	force_new_segment = 0;
 	if (dts + hls->duration < hls->dts_last || NULL == data || 0 == bytes)
@@ -169,10 +248,12 @@ int hls_media_input(struct hls_media_t* hls, int avtype, const void* data, size_
 		hls->audio_only_flag = 1;
 	}
 
-    assert(STREAM_VIDEO_H264 == avtype || STREAM_AUDIO_AAC == avtype);
-	if (hls->audio_only_flag && STREAM_VIDEO_H264 == avtype)
+	if (hls->audio_only_flag && hls_media_is_video(avtype))
 		hls->audio_only_flag = 0; // clear audio only flag
 
 	hls->dts_last = dts;
-	return mpeg_ts_write(hls->ts, STREAM_VIDEO_H264 == avtype ? hls->video : hls->audio, HLS_FLAGS_KEYFRAME & flags ? 1 : 0, pts * 90, dts * 90, data, bytes);
+	if (i < 0)
+		return 0; // force new segment only, don't register stream
+
+	return mpeg_ts_write(hls->ts, hls->streams[i].stream, HLS_FLAGS_KEYFRAME & flags ? 1 : 0, pts * 90, dts * 90, data, bytes);
 }
@@ -0,0 +1,87 @@
+#include "hls-media.h"
+#include "mpeg-ps.h"
+#include "mpeg-ts.h"
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <set>
+#include <vector>
+
+struct hls_media_test_t
+{
+	int segments;
+	std::vector<uint8_t> ts;
+	std::set<int> codecs; // PMT streams
+	std::set<int> packets; // PES codecid
+};
+
+static int hls_media_test_onsegment(void* param, const void* data, size_t bytes, int64_t /*pts*/, int64_t /*dts*/, int64_t /*duration*/)
+{
+	hls_media_test_t* ctx = (hls_media_test_t*)param;
+	ctx->segments++;
+	ctx->ts.insert(ctx->ts.end(), (const uint8_t*)data, (const uint8_t*)data + bytes);
+	return 0;
+}
+
+static void hls_media_test_onstream(void* param, int /*stream*/, int codecid, const void* /*extra*/, int /*bytes*/, int /*finish*/)
+{
+	hls_media_test_t* ctx = (hls_media_test_t*)param;
+	ctx->codecs.insert(codecid);
+}
+
+static int hls_media_test_onpacket(void* param, int /*program*/, int /*stream*/, int codecid, int /*flags*/, int64_t /*pts*/, int64_t /*dts*/, const void* /*data*/, size_t /*bytes*/)
+{
+	hls_media_test_t* ctx = (hls_media_test_t*)param;
+	ctx->packets.insert(codecid);
+	return 0;
+}
+
+// H.265 + AAC registered on the fly, flush(NULL data) must not add a H.264 stream
+static void hls_media_mixed_codec_test(void)
+{
+	int i, r;
+	hls_media_test_t ctx;
+	struct ts_demuxer_notify_t notify = { hls_media_test_onstream };
+	const uint8_t h265[] = { 0x00, 0x00, 0x00, 0x01, 0x26, 0x01, 0xaf, 0x06, 0xb8, 0x63, 0xef, 0x3a, 0x7f, 0x3c };
+	const uint8_t adts[] = { 0xFF, 0xF1, 0x50, 0x80, 0x01, 0x9F, 0xFC, 0x21, 0x00, 0x49, 0x90, 0x02 };
+
+	ctx.segments = 0;
+	hls_media_t* hls = hls_media_create(400, hls_media_test_onsegment, &ctx);
+	for (i = 0; i < 25; i++)
+	{
+		r = hls_media_input(hls, STREAM_VIDEO_H265, h265, sizeof(h265), i * 40, i * 40, 0 == i % 10 ? HLS_FLAGS_KEYFRAME : 0);
+		assert(0 == r);
+		r = hls_media_input(hls, STREAM_AUDIO_AAC, adts, sizeof(adts), i * 40, i * 40, 0);
+		assert(0 == r);
+	}
+	r = hls_media_input(hls, STREAM_VIDEO_H264, NULL, 0, 0, 0, 0); // flush
+	assert(0 == r);
+	assert(3 == ctx.segments);
+
+	// stream limit
+	assert(0 == hls_media_add_stream(hls, STREAM_VIDEO_MPEG4, NULL, 0));
+	assert(-EEXIST == hls_media_add_stream(hls, STREAM_VIDEO_MPEG4, NULL, 0));
+	assert(0 == hls_media_add_stream(hls, STREAM_AUDIO_MP3, NULL, 0));
+	assert(0 == hls_media_add_stream(hls, STREAM_AUDIO_G711A, NULL, 0));
+	assert(0 == hls_media_add_stream(hls, STREAM_AUDIO_G711U, NULL, 0));
+	assert(0 == hls_media_add_stream(hls, STREAM_AUDIO_G722, NULL, 0));
+	assert(0 == hls_media_add_stream(hls, STREAM_AUDIO_OPUS, NULL, 0));
+	assert(-E2BIG == hls_media_add_stream(hls, STREAM_VIDEO_H264, NULL, 0));
+	hls_media_destroy(hls);
+
+	struct ts_demuxer_t* ts = ts_demuxer_create(hls_media_test_onpacket, &ctx);
+	ts_demuxer_set_notify(ts, &notify, &ctx);
+	for (i = 0; i + 188 <= (int)ctx.ts.size(); i += 188)
+		ts_demuxer_input(ts, &ctx.ts[i], 188);
+	ts_demuxer_flush(ts);
+	ts_demuxer_destroy(ts);
+
+	assert(2 == ctx.codecs.size() && ctx.codecs.end() != ctx.codecs.find(STREAM_VIDEO_H265) && ctx.codecs.end() != ctx.codecs.find(STREAM_AUDIO_AAC));
+	assert(ctx.packets == ctx.codecs);
+}
+
+void hls_media_test(void)
+{
+	hls_media_mixed_codec_test();
+}
@@ -14,6 +14,11 @@ typedef struct mov_reader_t mov_reader_t;
 mov_reader_t* mov_reader_create(const struct mov_buffer_t* buffer, void* param);
 void mov_reader_destroy(mov_reader_t* mov);
 
+/// Create reader on a read-only memory mapped file, use mov_reader_read_ref to read sample without copy
+/// @param[in] file mp4 file name
+/// @return NULL-error
+mov_reader_t* mov_reader_create_mmap(const char* file);
+
 struct mov_reader_trackinfo_t
 {
 	/// @param[in] object: MOV_OBJECT_H264/MOV_OBJECT_AAC, see more @mov-format.h
@@ -34,6 +39,11 @@ typedef void (*mov_reader_onread)(void* param, uint32_t track, const void* buffe
 /// @return 1-read one frame, 0-EOF, <0-error 
 int mov_reader_read(mov_reader_t* mov, void* buffer, size_t bytes, mov_reader_onread onread, void* param);
 
+/// Read sample without copy(mov_reader_create_mmap only)
+/// onread buffer points into the mapped file, valid until mov_reader_destroy
+/// @return 1-read one frame, 0-EOF, <0-error
+int mov_reader_read_ref(mov_reader_t* mov, mov_reader_onread onread, void* param);
+
 /// @param[in,out] timestamp input seek timestamp, output seek location timestamp
 /// @return 0-ok, other-error
 int mov_reader_seek(mov_reader_t* mov, int64_t* timestamp);
@@ -2,12 +2,20 @@
 #define _mov_ioutil_h_
 
 #include "mov-buffer.h"
+#include <string.h>
 
 struct mov_ioutil_t
 {
 	struct mov_buffer_t io;
 	void* param;
 	int error;
+
+	// read-ahead buffer(reader only, capacity 0-disable)
+	uint8_t* ptr;
+	size_t capacity;
+	size_t off, len; // ptr[off, len) unread data
+	uint64_t pos; // file offset of ptr[0], file position = pos + len
+	uint64_t end; // read-ahead limit(box end offset), 0-don't read ahead
 };
 
 static inline int mov_buffer_error(const struct mov_ioutil_t* io)
@@ -17,13 +25,30 @@ static inline int mov_buffer_error(const struct mov_ioutil_t* io)
 
 static inline uint64_t mov_buffer_tell(const struct mov_ioutil_t* io)
 {
+	if (io->capacity > 0)
+		return io->pos + io->off;
 	return io->io.tell(io->param);
 }
 
 static inline void mov_buffer_seek(const struct mov_ioutil_t* io, uint64_t offset)
 {
+	struct mov_ioutil_t* rw = (struct mov_ioutil_t*)io;
+	if (rw->capacity > 0)
+	{
+		if (offset >= rw->pos && offset <= rw->pos + rw->len)
+		{
+			// seek in read-ahead buffer
+			rw->off = (size_t)(offset - rw->pos);
+			rw->error = 0;
+			return;
+		}
+
+		rw->pos = offset;
+		rw->off = rw->len = 0;
+	}
+
 //	if (0 == io->error)
-		((struct mov_ioutil_t*)io)->error = io->io.seek(io->param, offset);
+		rw->error = io->io.seek(io->param, offset);
 }
 
 static inline void mov_buffer_skip(struct mov_ioutil_t* io, uint64_t bytes)
@@ -31,15 +56,52 @@ static inline void mov_buffer_skip(struct mov_ioutil_t* io, uint64_t bytes)
 	uint64_t offset;
 	if (0 == io->error)
 	{
-		offset = io->io.tell(io->param);
-		io->error = io->io.seek(io->param, offset + bytes);
+		offset = mov_buffer_tell(io);
+		mov_buffer_seek(io, offset + bytes);
 	}
 }
 
 static inline void mov_buffer_read(struct mov_ioutil_t* io, void* data, uint64_t bytes)
 {
-	if (0 == io->error)
+	size_t n;
+	if (0 != io->error)
+		return;
+
+	if (0 == io->capacity)
+	{
+		io->error = io->io.read(io->param, data, bytes);
+		return;
+	}
+
+	n = io->len - io->off;
+	n = n < bytes ? n : (size_t)bytes;
+	memcpy(data, io->ptr + io->off, n);
+	io->off += n;
+	if (bytes == n)
+		return;
+
+	// read-ahead buffer is empty
+	data = (uint8_t*)data + n;
+	bytes -= n;
+	io->pos += io->len;
+	io->off = io->len = 0;
+
+	if (bytes >= io->capacity || io->end < io->pos + bytes)
+	{
+		// large block or unknown box end, read directly
 		io->error = io->io.read(io->param, data, bytes);
+		io->pos += bytes;
+		return;
+	}
+
+	n = io->end - io->pos < io->capacity ? (size_t)(io->end - io->pos) : io->capacity;
+	io->error = io->io.read(io->param, io->ptr, n);
+	if (0 != io->error)
+		return;
+
+	memcpy(data, io->ptr, (size_t)bytes);
+	io->off = (size_t)bytes;
+	io->len = n;
 }
 
 static inline void mov_buffer_write(const struct mov_ioutil_t* io, const void* data, uint64_t bytes)
@@ -58,6 +120,13 @@ static inline uint8_t mov_buffer_r8(struct mov_ioutil_t* io)
 static inline uint16_t mov_buffer_r16(struct mov_ioutil_t* io)
 {
 	uint16_t v;
+	if (0 == io->error && io->off + 2 <= io->len)
+	{
+		v = (io->ptr[io->off] << 8) | io->ptr[io->off + 1];
+		io->off += 2;
+		return v;
+	}
+
 	v = mov_buffer_r8(io) << 8;
 	v |= mov_buffer_r8(io);
 	return v;
@@ -74,6 +143,13 @@ static inline uint32_t mov_buffer_r24(struct mov_ioutil_t* io)
 static inline uint32_t mov_buffer_r32(struct mov_ioutil_t* io)
 {
 	uint32_t v;
+	if (0 == io->error && io->off + 4 <= io->len)
+	{
+		v = ((uint32_t)io->ptr[io->off] << 24) | ((uint32_t)io->ptr[io->off + 1] << 16) | ((uint32_t)io->ptr[io->off + 2] << 8) | io->ptr[io->off + 3];
+		io->off += 4;
+		return v;
+	}
+
 	v = mov_buffer_r16(io) << 16;
 	v |= mov_buffer_r16(io);
 	return v;
@@ -0,0 +1,80 @@
+#include "mov-internal.h"
+#include <stdlib.h>
+
+#if defined(OS_WINDOWS) || defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+
+void* mov_mmap_open(const char* file, uint64_t* bytes)
+{
+	void* ptr;
+	HANDLE fd, map;
+	LARGE_INTEGER size;
+
+	fd = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (INVALID_HANDLE_VALUE == fd)
+		return NULL;
+
+	if (!GetFileSizeEx(fd, &size) || size.QuadPart < 1)
+	{
+		CloseHandle(fd);
+		return NULL;
+	}
+
+	map = CreateFileMappingA(fd, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(fd);
+	if (NULL == map)
+		return NULL;
+
+	// the view keeps the file mapping alive
+	ptr = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(map);
+	if (NULL == ptr)
+		return NULL;
+
+	*bytes = (uint64_t)size.QuadPart;
+	return ptr;
+}
+
+void mov_mmap_close(void* ptr, uint64_t bytes)
+{
+	UnmapViewOfFile(ptr);
+	(void)bytes;
+}
+
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+void* mov_mmap_open(const char* file, uint64_t* bytes)
+{
+	int fd;
+	void* ptr;
+	struct stat st;
+
+	fd = open(file, O_RDONLY);
+	if (-1 == fd)
+		return NULL;
+
+	if (0 != fstat(fd, &st) || st.st_size < 1)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	ptr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping keeps the file open
+	if (MAP_FAILED == ptr)
+		return NULL;
+
+	*bytes = (uint64_t)st.st_size;
+	return ptr;
+}
+
+void mov_mmap_close(void* ptr, uint64_t bytes)
+{
+	munmap(ptr, (size_t)bytes);
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "mov-reader.h"
 #include "mov-internal.h"
+#include "mov-memory-buffer.h"
 #include <errno.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -11,9 +12,15 @@
 
 #define AV_TRACK_TIMEBASE 1000
 
+#if !defined(MOV_READER_BUFFER_SIZE)
+#define MOV_READER_BUFFER_SIZE (64 * 1024) // moov read-ahead buffer, 0-disable
+#endif
+
 struct mov_reader_t
 {
 	struct mov_t mov;
+
+	struct mov_memory_buffer_t map; // mov_reader_create_mmap only
 };
 
 struct mov_parse_t
@@ -291,9 +298,13 @@ int mov_reader_box(struct mov_t* mov, const struct mov_box_t* parent)
 		else
 		{
 			int r;
-			uint64_t pos, pos2;
+			uint64_t pos, pos2, end;
 			pos = mov_buffer_tell(&mov->io);
+			end = mov->io.end;
+			if (UINT64_MAX != box.size && (0 == end || pos + box.size < end))
+				mov->io.end = pos + box.size; // read-ahead limit: box end
 			r = parse(mov, &box);
+			mov->io.end = end;
 			assert(0 == r);
 			if (0 != r) return r;
 			pos2 = mov_buffer_tell(&mov->io);
@@ -334,12 +345,9 @@ static int mov_reader_init(struct mov_t* mov)
 	return 0;
 }
 
-struct mov_reader_t* mov_reader_create(const struct mov_buffer_t* buffer, void* param)
+static int mov_reader_open(struct mov_reader_t* reader, const struct mov_buffer_t* buffer, void* param)
 {
-	struct mov_reader_t* reader;
-	reader = (struct mov_reader_t*)calloc(1, sizeof(*reader));
-	if (NULL == reader)
-		return NULL;
+	int r;
 
 	// ISO/IEC 14496-12:2012(E) 4.3.1 Definition (p17)
 	// Files with no file-type box should be read as if they contained an FTYP box 
@@ -351,7 +359,49 @@ struct mov_reader_t* mov_reader_create(const struct mov_buffer_t* buffer, void*
 
 	reader->mov.io.param = param;
 	memcpy(&reader->mov.io.io, buffer, sizeof(reader->mov.io.io));
-	if (0 != mov_reader_init(&reader->mov))
+
+#if MOV_READER_BUFFER_SIZE > 0
+	// buffered box/table parsing, one read callback per read-ahead block
+	reader->mov.io.ptr = (uint8_t*)malloc(MOV_READER_BUFFER_SIZE);
+	reader->mov.io.capacity = reader->mov.io.ptr ? MOV_READER_BUFFER_SIZE : 0;
+	reader->mov.io.pos = reader->mov.io.ptr ? buffer->tell(param) : 0;
+#endif
+
+	r = mov_reader_init(&reader->mov);
+
+	// sample data is read with seek + read, drop the read-ahead buffer
+	if (reader->mov.io.ptr)
+		free(reader->mov.io.ptr);
+	reader->mov.io.ptr = NULL;
+	reader->mov.io.capacity = 0;
+	reader->mov.io.off = reader->mov.io.len = 0;
+	return r;
+}
+
+struct mov_reader_t* mov_reader_create(const struct mov_buffer_t* buffer, void* param)
+{
+	struct mov_reader_t* reader;
+	reader = (struct mov_reader_t*)calloc(1, sizeof(*reader));
+	if (NULL == reader)
+		return NULL;
+
+	if (0 != mov_reader_open(reader, buffer, param))
+	{
+		mov_reader_destroy(reader);
+		return NULL;
+	}
+	return reader;
+}
+
+struct mov_reader_t* mov_reader_create_mmap(const char* file)
+{
+	struct mov_reader_t* reader;
+	reader = (struct mov_reader_t*)calloc(1, sizeof(*reader));
+	if (NULL == reader)
+		return NULL;
+
+	reader->map.ptr = (uint8_t*)mov_mmap_open(file, &reader->map.capacity);
+	if (NULL == reader->map.ptr || 0 != mov_reader_open(reader, mov_memory_buffer(), &reader->map))
 	{
 		mov_reader_destroy(reader);
 		return NULL;
@@ -366,6 +416,8 @@ void mov_reader_destroy(struct mov_reader_t* reader)
         mov_free_track(reader->mov.tracks + i);
     if (reader->mov.tracks)
         free(reader->mov.tracks);
+	if (reader->map.ptr)
+		mov_mmap_close(reader->map.ptr, reader->map.capacity);
 	free(reader);
 }
 
@@ -425,6 +477,31 @@ int mov_reader_read(struct mov_reader_t* reader, void* buffer, size_t bytes, mov
 	return 1;
 }
 
+int mov_reader_read_ref(struct mov_reader_t* reader, mov_reader_onread onread, void* param)
+{
+	struct mov_track_t* track;
+	struct mov_sample_t* sample;
+
+	if (NULL == reader->map.ptr)
+		return -EINVAL; // don't have mapped file
+
+	track = mov_reader_next(reader);
+	if (NULL == track || 0 == track->mdhd.timescale)
+	{
+		return 0; // EOF
+	}
+
+	assert(track->sample_offset < track->sample_count);
+	sample = &track->samples[track->sample_offset];
+	if (sample->offset > reader->map.capacity || sample->bytes > reader->map.capacity - sample->offset)
+		return -1; // out of file range
+
+	track->sample_offset++; //mark as read
+	assert(sample->sample_description_index > 0);
+	onread(param, track->tkhd.track_ID, reader->map.ptr + sample->offset, sample->bytes, sample->pts * 1000 / track->mdhd.timescale, sample->dts * 1000 / track->mdhd.timescale, sample->flags);
+	return 1;
+}
+
 int mov_reader_seek(struct mov_reader_t* reader, int64_t* timestamp)
 {
 	int i;
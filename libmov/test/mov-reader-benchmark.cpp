@@ -0,0 +1,105 @@
+#include "mov-reader.h"
+#include "mov-writer.h"
+#include "mov-format.h"
+#include "mov-memory-buffer.h"
+#include "sys/system.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define N_LOOP 10
+
+struct mov_reader_benchmark_t
+{
+	struct mov_memory_buffer_t mem;
+	uint64_t reads; // read callback count
+};
+
+static int mov_benchmark_read(void* param, void* data, uint64_t bytes)
+{
+	struct mov_reader_benchmark_t* ctx = (struct mov_reader_benchmark_t*)param;
+	ctx->reads++;
+	return mov_memory_read(&ctx->mem, data, bytes);
+}
+
+static int mov_benchmark_write(void* param, const void* data, uint64_t bytes)
+{
+	struct mov_reader_benchmark_t* ctx = (struct mov_reader_benchmark_t*)param;
+	return mov_memory_write(&ctx->mem, data, bytes);
+}
+
+static int mov_benchmark_seek(void* param, uint64_t offset)
+{
+	struct mov_reader_benchmark_t* ctx = (struct mov_reader_benchmark_t*)param;
+	return mov_memory_seek(&ctx->mem, offset);
+}
+
+static uint64_t mov_benchmark_tell(void* param)
+{
+	struct mov_reader_benchmark_t* ctx = (struct mov_reader_benchmark_t*)param;
+	return mov_memory_tell(&ctx->mem);
+}
+
+static const struct mov_buffer_t s_io = {
+	mov_benchmark_read,
+	mov_benchmark_write,
+	mov_benchmark_seek,
+	mov_benchmark_tell,
+};
+
+// 25fps video + 50fps audio, random sample size(full stsz table)
+static uint64_t mov_benchmark_mp4(struct mov_reader_benchmark_t* ctx, int samples)
+{
+	static const uint8_t s_asc[] = { 0x12, 0x10 };
+	static const uint8_t s_avcc[] = { 0x01, 0x42, 0xc0, 0x1e, 0xff, 0xe0, 0x00 };
+	uint8_t frame[64];
+	int i, video, audio;
+
+	memset(frame, 0, sizeof(frame));
+	ctx->mem.off = 0;
+	mov_writer_t* mov = mov_writer_create(&s_io, ctx, 0);
+	video = mov_writer_add_video(mov, MOV_OBJECT_H264, 1920, 1080, s_avcc, sizeof(s_avcc));
+	audio = mov_writer_add_audio(mov, MOV_OBJECT_AAC, 2, 16, 44100, s_asc, sizeof(s_asc));
+	for (i = 0; i < samples; i++)
+	{
+		if (0 == i % 3)
+			mov_writer_write(mov, video, frame, 16 + rand() % 48, i * 40 / 3, i * 40 / 3, 0 == i % 150 ? MOV_AV_FLAG_KEYFREAME : 0);
+		else
+			mov_writer_write(mov, audio, frame, 8 + rand() % 56, i * 20 / 3, i * 20 / 3, 0);
+	}
+	mov_writer_destroy(mov);
+	return ctx->mem.off;
+}
+
+void mov_reader_benchmark_test(void)
+{
+	static const int s_samples[] = { 1000, 10000, 50000, 100000, 200000, 400000 };
+	struct mov_reader_benchmark_t ctx;
+	uint64_t bytes, clock;
+	int i, j;
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.mem.capacity = 128 * 1024 * 1024;
+	ctx.mem.ptr = (uint8_t*)malloc((size_t)ctx.mem.capacity);
+
+	for (i = 0; i < (int)(sizeof(s_samples) / sizeof(s_samples[0])); i++)
+	{
+		bytes = mov_benchmark_mp4(&ctx, s_samples[i]);
+
+		ctx.reads = 0;
+		clock = system_clock();
+		for (j = 0; j < N_LOOP; j++)
+		{
+			ctx.mem.off = 0;
+			mov_reader_t* reader = mov_reader_create(&s_io, &ctx);
+			assert(reader);
+			mov_reader_destroy(reader);
+		}
+		clock = system_clock() - clock;
+
+		printf("mov_reader_create samples: %d, file: %u KB, open: %.2f ms, read calls: %u\n", s_samples[i], (unsigned int)(bytes / 1024), (double)clock / N_LOOP, (unsigned int)(ctx.reads / N_LOOP));
+	}
+
+	free(ctx.mem.ptr);
+}
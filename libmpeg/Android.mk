@@ -6,6 +6,7 @@ LOCAL_LDLIBS +=
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)
 LOCAL_C_INCLUDES += $(LOCAL_PATH)/include
+LOCAL_C_INCLUDES += $(LOCAL_PATH)/../libflv/include
 
 LOCAL_SRC_FILES := $(wildcard source/*.c)
 LOCAL_SRC_FILES += $(wildcard source/*.cpp)
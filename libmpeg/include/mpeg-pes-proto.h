@@ -44,6 +44,8 @@ enum EPES_STREAM_ID
 	PES_SID_PSD			= 0xFF, // program_stream_directory
 };
 
+struct mpeg_avcc_t;
+
 struct packet_t
 {
     uint8_t sid;
@@ -57,6 +59,12 @@ struct packet_t
     size_t capacity;
 
 	int vcl; // h.264/h.265 only
+
+	// zero-copy mode, payload: data[0, size) + fragments[1, fragment_count] in current input
+	struct mpeg_fragment_t* fragments; // fragments[0]: data
+	int fragment_count;
+	int fragment_capacity;
+	size_t fragment_bytes;
 };
 
 struct pes_t
@@ -68,6 +76,7 @@ struct pes_t
 	uint8_t cc;			// continuity_counter : 4;
 	uint8_t* esinfo;	// es_info
 	uint16_t esinfo_len;// es_info_length : 12
+	struct mpeg_avcc_t* avcc; // muxer: H.264/H.265 length-prefixed input, see mpeg_ts_set_avcc
 
 	uint32_t len;		// PES_packet_length : 16;
 
@@ -122,5 +131,12 @@ size_t pes_read_mpeg1_header(struct pes_t *pes, const uint8_t* data, size_t byte
 
 typedef int (*pes_packet_handler)(void* param, int program, int stream, int codecid, int flags, int64_t pts, int64_t dts, const void* data, size_t bytes);
 int pes_packet(struct packet_t* pkt, const struct pes_t* pes, const void* data, size_t size, int start, pes_packet_handler handler, void* param);
+void pes_packet_free(struct packet_t* pkt);
+
+/// zero-copy mode: frame split by PES start/timestamp(no access unit scan), data referenced until pes_packet_fragment_retain
+typedef int (*pes_fragment_handler)(void* param, int program, int stream, int codecid, int flags, int64_t pts, int64_t dts, const struct mpeg_fragment_t* fragments, int count);
+int pes_packet_fragment(struct packet_t* pkt, const struct pes_t* pes, const void* data, size_t size, int start, pes_fragment_handler handler, void* param);
+/// copy referenced fragments into packet buffer, must be called before input data released
+int pes_packet_fragment_retain(struct packet_t* pkt);
 
 #endif /* !_mpeg_pes_dec_h_ */
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "mpeg-types.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -63,11 +64,17 @@ int ps_muxer_add_stream(struct ps_muxer_t* muxer, int codecid, const void* extra
 /// @param[in] flags 0x0001-video IDR frame, 0x8000-H.264/H.265 with AUD
 /// @param[in] pts presentation time stamp(in 90KHZ)
 /// @param[in] dts decoding time stamp(in 90KHZ)
-/// @param[in] data ES memory
+/// @param[in] data ES memory, H.264/H.265 length-prefixed NALUs after ps_muxer_set_avcc
 /// @param[in] bytes ES length in byte
 /// @return 0-ok, ENOMEM-alloc failed, <0-error
 int ps_muxer_input(struct ps_muxer_t* muxer, int stream, int flags, int64_t pts, int64_t dts, const void* data, size_t bytes);
 
+/// H.264/H.265 length-prefixed input(e.g. FLV/MP4 sample), see more mpeg_ts_set_avcc
+/// @param[in] stream stream id, return by ps_muxer_add_stream
+/// @param[in] record AVCDecoderConfigurationRecord/HEVCDecoderConfigurationRecord, NULL-AnnexB input(default)
+/// @return 0-ok, <0-error
+int ps_muxer_set_avcc(struct ps_muxer_t* muxer, int stream, const void* record, size_t bytes);
+
 
 typedef int (*ps_demuxer_onpacket)(void* param, int stream, int codecid, int flags, int64_t pts, int64_t dts, const void* data, size_t bytes);
 
@@ -91,6 +98,17 @@ struct ps_demuxer_notify_t
 /// Set ps notify on PSM change
 void ps_demuxer_set_notify(struct ps_demuxer_t* demuxer, struct ps_demuxer_notify_t* notify, void* param);
 
+/// Zero-copy frame, same as ps_demuxer_onpacket except payload
+/// @param[in] fragments payload scatter list, reference ps_demuxer_input data(or demuxer buffer), valid in callback only
+/// @param[in] count fragment count
+typedef int (*ps_demuxer_onfragment)(void* param, int stream, int codecid, int flags, int64_t pts, int64_t dts, const struct mpeg_fragment_t* fragments, int count);
+
+/// Deliver frames as fragments instead of ps_demuxer_onpacket, set before ps_demuxer_input
+/// Note: H.264/H.265 frame split by PTS(access units are not split and AUD is kept);
+///       payload not finished on ps_demuxer_input return is copied into the demuxer buffer
+/// @param[in] onfragment NULL-copy mode(ps_demuxer_onpacket)
+void ps_demuxer_set_onfragment(struct ps_demuxer_t* demuxer, ps_demuxer_onfragment onfragment, void* param);
+
 #ifdef __cplusplus
 }
 #endif
@@ -57,6 +57,8 @@ struct ts_packet_header_t
 	struct ts_adaptation_field_t adaptation;
 };
 
+#define PMT_STREAM_MAX	0xFF // 8-bits stream index(ts demuxer PID map), PMT section(1021 bytes) has at most 201 streams
+
 struct pmt_t
 {
 	unsigned int pid;		// PID : 13 [0x0010, 0x1FFE]
@@ -71,7 +73,8 @@ struct pmt_t
     char name[64];
 
 	unsigned int stream_count;
-	struct pes_t streams[4];
+	unsigned int stream_capacity;
+	struct pes_t* streams;
 };
 
 struct pat_t
@@ -186,6 +189,8 @@ enum EPSI_STREAM_TYPE
 enum
 {
     MPEG_FLAG_IDR_FRAME          = 0x0001,
+    MPEG_FLAG_PACKET_LOST        = 0x1000, // ts_demuxer: continuity_counter discontinuity
+    MPEG_FLAG_PACKET_CORRUPT     = 0x2000, // ts_demuxer: transport_error_indicator
     MPEG_FLAG_H264_H265_WITH_AUD = 0x8000,
 };
 
@@ -193,6 +198,8 @@ struct pmt_t* pat_alloc_pmt(struct pat_t* pat);
 struct pmt_t* pat_find(struct pat_t* pat, uint16_t pn);
 size_t pat_read(struct pat_t *pat, const uint8_t* data, size_t bytes);
 size_t pat_write(const struct pat_t *pat, uint8_t *data);
+struct pes_t* pmt_alloc_stream(struct pmt_t* pmt);
+void pmt_free_streams(struct pmt_t* pmt);
 size_t pmt_read(struct pmt_t *pmt, const uint8_t* data, size_t bytes);
 size_t pmt_write(const struct pmt_t *pmt, uint8_t *data);
 size_t sdt_read(struct pat_t *pat, const uint8_t* data, size_t bytes);
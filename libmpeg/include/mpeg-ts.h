@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "mpeg-types.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -12,7 +13,7 @@ struct mpeg_ts_func_t
 {
 	/// alloc new packet
 	/// @param[in] param use-defined parameter(by mpeg_ps_create)
-	/// @param[in] bytes alloc memory size in byte(default 188)
+	/// @param[in] bytes alloc memory size in byte(default 188, N*188 in batch mode)
 	/// @return memory pointer
 	void* (*alloc)(void* param, size_t bytes);
 
@@ -24,7 +25,7 @@ struct mpeg_ts_func_t
 	/// callback on PS packet done
 	/// @param[in] param use-defined parameter(by mpeg_ps_create)
 	/// @param[in] packet PS packet pointer(alloc return pointer)
-	/// @param[in] bytes packet size
+	/// @param[in] bytes packet size(188, or N*188 in batch mode)
 	/// @return 0-ok, other-error
 	int (*write)(void* param, const void* packet, size_t bytes);
 };
@@ -37,7 +38,7 @@ int mpeg_ts_destroy(void* ts);
 /// @param[in] codecid PSI_STREAM_H264/PSI_STREAM_H265/PSI_STREAM_AAC, see more @mpeg-ts-proto.h
 /// @param[in] extradata itu h.222.0 program and program element descriptors, NULL for H.264/H.265/AAC
 /// @param[in] extradata_size extradata size in byte
-/// @return <=0-error, >0-audio/video stream id
+/// @return <=0-error(-E2BIG: PMT full, one TS packet), >0-audio/video stream id
 int mpeg_ts_add_stream(void* ts, int codecid, const void* extradata, size_t extradata_size);
 
 /// Muxer audio/video stream data
@@ -45,13 +46,25 @@ int mpeg_ts_add_stream(void* ts, int codecid, const void* extradata, size_t extr
 /// @param[in] flags 0x0001-video IDR frame, 0x8000-H.264/H.265 with AUD
 /// @param[in] pts audio/video stream timestamp in 90*ms
 /// @param[in] dts audio/video stream timestamp in 90*ms
-/// @param[in] data H.264/H.265-AnnexB stream(include 00 00 00 01), AAC-ADTS stream
+/// @param[in] data H.264/H.265-AnnexB stream(include 00 00 00 01) or length-prefixed NALUs(mpeg_ts_set_avcc), AAC-ADTS stream
 /// @return 0-ok, other-error
 int mpeg_ts_write(void* ts, int stream, int flags, int64_t pts, int64_t dts, const void* data, size_t bytes);
 
-/// Reset PAT/PCR period
+/// H.264/H.265 length-prefixed input(e.g. FLV/MP4 sample), start code replace NALU length while packetizing(no Annex B copy),
+/// parameter sets(from record) are inserted at the beginning of IDR/IRAP access unit(after AUD) without in-band VPS/SPS/PPS
+/// @param[in] stream stream id by mpeg_ts_add_stream
+/// @param[in] record AVCDecoderConfigurationRecord/HEVCDecoderConfigurationRecord, NULL-AnnexB input(default)
+/// @return 0-ok, -EINVAL-invalid record, <0-error
+int mpeg_ts_set_avcc(void* ts, int stream, const void* record, size_t bytes);
+
+/// Reset PAT/PCR period, write PAT/PMT with next packet(serialized sections are cached until program/stream changed)
 int mpeg_ts_reset(void* ts);
 
+/// Batch mode: alloc/write/free once per PES packet(N*188 bytes) instead of once per TS packet
+/// @param[in] batch 0-one callback per TS packet(default), 1-one callback per PES packet
+/// @return 0-ok, other-error
+int mpeg_ts_set_batch(void* ts, int batch);
+
 
 /// FOR MULTI-PROGRAM TS STREAM ONLY
 /// Add a program
@@ -71,11 +84,18 @@ int mpeg_ts_add_program_stream(void* ts, uint16_t pn, int codecid, const void* e
 
 
 /// see more mpeg_ts_write
+/// @param[in] flags MPEG_FLAG_IDR_FRAME, MPEG_FLAG_PACKET_LOST(continuity_counter error), MPEG_FLAG_PACKET_CORRUPT(transport_error_indicator)
 typedef int (*ts_demuxer_onpacket)(void* param, int program, int stream, int codecid, int flags, int64_t pts, int64_t dts, const void* data, size_t bytes);
 
 struct ts_demuxer_t;
 struct ts_demuxer_t* ts_demuxer_create(ts_demuxer_onpacket onpacket, void* param);
 int ts_demuxer_destroy(struct ts_demuxer_t* demuxer);
+
+/// Input transport stream data
+/// @param[in] data any bytes: one or more 188-bytes TS packets, 192-bytes M2TS(BDAV) packets, partial packet
+/// @param[in] bytes data length, partial packet is buffered until next call
+/// @return 0-ok, other-ts_demuxer_onpacket return value
+/// Note: packet size is locked by 3 consecutive sync bytes(0x47), and re-synchronize on sync byte lost
 int ts_demuxer_input(struct ts_demuxer_t* demuxer, const uint8_t* data, size_t bytes);
 int ts_demuxer_flush(struct ts_demuxer_t* demuxer);
 int ts_demuxer_getservice(struct ts_demuxer_t* demuxer, int program, char* provider, int nprovider, char* name, int nname);
@@ -94,6 +114,29 @@ struct ts_demuxer_notify_t
 /// Set ts notify on PMT change
 void ts_demuxer_set_notify(struct ts_demuxer_t* demuxer, struct ts_demuxer_notify_t* notify, void* param);
 
+/// PES stream filter, called on PAT/PMT change
+/// @param[in] param ts_demuxer_set_filter param
+/// @param[in] program program number
+/// @param[in] stream PES PID
+/// @param[in] codecid PMT stream_type, e.g. PSI_STREAM_H264
+/// @return 0-skip the stream(no PES reassemble), other-demux
+typedef int (*ts_demuxer_onfilter)(void* param, int program, int stream, int codecid);
+
+/// Select programs/streams to demux, default all
+/// @param[in] onfilter NULL-demux all streams
+void ts_demuxer_set_filter(struct ts_demuxer_t* demuxer, ts_demuxer_onfilter onfilter, void* param);
+
+/// Zero-copy frame, same as ts_demuxer_onpacket except payload
+/// @param[in] fragments payload scatter list, reference ts_demuxer_input data(or demuxer buffer), valid in callback only
+/// @param[in] count fragment count
+typedef int (*ts_demuxer_onfragment)(void* param, int program, int stream, int codecid, int flags, int64_t pts, int64_t dts, const struct mpeg_fragment_t* fragments, int count);
+
+/// Deliver frames as fragments instead of ts_demuxer_onpacket, set before ts_demuxer_input
+/// Note: one PES packet per frame, H.264/H.265 access units are not split and AUD is kept;
+///       payload not finished on ts_demuxer_input return is copied into the demuxer buffer, use large input to avoid copy
+/// @param[in] onfragment NULL-copy mode(ts_demuxer_onpacket)
+void ts_demuxer_set_onfragment(struct ts_demuxer_t* demuxer, ts_demuxer_onfragment onfragment, void* param);
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,4 +7,25 @@
 
 #define PTS_NO_VALUE INT64_MIN //(int64_t)0x8000000000000000L
 
+/// PES payload fragment(zero-copy demux), see ts_demuxer_set_onfragment/ps_demuxer_set_onfragment
+struct mpeg_fragment_t
+{
+	const uint8_t* ptr;
+	size_t bytes;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Linearize fragments
+/// @param[out] data output buffer
+/// @param[in] bytes output buffer size
+/// @return copied bytes, 0-buffer too small
+size_t mpeg_fragment_copy(const struct mpeg_fragment_t* fragments, int count, void* data, size_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* !_mpeg_types_h_ */
@@ -0,0 +1,216 @@
+// ISO/IEC 14496-15:2010(E)
+// 5.2.4.1 AVC decoder configuration record(p16)
+// 8.3.3.1 HEVC decoder configuration record(p72)
+
+#include "mpeg-avcc.h"
+#include "mpeg-ts-proto.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static const uint8_t s_start_code[] = { 0x00, 0x00, 0x00, 0x01 };
+
+static size_t mpeg_avcc_length(const uint8_t* ptr, int n)
+{
+	int i;
+	size_t len;
+	for (len = i = 0; i < n; i++)
+		len = (len << 8) | ptr[i];
+	return len;
+}
+
+/// copy count x (2-bytes length + NALU) as Annex B
+/// @return next array, NULL-invalid record
+static const uint8_t* mpeg_avcc_ps(struct mpeg_avcc_t* avcc, const uint8_t* p, const uint8_t* end, int count)
+{
+	size_t len;
+	for (; count > 0; count--)
+	{
+		if (p + 2 > end)
+			return NULL;
+		len = mpeg_avcc_length(p, 2);
+		if (len > (size_t)(end - p - 2))
+			return NULL;
+
+		memcpy(avcc->ps + avcc->bytes, s_start_code, sizeof(s_start_code));
+		memcpy(avcc->ps + avcc->bytes + sizeof(s_start_code), p + 2, len);
+		avcc->bytes += sizeof(s_start_code) + len;
+		p += 2 + len;
+	}
+	return p;
+}
+
+static int mpeg_avcc_load(struct mpeg_avcc_t* avcc, const uint8_t* p, const uint8_t* end)
+{
+	int i, n;
+
+	if (PSI_STREAM_H264 == avcc->codecid)
+	{
+		// configurationVersion + AVCProfileIndication + profile_compatibility + AVCLevelIndication
+		// + lengthSizeMinusOne(2) + numOfSequenceParameterSets(5)
+		if (end - p < 7 || 1 != p[0])
+			return -EINVAL;
+		avcc->nalu = (p[4] & 0x03) + 1;
+		p = mpeg_avcc_ps(avcc, p + 6, end, p[5] & 0x1F);
+		if (!p || p >= end)
+			return -EINVAL;
+		p = mpeg_avcc_ps(avcc, p + 1, end, p[0]); // numOfPictureParameterSets
+	}
+	else
+	{
+		// 22-bytes header + lengthSizeMinusOne(2) + numOfArrays
+		if (end - p < 23 || 1 != p[0])
+			return -EINVAL;
+		avcc->nalu = (p[21] & 0x03) + 1;
+		n = p[22];
+		for (p += 23, i = 0; i < n && p; i++)
+		{
+			// array_completeness + NAL_unit_type(6) + numNalus(16)
+			p = p + 3 <= end ? mpeg_avcc_ps(avcc, p + 3, end, (int)mpeg_avcc_length(p + 1, 2)) : NULL;
+		}
+	}
+
+	return p && 3 != avcc->nalu ? 0 : -EINVAL;
+}
+
+int mpeg_avcc_set(struct mpeg_avcc_t** avcc, int codecid, const void* record, size_t bytes)
+{
+	int r;
+	struct mpeg_avcc_t* p;
+
+	if (*avcc)
+	{
+		free(*avcc);
+		*avcc = NULL;
+	}
+
+	if (!record || 0 == bytes)
+		return 0;
+	if (PSI_STREAM_H264 != codecid && PSI_STREAM_H265 != codecid)
+		return -EINVAL;
+
+	// 2-bytes NALU length => 4-bytes start code
+	p = (struct mpeg_avcc_t*)malloc(sizeof(struct mpeg_avcc_t) + bytes * 2);
+	if (!p)
+		return -ENOMEM;
+	memset(p, 0, sizeof(struct mpeg_avcc_t));
+	p->codecid = codecid;
+	p->ps = (uint8_t*)(p + 1);
+
+	r = mpeg_avcc_load(p, (const uint8_t*)record, (const uint8_t*)record + bytes);
+	if (0 != r)
+	{
+		free(p);
+		return r;
+	}
+
+	*avcc = p;
+	return 0;
+}
+
+int mpeg_avcc_reader_init(struct mpeg_avcc_reader_t* reader, const struct mpeg_avcc_t* avcc, const void* data, size_t bytes)
+{
+	int type, irap, inband;
+	size_t i, len;
+	const uint8_t* p;
+
+	memset(reader, 0, sizeof(*reader));
+	reader->avcc = avcc;
+	reader->ptr = (const uint8_t*)data;
+	reader->bytes = bytes;
+	reader->total = bytes;
+	if (!avcc)
+		return 0;
+
+	// like h264_mp4toannexb: parameter sets at the beginning of IRAP access unit(after AUD) if not in-band
+	irap = inband = 0;
+	p = (const uint8_t*)data;
+	for (reader->total = i = 0; i + avcc->nalu <= bytes; i += avcc->nalu + len)
+	{
+		len = mpeg_avcc_length(p + i, avcc->nalu);
+		if (len > bytes - i - avcc->nalu)
+			return -EINVAL;
+		reader->total += sizeof(s_start_code) + len;
+		if (len < 1)
+			continue;
+
+		if (PSI_STREAM_H264 == avcc->codecid)
+		{
+			type = p[i + avcc->nalu] & 0x1F;
+			irap |= 5 == type ? 1 : 0; // IDR
+			inband |= 7 == type || 8 == type ? 1 : 0; // SPS/PPS
+			reader->aud |= 0 == i && 9 == type ? 1 : 0;
+		}
+		else
+		{
+			type = (p[i + avcc->nalu] >> 1) & 0x3F;
+			irap |= 16 <= type && type <= 23 ? 1 : 0; // BLA/IDR/CRA
+			inband |= 32 <= type && type <= 34 ? 1 : 0; // VPS/SPS/PPS
+			reader->aud |= 0 == i && 35 == type ? 1 : 0;
+		}
+	}
+	if (i != bytes)
+		return -EINVAL;
+
+	if (irap && !inband)
+	{
+		reader->ps = avcc->ps;
+		reader->ps_bytes = avcc->bytes;
+		reader->total += avcc->bytes;
+	}
+	return 0;
+}
+
+void mpeg_avcc_read(struct mpeg_avcc_reader_t* reader, uint8_t* data, size_t bytes)
+{
+	size_t n;
+
+	if (!reader->avcc)
+	{
+		assert(bytes <= reader->bytes);
+		memcpy(data, reader->ptr, bytes);
+		reader->ptr += bytes;
+		reader->bytes -= bytes;
+		return;
+	}
+
+	while (bytes > 0)
+	{
+		if (reader->sc > 0)
+		{
+			n = bytes < (size_t)reader->sc ? bytes : (size_t)reader->sc;
+			memcpy(data, s_start_code + sizeof(s_start_code) - reader->sc, n);
+			reader->sc -= (int)n;
+		}
+		else if (reader->nalu > 0)
+		{
+			n = bytes < reader->nalu ? bytes : reader->nalu;
+			memcpy(data, reader->ptr, n);
+			reader->ptr += n;
+			reader->bytes -= n;
+			reader->nalu -= n;
+		}
+		else if (reader->ps_bytes > 0 && !reader->aud)
+		{
+			n = bytes < reader->ps_bytes ? bytes : reader->ps_bytes;
+			memcpy(data, reader->ps, n);
+			reader->ps += n;
+			reader->ps_bytes -= n;
+		}
+		else
+		{
+			// next NALU
+			assert(reader->bytes >= (size_t)reader->avcc->nalu);
+			reader->nalu = mpeg_avcc_length(reader->ptr, reader->avcc->nalu);
+			reader->ptr += reader->avcc->nalu;
+			reader->bytes -= reader->avcc->nalu;
+			reader->sc = sizeof(s_start_code);
+			reader->aud = 0;
+			continue;
+		}
+
+		data += n;
+		bytes -= n;
+	}
+}
@@ -0,0 +1,46 @@
+#ifndef _mpeg_avcc_h_
+#define _mpeg_avcc_h_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// H.264/H.265 length-prefixed NALU input(AVCC/HVCC, e.g. FLV/MP4 sample)
+struct mpeg_avcc_t
+{
+	int codecid; // PSI_STREAM_H264/PSI_STREAM_H265
+	int nalu; // NALU length size in byte: 1/2/4
+	uint8_t* ps; // VPS/SPS/PPS with start code
+	size_t bytes;
+};
+
+/// Annex B payload reader: start codes replace NALU length while packetizing
+struct mpeg_avcc_reader_t
+{
+	const struct mpeg_avcc_t* avcc; // NULL-Annex B input, copy only
+	const uint8_t* ptr;
+	size_t bytes; // remain input bytes
+	size_t total; // output(Annex B) bytes
+
+	const uint8_t* ps; // parameter sets to insert before IDR frame
+	size_t ps_bytes;
+	int aud; // 1-in-band AUD, insert parameter sets after it
+
+	size_t nalu; // remain payload bytes of current NALU
+	int sc; // remain start code bytes of current NALU
+};
+
+/// Load AVCDecoderConfigurationRecord/HEVCDecoderConfigurationRecord
+/// @param[in,out] avcc previous record is freed, NULL if record is NULL
+/// @param[in] codecid PSI_STREAM_H264/PSI_STREAM_H265
+/// @return 0-ok, -EINVAL-invalid record, -ENOMEM-alloc failed
+int mpeg_avcc_set(struct mpeg_avcc_t** avcc, int codecid, const void* record, size_t bytes);
+
+/// Check NALU length and find in-band AUD/parameter sets
+/// @param[in] avcc NULL-Annex B input
+/// @return 0-ok, -EINVAL-invalid NALU length
+int mpeg_avcc_reader_init(struct mpeg_avcc_reader_t* reader, const struct mpeg_avcc_t* avcc, const void* data, size_t bytes);
+
+/// @param[out] data output buffer, bytes must not greater than remain output
+void mpeg_avcc_read(struct mpeg_avcc_reader_t* reader, uint8_t* data, size_t bytes);
+
+#endif /* !_mpeg_avcc_h_ */
@@ -7,21 +7,27 @@
 #include <errno.h>
 
 #define MPEG_PACKET_PAYLOAD_MAX_SIZE (10 * 1024 * 1024)
+#define MPEG_PACKET_ERROR_FLAGS (MPEG_FLAG_PACKET_LOST | MPEG_FLAG_PACKET_CORRUPT) // set by ts_demuxer, cleared after output
 
 typedef int (*h2645_find_new_access)(const uint8_t* p, size_t bytes, int* vcl);
 
 static int mpeg_packet_append(struct packet_t* pkt, const void* data, size_t size)
 {
     void* ptr;
+    size_t capacity;
 
     if (pkt->capacity < pkt->size + size)
     {
         if (pkt->size + size > MPEG_PACKET_PAYLOAD_MAX_SIZE)
             return EINVAL;
-        ptr = realloc(pkt->data, pkt->size + size + 2048);
+
+        // geometric growth, keyframe don't realloc per TS packet
+        capacity = pkt->size + size + (pkt->size + size) / 2 + 2048;
+        capacity = capacity > MPEG_PACKET_PAYLOAD_MAX_SIZE ? MPEG_PACKET_PAYLOAD_MAX_SIZE : capacity;
+        ptr = realloc(pkt->data, capacity);
         if (NULL == ptr) return ENOMEM;
         pkt->data = (uint8_t*)ptr;
-        pkt->capacity = pkt->size + size + 2048;
+        pkt->capacity = capacity;
     }
 
     // append new data
@@ -87,6 +93,7 @@ static int mpeg_packet_h264_h265(struct packet_t* pkt, const struct pes_t* pes,
 
         data = p;
         pkt->vcl = 0; // next frame
+        pkt->flags &= ~MPEG_PACKET_ERROR_FLAGS;
         n = find(p, end - p, &pkt->vcl);
     }
 
@@ -95,7 +102,7 @@ static int mpeg_packet_h264_h265(struct packet_t* pkt, const struct pes_t* pes,
     pkt->dts = pes->dts;
     pkt->sid = pes->sid;
     pkt->codecid = pes->codecid;
-    pkt->flags = pes->data_alignment_indicator ? 1 : 0;
+    pkt->flags = (pkt->flags & MPEG_PACKET_ERROR_FLAGS) | (pes->data_alignment_indicator ? 1 : 0);
 //    assert(0 == find(p, end - p)); // start with AUD
 
     // remain data
@@ -129,6 +136,7 @@ int pes_packet(struct packet_t* pkt, const struct pes_t* pes, const void* data,
             assert(PTS_NO_VALUE != pkt->dts);
             r = handler(param, pes->pn, pes->pid, pkt->codecid, pkt->flags, pkt->pts, pkt->dts, pkt->data, pkt->size);
             pkt->size = 0; // new packet start
+            pkt->flags &= ~MPEG_PACKET_ERROR_FLAGS;
             if (0 != r)
                 return r;
         }
@@ -142,7 +150,7 @@ int pes_packet(struct packet_t* pkt, const struct pes_t* pes, const void* data,
         pkt->dts = pes->dts;
         pkt->sid = pes->sid;
         pkt->codecid = pes->codecid;
-        pkt->flags = pes->data_alignment_indicator ? 1 : 0;
+        pkt->flags = (pkt->flags & MPEG_PACKET_ERROR_FLAGS) | (pes->data_alignment_indicator ? 1 : 0);
 
         // for audio packet only, H.264/H.265 pes->len maybe incorrect
         assert(PSI_STREAM_H264 != pes->codecid && PSI_STREAM_H265 != pes->codecid);
@@ -151,8 +159,152 @@ int pes_packet(struct packet_t* pkt, const struct pes_t* pes, const void* data,
             assert(pes->pkt.size == pes->len); // packet lost
             r = handler(param, pes->pn, pes->pid, pkt->codecid, pkt->flags, pkt->pts, pkt->dts, pes->pkt.data, pes->len);
             pkt->size = 0; // new packet start
+            pkt->flags &= ~MPEG_PACKET_ERROR_FLAGS;
+        }
+    }
+
+    return r;
+}
+
+void pes_packet_free(struct packet_t* pkt)
+{
+    if (pkt->data)
+        free(pkt->data);
+    if (pkt->fragments)
+        free(pkt->fragments);
+    pkt->data = NULL;
+    pkt->size = pkt->capacity = 0;
+    pkt->fragments = NULL;
+    pkt->fragment_count = pkt->fragment_capacity = 0;
+    pkt->fragment_bytes = 0;
+}
+
+static int mpeg_packet_fragment_append(struct packet_t* pkt, const void* data, size_t size)
+{
+    int n;
+    void* ptr;
+    struct mpeg_fragment_t* last;
+
+    if (pkt->fragment_count > 0)
+    {
+        last = &pkt->fragments[pkt->fragment_count];
+        if (last->ptr + last->bytes == (const uint8_t*)data)
+        {
+            last->bytes += size; // continuous input, e.g. PS
+            pkt->fragment_bytes += size;
+            return 0;
         }
     }
 
+    if (pkt->size + pkt->fragment_bytes + size > MPEG_PACKET_PAYLOAD_MAX_SIZE)
+        return EINVAL;
+
+    // fragments[0]: packet data
+    if (pkt->fragment_count + 2 > pkt->fragment_capacity)
+    {
+        n = pkt->fragment_count + 2 + (pkt->fragment_count + 2) / 2 + 16;
+        ptr = realloc(pkt->fragments, n * sizeof(pkt->fragments[0]));
+        if (NULL == ptr) return ENOMEM;
+        pkt->fragments = (struct mpeg_fragment_t*)ptr;
+        pkt->fragment_capacity = n;
+    }
+
+    pkt->fragment_count++;
+    pkt->fragments[pkt->fragment_count].ptr = (const uint8_t*)data;
+    pkt->fragments[pkt->fragment_count].bytes = size;
+    pkt->fragment_bytes += size;
+    return 0;
+}
+
+static int mpeg_packet_fragment_output(struct packet_t* pkt, const struct pes_t* pes, pes_fragment_handler handler, void* param)
+{
+    int r;
+    struct mpeg_fragment_t fragment;
+
+    if (0 == pkt->fragment_count)
+    {
+        fragment.ptr = pkt->data;
+        fragment.bytes = pkt->size;
+        r = handler(param, pes->pn, pes->pid, pkt->codecid, pkt->flags, pkt->pts, pkt->dts, &fragment, 1);
+    }
+    else if (pkt->size > 0)
+    {
+        pkt->fragments[0].ptr = pkt->data;
+        pkt->fragments[0].bytes = pkt->size;
+        r = handler(param, pes->pn, pes->pid, pkt->codecid, pkt->flags, pkt->pts, pkt->dts, pkt->fragments, pkt->fragment_count + 1);
+    }
+    else
+    {
+        r = handler(param, pes->pn, pes->pid, pkt->codecid, pkt->flags, pkt->pts, pkt->dts, pkt->fragments + 1, pkt->fragment_count);
+    }
+
+    // new packet start
+    pkt->size = 0;
+    pkt->fragment_count = 0;
+    pkt->fragment_bytes = 0;
+    pkt->flags &= ~MPEG_PACKET_ERROR_FLAGS;
+    return r;
+}
+
+int pes_packet_fragment(struct packet_t* pkt, const struct pes_t* pes, const void* data, size_t size, int start, pes_fragment_handler handler, void* param)
+{
+    int r;
+
+    // same as audio packet, use PES start/timestamp to split packet
+    if (pkt->size + pkt->fragment_bytes > 0 && (pkt->dts != pes->dts || start))
+    {
+        r = mpeg_packet_fragment_output(pkt, pes, handler, param);
+        if (0 != r)
+            return r;
+    }
+
+    if (size > 0)
+    {
+        r = mpeg_packet_fragment_append(pkt, data, size);
+        if (0 != r)
+            return r;
+    }
+
+    // save pts/dts
+    pkt->pts = pes->pts;
+    pkt->dts = pes->dts;
+    pkt->sid = pes->sid;
+    pkt->codecid = pes->codecid;
+    pkt->flags = (pkt->flags & MPEG_PACKET_ERROR_FLAGS) | (pes->data_alignment_indicator ? 1 : 0);
+
+    // H.264/H.265 pes->len maybe incorrect
+    if (PSI_STREAM_H264 != pes->codecid && PSI_STREAM_H265 != pes->codecid && pes->len > 0 && pkt->size + pkt->fragment_bytes >= pes->len)
+        return mpeg_packet_fragment_output(pkt, pes, handler, param);
+    return 0;
+}
+
+int pes_packet_fragment_retain(struct packet_t* pkt)
+{
+    int i, r;
+
+    for (r = 0, i = 1; i <= pkt->fragment_count && 0 == r; i++)
+        r = mpeg_packet_append(pkt, pkt->fragments[i].ptr, pkt->fragments[i].bytes);
+
+    if (0 != r)
+    {
+        pkt->size = 0; // drop packet
+        pkt->flags |= MPEG_FLAG_PACKET_LOST;
+    }
+    pkt->fragment_count = 0;
+    pkt->fragment_bytes = 0;
     return r;
 }
+
+size_t mpeg_fragment_copy(const struct mpeg_fragment_t* fragments, int count, void* data, size_t bytes)
+{
+    int i;
+    size_t n;
+    for (n = i = 0; i < count; i++)
+    {
+        if (n + fragments[i].bytes > bytes)
+            return 0;
+        memcpy((uint8_t*)data + n, fragments[i].ptr, fragments[i].bytes);
+        n += fragments[i].bytes;
+    }
+    return n;
+}
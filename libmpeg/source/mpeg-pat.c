@@ -87,7 +87,12 @@ size_t pat_read(struct pat_t *pat, const uint8_t* data, size_t bytes)
 	assert(PAT_TID_PAS == table_id);
 	assert(1 == section_syntax_indicator);
     if(pat->ver != version_number)
-        pat->pmt_count = 0; // clear all pmts
+    {
+        // clear all pmts
+        for (i = 0; i < pat->pmt_count; i++)
+            pmt_free_streams(&pat->pmts[i]);
+        pat->pmt_count = 0;
+    }
 	pat->tsid = transport_stream_id;
 	pat->ver = version_number;
 
@@ -9,23 +9,58 @@
 #include <string.h>
 #include <assert.h>
 
+struct pes_t* pmt_alloc_stream(struct pmt_t* pmt)
+{
+	void* ptr;
+	unsigned int n;
+
+	if (pmt->stream_count >= pmt->stream_capacity)
+	{
+		if (pmt->stream_count + 1 > PMT_STREAM_MAX)
+			return NULL;
+
+		n = pmt->stream_capacity + pmt->stream_capacity / 4 + 4;
+		ptr = realloc(pmt->streams, sizeof(pmt->streams[0]) * n);
+		if (!ptr)
+			return NULL;
+
+		// new streams, slots after stream_count keep PES buffer for reuse
+		memset((struct pes_t*)ptr + pmt->stream_capacity, 0, sizeof(pmt->streams[0]) * (n - pmt->stream_capacity));
+		pmt->streams = (struct pes_t*)ptr;
+		pmt->stream_capacity = n;
+	}
+
+	return &pmt->streams[pmt->stream_count];
+}
+
+void pmt_free_streams(struct pmt_t* pmt)
+{
+	unsigned int i;
+	for (i = 0; i < pmt->stream_capacity; i++)
+		pes_packet_free(&pmt->streams[i].pkt);
+
+	if (pmt->streams)
+		free(pmt->streams);
+	pmt->streams = NULL;
+	pmt->stream_count = 0;
+	pmt->stream_capacity = 0;
+}
+
 static struct pes_t* pmt_fetch(struct pmt_t* pmt, uint16_t pid)
 {
     unsigned int i;
+    struct pes_t* stream;
     for(i = 0; i < pmt->stream_count; i++)
     {
         if(pmt->streams[i].pid == pid)
             return &pmt->streams[i];
     }
     
-    if(pmt->stream_count >= sizeof(pmt->streams) / sizeof(pmt->streams[0]))
-    {
-        assert(0);
-        return NULL;
-    }
-    
     // new stream
-    return &pmt->streams[pmt->stream_count++];
+    stream = pmt_alloc_stream(pmt);
+    if (stream)
+        pmt->stream_count++;
+    return stream;
 }
 
 static int pmt_read_descriptor(struct pes_t* stream, const uint8_t* data, uint16_t bytes)
@@ -151,7 +186,6 @@ size_t pmt_read(struct pmt_t *pmt, const uint8_t* data, size_t bytes)
 
 		if (i + len + 5 > section_length + 3 - 4/*CRC32*/)
 			break;
-        assert(pmt->stream_count <= sizeof(pmt->streams)/sizeof(pmt->streams[0]));
         stream = pmt_fetch(pmt, pid);
         if(NULL == stream)
             continue;
@@ -244,7 +278,6 @@ size_t pmt_write(const struct pmt_t *pmt, uint8_t *data)
 	// section_length
 	len = p + 4 - (data + 3); // 4 bytes crc32
 	assert(len <= 1021); // shall not exceed 1021 (0x3FD).
-	assert(len <= TS_PACKET_SIZE - 7);
 	// section_syntax_indicator '1'
 	// '0'
 	// reserved '11'
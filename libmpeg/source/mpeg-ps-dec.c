@@ -26,6 +26,9 @@ struct ps_demuxer_t
 
     struct ps_demuxer_notify_t notify;
     void* notify_param;
+
+    ps_demuxer_onfragment onfragment;
+    void* fragment_param;
 };
 
 static void ps_demuxer_notify(struct ps_demuxer_t* ps);
@@ -38,6 +41,14 @@ static int ps_demuxer_onpes(void* param, int program, int stream, int codecid, i
     return ps->onpacket(ps->param, stream, codecid, flags, pts, dts, data, bytes);
 }
 
+static int ps_demuxer_onfragment_pes(void* param, int program, int stream, int codecid, int flags, int64_t pts, int64_t dts, const struct mpeg_fragment_t* fragments, int count)
+{
+    struct ps_demuxer_t* ps;
+    ps = (struct ps_demuxer_t*)param;
+    assert(0 == program); // unused(ts demux only)
+    return ps->onfragment(ps->fragment_param, stream, codecid, flags, pts, dts, fragments, count);
+}
+
 static struct pes_t* psm_fetch(struct psm_t* psm, uint8_t sid)
 {
     size_t i;
@@ -142,7 +153,10 @@ static int pes_packet_read(struct ps_demuxer_t *ps, const uint8_t* data, size_t
 
 			if (0 == j) continue;
 
-            r = pes_packet(&pes->pkt, pes, data + i + j, pes_packet_length + 6 - j, ps->start, ps_demuxer_onpes, ps);
+            if (ps->onfragment)
+                r = pes_packet_fragment(&pes->pkt, pes, data + i + j, pes_packet_length + 6 - j, (PSI_STREAM_H264 == pes->codecid || PSI_STREAM_H265 == pes->codecid) ? 0 : ps->start, ps_demuxer_onfragment_pes, ps); // video frame span packs
+            else
+                r = pes_packet(&pes->pkt, pes, data + i + j, pes_packet_length + 6 - j, ps->start, ps_demuxer_onpes, ps);
             ps->start = 0; // clear start flag
             if (0 != r)
                 return r;
@@ -179,7 +193,7 @@ static size_t ps_demuxer_find_startcode(const uint8_t* data, size_t bytes)
     return p - data;
 }
 
-int ps_demuxer_input(struct ps_demuxer_t* ps, const uint8_t* data, size_t bytes)
+static int ps_demuxer_read(struct ps_demuxer_t* ps, const uint8_t* data, size_t bytes)
 {
     int n;
 	size_t i;
@@ -219,6 +233,26 @@ int ps_demuxer_input(struct ps_demuxer_t* ps, const uint8_t* data, size_t bytes)
 	return (int)i;
 }
 
+int ps_demuxer_input(struct ps_demuxer_t* ps, const uint8_t* data, size_t bytes)
+{
+    int r, e;
+    size_t i;
+
+    r = ps_demuxer_read(ps, data, bytes);
+    if (ps->onfragment)
+    {
+        // copy pending fragments, input data can't be referenced after return
+        for (i = 0; i < ps->psm.stream_count; i++)
+        {
+            if (ps->psm.streams[i].pkt.fragment_count < 1)
+                continue;
+            e = pes_packet_fragment_retain(&ps->psm.streams[i].pkt);
+            r = (r >= 0 && 0 != e) ? -e : r;
+        }
+    }
+    return r;
+}
+
 struct ps_demuxer_t* ps_demuxer_create(ps_demuxer_onpacket onpacket, void* param)
 {
 	struct ps_demuxer_t* ps;
@@ -235,13 +269,9 @@ struct ps_demuxer_t* ps_demuxer_create(ps_demuxer_onpacket onpacket, void* param
 int ps_demuxer_destroy(struct ps_demuxer_t* ps)
 {
     size_t i;
-    struct pes_t* pes;
     for (i = 0; i < ps->psm.stream_count; i++)
     {
-        pes = &ps->psm.streams[i];
-        if (pes->pkt.data)
-            free(pes->pkt.data);
-        pes->pkt.data = NULL;
+        pes_packet_free(&ps->psm.streams[i].pkt);
     }
 
 	free(ps);
@@ -254,6 +284,12 @@ void ps_demuxer_set_notify(struct ps_demuxer_t* ps, struct ps_demuxer_notify_t *
     memcpy(&ps->notify, notify, sizeof(ps->notify));
 }
 
+void ps_demuxer_set_onfragment(struct ps_demuxer_t* ps, ps_demuxer_onfragment onfragment, void* param)
+{
+    ps->onfragment = onfragment;
+    ps->fragment_param = param;
+}
+
 static void ps_demuxer_notify(struct ps_demuxer_t* ps)
 {
     size_t i;
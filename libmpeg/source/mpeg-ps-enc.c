@@ -6,6 +6,7 @@
 #include "mpeg-ps-proto.h"
 #include "mpeg-pes-proto.h"
 #include "mpeg-util.h"
+#include "mpeg-avcc.h"
 #include "mpeg-ps.h"
 #include <errno.h>
 #include <stdio.h>
@@ -49,14 +50,16 @@ int ps_muxer_input(struct ps_muxer_t* ps, int streamid, int flags, int64_t pts,
 	size_t i, n, sz;
 	uint8_t *packet;
     struct pes_t* stream;
-    const uint8_t* payload;
+    struct mpeg_avcc_reader_t payload;
 
 	i = 0;
 	first = 1;
-	payload = (const uint8_t*)data;
 
     stream = ps_stream_find(ps, streamid);
     if (NULL == stream) return -1; // not found
+    r = mpeg_avcc_reader_init(&payload, stream->avcc, data, bytes);
+    if (0 != r) return r;
+    bytes = payload.total; // Annex B
     stream->data_alignment_indicator = (flags & MPEG_FLAG_IDR_FRAME) ? 1 : 0; // idr frame
     stream->pts = pts;
     stream->dts = dts;
@@ -140,8 +143,7 @@ int ps_muxer_input(struct ps_muxer_t* ps, int streamid, int flags, int64_t pts,
 			n = bytes;
 		}
 
-		memcpy(p, payload, n);
-		payload += n;
+		mpeg_avcc_read(&payload, p, n);
 		bytes -= n;
 
 		// notify packet already
@@ -201,6 +203,8 @@ int ps_muxer_destroy(struct ps_muxer_t* ps)
             free(ps->psm.streams[i].esinfo);
             ps->psm.streams[i].esinfo = NULL;
         }
+        if (ps->psm.streams[i].avcc)
+            free(ps->psm.streams[i].avcc);
     }
 
 	free(ps);
@@ -269,3 +273,11 @@ int ps_muxer_add_stream(struct ps_muxer_t* ps, int codecid, const void* extradat
 	ps->psm_period = 0; // immediate update psm
 	return pes->sid;
 }
+
+int ps_muxer_set_avcc(struct ps_muxer_t* ps, int streamid, const void* record, size_t bytes)
+{
+	struct pes_t* stream;
+	stream = ps_stream_find(ps, streamid);
+	if (NULL == stream) return -1; // not found
+	return mpeg_avcc_set(&stream->avcc, stream->codecid, record, bytes);
+}
@@ -13,16 +13,34 @@
 #include <stdio.h>
 #include <errno.h>
 
+#define TS_M2TS_PACKET_SIZE		192 // BDAV MPEG-2 TS: 4-bytes TP_extra_header + TS packet
+#define TS_SYNC_LOOKAHEAD		3 // consecutive sync bytes to lock packet size
+
+#define TS_PID_MAP_PMT			0x80000000 // | pmt index
+#define TS_PID_MAP_PES			0x40000000 // | pmt index << 8 | stream index
+
 struct ts_demuxer_t
 {
     struct pat_t pat;
-	uint8_t cc;
+	uint8_t cc[8192]; // per-PID continuity_counter, 0xFF-unknown
+	uint32_t pids[8192]; // PID -> PMT/PES index, 0-unknown/filtered PID
+
+	// ts_demuxer_input packet alignment
+	size_t size; // packet size: 188-TS, 192-M2TS, 0-not synchronized
+	uint8_t ptr[TS_SYNC_LOOKAHEAD * TS_M2TS_PACKET_SIZE]; // partial packet or sync lookahead
+	size_t n;
 
     ts_demuxer_onpacket onpacket;
     void* param;
 
 	struct ts_demuxer_notify_t notify;
 	void* notify_param;
+
+	ts_demuxer_onfilter onfilter;
+	void* filter_param;
+
+	ts_demuxer_onfragment onfragment;
+	void* fragment_param;
 };
 
 static void ts_demuxer_notify(struct ts_demuxer_t* ts, const struct pmt_t* pmt);
@@ -133,6 +151,12 @@ int ts_demuxer_flush(struct ts_demuxer_t* ts)
         for (j = 0; j < ts->pat.pmts[i].stream_count; j++)
         {
             struct pes_t* pes = &ts->pat.pmts[i].streams[j];
+            if (ts->onfragment)
+            {
+                pes_packet_fragment(&pes->pkt, pes, NULL, 0, 1, ts->onfragment, ts->fragment_param);
+                continue;
+            }
+
             if (pes->pkt.size < 5)
                 continue;
             
@@ -156,17 +180,61 @@ int ts_demuxer_flush(struct ts_demuxer_t* ts)
     return 0;
 }
 
-int ts_demuxer_input(struct ts_demuxer_t* ts, const uint8_t* data, size_t bytes)
+static void ts_demuxer_pid_map(struct ts_demuxer_t* ts)
+{
+	uint32_t i, j;
+	struct pmt_t* pmt;
+
+	memset(ts->pids, 0, sizeof(ts->pids));
+	for (i = 0; i < ts->pat.pmt_count; i++)
+	{
+		pmt = &ts->pat.pmts[i];
+		for (j = 0; j < pmt->stream_count; j++)
+		{
+			if (ts->onfilter && 0 == ts->onfilter(ts->filter_param, pmt->pn, pmt->streams[j].pid, pmt->streams[j].codecid))
+				continue; // skip PES
+			assert(j < PMT_STREAM_MAX); // 8-bits stream index
+			ts->pids[pmt->streams[j].pid & 0x1FFF] = TS_PID_MAP_PES | (i << 8) | j;
+		}
+	}
+
+	// PMT first, same as linear search order
+	for (i = 0; i < ts->pat.pmt_count; i++)
+		ts->pids[ts->pat.pmts[i].pid & 0x1FFF] = TS_PID_MAP_PMT | i;
+}
+
+/// 2.4.3.3 continuity_counter: increments with each packet with payload, a duplicate packet may be sent once
+/// @return 0-ok, 1-duplicate packet, -1-discontinuity
+static int ts_demuxer_continuity(struct ts_demuxer_t* ts, uint32_t PID, const struct ts_packet_header_t* pkhd)
+{
+	uint8_t cc;
+	if (TS_PID_NULL == PID || 0 == (0x01 & pkhd->adaptation_field_control))
+		return 0; // no payload, counter not incremented
+
+	cc = ts->cc[PID];
+	ts->cc[PID] = (uint8_t)pkhd->continuity_counter;
+	if (cc > 0x0F || (pkhd->adaptation.adaptation_field_length > 0 && pkhd->adaptation.discontinuity_indicator))
+		return 0;
+	if (cc == pkhd->continuity_counter)
+		return 1;
+	return ((cc + 1) & 0x0F) == pkhd->continuity_counter ? 0 : -1;
+}
+
+static int ts_demuxer_packet(struct ts_demuxer_t* ts, const uint8_t* data)
 {
     int r = 0;
-    uint32_t i, j, k;
+    uint32_t i, j;
 	uint32_t PID;
-	unsigned int count;
+	unsigned int count, ver;
+	int flags;
+	size_t bytes;
+	struct pes_t* pes;
+	struct pmt_t* pmt;
     struct ts_packet_header_t pkhd;
 
 	// 2.4.3 Specification of the transport stream syntax and semantics
 	// Transport stream packets shall be 188 bytes long.
-	assert(188 == bytes);
+	bytes = TS_PACKET_SIZE;
 
 	// 2.4.3.2 Transport stream packet layer
 	// Table 2-2
@@ -179,13 +247,6 @@ int ts_demuxer_input(struct ts_demuxer_t* ts, const uint8_t* data, size_t bytes)
 	pkhd.transport_scrambling_control = (data[3] >> 6) & 0x03;
 	pkhd.adaptation_field_control = (data[3] >> 4) & 0x03;
 	pkhd.continuity_counter = data[3] & 0x0F;
-	
-	if (((ts->cc + 1) % 15) != (uint8_t)pkhd.continuity_counter)
-	{
-		// 1. PAT/PMT reset
-		// 2. pes packet corrupt
-	}
-	ts->cc = (uint8_t)pkhd.continuity_counter;
 
 //	printf("-----------------------------------------------\n");
 //	printf("PID[%u]: Error: %u, Start:%u, Priority:%u, Scrambler:%u, AF: %u, CC: %u\n", PID, pkhd.transport_error_indicator, pkhd.payload_unit_start_indicator, pkhd.transport_priority, pkhd.transport_scrambling_control, pkhd.adaptation_field_control, pkhd.continuity_counter);
@@ -202,15 +263,29 @@ int ts_demuxer_input(struct ts_demuxer_t* ts, const uint8_t* data, size_t bytes)
 			//printf("pcr: %02d:%02d:%02d.%03d - %" PRId64 "/%u\n", (int)(t / 3600000), (int)(t % 3600000)/60000, (int)((t/1000) % 60), (int)(t % 1000), pkhd.adaptation.program_clock_reference_base, pkhd.adaptation.program_clock_reference_extension);
 		}
 	}
-    
+
+	r = ts_demuxer_continuity(ts, PID, &pkhd);
+	if (r > 0)
+		return 0; // duplicate packet
+	flags = (r < 0 ? MPEG_FLAG_PACKET_LOST : 0) | (pkhd.transport_error_indicator ? MPEG_FLAG_PACKET_CORRUPT : 0);
+	r = 0;
+
 	if(0x01 & pkhd.adaptation_field_control)
 	{
-		if(TS_PID_PAT == PID)
+		if (pkhd.transport_error_indicator && 0 == (TS_PID_MAP_PES & ts->pids[PID]))
+		{
+			return 0; // don't update PAT/PMT with corrupt section
+		}
+		else if(TS_PID_PAT == PID)
 		{
 			if(pkhd.payload_unit_start_indicator)
 				i += 1; // pointer 0x00
 
+			count = ts->pat.pmt_count;
+			ver = ts->pat.ver;
 			pat_read(&ts->pat, data + i, bytes - i);
+			if (count != ts->pat.pmt_count || ver != ts->pat.ver)
+				ts_demuxer_pid_map(ts);
 		}
         else if(TS_PID_SDT == PID)
         {
@@ -220,43 +295,47 @@ int ts_demuxer_input(struct ts_demuxer_t* ts, const uint8_t* data, size_t bytes)
         }
 		else
 		{
-			for(j = 0; j < ts->pat.pmt_count; j++)
+			j = ts->pids[PID];
+			if (TS_PID_MAP_PMT & j)
+			{
+				pmt = &ts->pat.pmts[j & 0xFFFF];
+				if(pkhd.payload_unit_start_indicator)
+					i += 1; // pointer 0x00
+
+				count = pmt->stream_count;
+				ver = pmt->ver;
+				pmt_read(pmt, data + i, bytes - i);
+				if(count != pmt->stream_count)
+					ts_demuxer_notify(ts, pmt);
+				if (count != pmt->stream_count || ver != pmt->ver)
+					ts_demuxer_pid_map(ts);
+			}
+			else if (TS_PID_MAP_PES & j)
 			{
-				if(PID == ts->pat.pmts[j].pid)
+				pes = &ts->pat.pmts[(j >> 8) & 0xFFFF].streams[j & 0xFF];
+				if (pkhd.payload_unit_start_indicator)
+				{
+					size_t n;
+					n = pes_read_header(pes, data + i, bytes - i);
+					assert(n > 0);
+					i += n;
+				}
+				else if (0 == pes->sid)
+				{
+					return 0; // don't have pes header yet
+				}
+
+				pes->pkt.flags |= flags;
+				if (ts->onfragment)
 				{
-					if(pkhd.payload_unit_start_indicator)
-						i += 1; // pointer 0x00
-
-					count = ts->pat.pmts[j].stream_count;
-					pmt_read(&ts->pat.pmts[j], data + i, bytes - i);
-					if(count != ts->pat.pmts[j].stream_count)
-						ts_demuxer_notify(ts, &ts->pat.pmts[j]);
-					break;
+					r = pes_packet_fragment(&pes->pkt, pes, data + i, bytes - i, pkhd.payload_unit_start_indicator, ts->onfragment, ts->fragment_param);
+					if (0 == r && data >= ts->ptr && data < ts->ptr + sizeof(ts->ptr))
+						r = pes_packet_fragment_retain(&pes->pkt); // internal buffer will be reused
 				}
 				else
 				{
-					for (k = 0; k < ts->pat.pmts[j].stream_count; k++)
-					{
-                        struct pes_t* pes = &ts->pat.pmts[j].streams[k];
-						if (PID != pes->pid)
-                            continue;
-
-                        if (pkhd.payload_unit_start_indicator)
-                        {
-                            size_t n;
-                            n = pes_read_header(pes, data + i, bytes - i);
-                            assert(n > 0);
-                            i += n;
-						}
-						else if (0 == pes->sid)
-						{
-							continue; // don't have pes header yet
-						}
-
-                        r = pes_packet(&pes->pkt, pes, data + i, bytes - i, pkhd.payload_unit_start_indicator, ts->onpacket, ts->param);
-                        break; // find stream
-					}
-				} // PMT handler
+					r = pes_packet(&pes->pkt, pes, data + i, bytes - i, pkhd.payload_unit_start_indicator, ts->onpacket, ts->param);
+				}
 			}
 		} // PAT handler
 	}
@@ -264,6 +343,188 @@ int ts_demuxer_input(struct ts_demuxer_t* ts, const uint8_t* data, size_t bytes)
 	return r;
 }
 
+static inline uint8_t ts_demuxer_byte(const struct ts_demuxer_t* ts, const uint8_t* data, size_t i)
+{
+	return i < ts->n ? ts->ptr[i] : data[i - ts->n];
+}
+
+/// whole packets only, e.g. one packet or one UDP datagram(7 x 188) per call
+/// @return packet size, 0-not aligned
+static size_t ts_demuxer_aligned(const uint8_t* data, size_t bytes)
+{
+	size_t i;
+	if (0 == bytes % TS_PACKET_SIZE)
+	{
+		for (i = 0; i < bytes && TS_SYNC_BYTE == data[i]; i += TS_PACKET_SIZE);
+		if (i >= bytes)
+			return TS_PACKET_SIZE;
+	}
+
+	if (0 == bytes % TS_M2TS_PACKET_SIZE)
+	{
+		for (i = 0; i < bytes && TS_SYNC_BYTE == data[i + 4]; i += TS_M2TS_PACKET_SIZE);
+		if (i >= bytes)
+			return TS_M2TS_PACKET_SIZE;
+	}
+	return 0;
+}
+
+/// find packet start in pending bytes + data, sync byte must repeat TS_SYNC_LOOKAHEAD times
+/// @param[out] size packet size(188/192), 0-need more data
+/// @return packet start offset
+static size_t ts_demuxer_sync(const struct ts_demuxer_t* ts, const uint8_t* data, size_t bytes, size_t* size)
+{
+	size_t i, j, k, total;
+
+	total = ts->n + bytes;
+	for (i = 0; i < total; i++)
+	{
+		for (j = 0; j < TS_SYNC_LOOKAHEAD && i + j * TS_PACKET_SIZE < total && TS_SYNC_BYTE == ts_demuxer_byte(ts, data, i + j * TS_PACKET_SIZE); j++);
+		if (TS_SYNC_LOOKAHEAD == j)
+		{
+			*size = TS_PACKET_SIZE;
+			return i;
+		}
+
+		// M2TS: sync byte after TP_extra_header
+		for (k = 0; k < TS_SYNC_LOOKAHEAD && i + 4 + k * TS_M2TS_PACKET_SIZE < total && TS_SYNC_BYTE == ts_demuxer_byte(ts, data, i + 4 + k * TS_M2TS_PACKET_SIZE); k++);
+		if (TS_SYNC_LOOKAHEAD == k)
+		{
+			*size = TS_M2TS_PACKET_SIZE;
+			return i;
+		}
+
+		if ((j < TS_SYNC_LOOKAHEAD && i + j * TS_PACKET_SIZE >= total) || (k < TS_SYNC_LOOKAHEAD && i + 4 + k * TS_M2TS_PACKET_SIZE >= total))
+			break; // can't confirm yet
+	}
+
+	*size = 0;
+	return i;
+}
+
+static int ts_demuxer_read(struct ts_demuxer_t* ts, const uint8_t* data, size_t bytes)
+{
+	int r;
+	size_t i, n, off;
+
+	for (r = 0; 0 == r && bytes > 0; )
+	{
+		if (0 == ts->size)
+		{
+			if (0 == ts->n && 0 != (ts->size = ts_demuxer_aligned(data, bytes)))
+				continue;
+
+			i = ts_demuxer_sync(ts, data, bytes, &n);
+			if (i >= ts->n)
+			{
+				data += i - ts->n;
+				bytes -= i - ts->n;
+				ts->n = 0;
+			}
+			else
+			{
+				memmove(ts->ptr, ts->ptr + i, ts->n - i);
+				ts->n -= i;
+			}
+
+			if (0 == n)
+			{
+				// keep lookahead bytes
+				assert(ts->n + bytes <= sizeof(ts->ptr));
+				memcpy(ts->ptr + ts->n, data, bytes);
+				ts->n += bytes;
+				return 0;
+			}
+			ts->size = n;
+		}
+
+		off = TS_M2TS_PACKET_SIZE == ts->size ? 4 : 0;
+		if (ts->n > 0)
+		{
+			// complete pending packet
+			if (ts->n < ts->size)
+			{
+				n = ts->size - ts->n < bytes ? ts->size - ts->n : bytes;
+				memcpy(ts->ptr + ts->n, data, n);
+				ts->n += n;
+				data += n;
+				bytes -= n;
+				if (ts->n < ts->size)
+					return 0;
+			}
+
+			if (TS_SYNC_BYTE == ts->ptr[off])
+			{
+				r = ts_demuxer_packet(ts, ts->ptr + off);
+				n = ts->size;
+			}
+			else
+			{
+				ts->size = 0; // sync lost, search from next byte
+				n = 1;
+			}
+
+			memmove(ts->ptr, ts->ptr + n, ts->n - n);
+			ts->n -= n;
+			continue;
+		}
+
+		for (; 0 == r && bytes >= ts->size && TS_SYNC_BYTE == data[off]; data += ts->size, bytes -= ts->size)
+			r = ts_demuxer_packet(ts, data + off);
+
+		if (0 != r || 0 == bytes)
+			break;
+
+		if (bytes < ts->size && (bytes <= off || TS_SYNC_BYTE == data[off]))
+		{
+			// partial packet
+			memcpy(ts->ptr, data, bytes);
+			ts->n = bytes;
+			break;
+		}
+
+		// sync lost, search from next byte
+		ts->size = 0;
+		data += 1;
+		bytes -= 1;
+	}
+
+	return r;
+}
+
+/// copy pending fragments, input data can't be referenced after ts_demuxer_input return
+static int ts_demuxer_retain(struct ts_demuxer_t* ts)
+{
+	int r, e;
+	uint32_t i, j;
+	struct pmt_t* pmt;
+
+	for (r = 0, i = 0; i < ts->pat.pmt_count; i++)
+	{
+		pmt = &ts->pat.pmts[i];
+		for (j = 0; j < pmt->stream_count; j++)
+		{
+			if (pmt->streams[j].pkt.fragment_count < 1)
+				continue;
+			e = pes_packet_fragment_retain(&pmt->streams[j].pkt);
+			r = 0 == r ? e : r;
+		}
+	}
+	return r;
+}
+
+int ts_demuxer_input(struct ts_demuxer_t* ts, const uint8_t* data, size_t bytes)
+{
+	int r, e;
+	r = ts_demuxer_read(ts, data, bytes);
+	if (ts->onfragment)
+	{
+		e = ts_demuxer_retain(ts);
+		r = 0 == r ? e : r;
+	}
+	return r;
+}
+
 static inline int mpeg_ts_is_idr_first_packet(const void* packet, int bytes)
 {
 	const unsigned char *data;
@@ -294,22 +555,16 @@ struct ts_demuxer_t* ts_demuxer_create(ts_demuxer_onpacket onpacket, void* param
 
     ts->onpacket = onpacket;
     ts->param = param;
+    memset(ts->cc, 0xFF, sizeof(ts->cc));
     return ts;
 }
 
 int ts_demuxer_destroy(struct ts_demuxer_t* ts)
 {
-    size_t i, j;
-    struct pes_t* pes;
+    size_t i;
     for (i = 0; i < ts->pat.pmt_count; i++)
     {
-        for (j = 0; j < ts->pat.pmts[i].stream_count; j++)
-        {
-            pes = &ts->pat.pmts[i].streams[j];
-            if (pes->pkt.data)
-                free(pes->pkt.data);
-            pes->pkt.data = NULL;
-        }
+        pmt_free_streams(&ts->pat.pmts[i]);
     }
 
 	if (ts->pat.pmts && ts->pat.pmts != ts->pat.pmt_default)
@@ -337,6 +592,19 @@ void ts_demuxer_set_notify(struct ts_demuxer_t* ts, struct ts_demuxer_notify_t*
 	memcpy(&ts->notify, notify, sizeof(ts->notify));
 }
 
+void ts_demuxer_set_filter(struct ts_demuxer_t* ts, ts_demuxer_onfilter onfilter, void* param)
+{
+	ts->onfilter = onfilter;
+	ts->filter_param = param;
+	ts_demuxer_pid_map(ts);
+}
+
+void ts_demuxer_set_onfragment(struct ts_demuxer_t* ts, ts_demuxer_onfragment onfragment, void* param)
+{
+	ts->onfragment = onfragment;
+	ts->fragment_param = param;
+}
+
 static void ts_demuxer_notify(struct ts_demuxer_t* ts, const struct pmt_t* pmt)
 {
 	unsigned int i;
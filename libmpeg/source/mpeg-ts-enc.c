@@ -4,6 +4,7 @@
 
 #include "mpeg-ts-proto.h"
 #include "mpeg-util.h"
+#include "mpeg-avcc.h"
 #include "mpeg-ts.h"
 #include <errno.h>
 #include <stdlib.h>
@@ -32,22 +33,24 @@ typedef struct _mpeg_ts_enc_context_t
 	int64_t pcr_clock; // last pcr time
 
 	uint16_t pid;
+	int batch; // 1-one alloc/write per PES packet
 
 	struct mpeg_ts_func_t func;
 	void* param;
 
+	// serialized PAT + PMT TS packets, only continuity_counter changes between PSI periods
+	uint8_t* psi;
+	size_t psi_count; // TS packet count, 0-rebuild on next write
+	size_t psi_capacity;
+
 	uint8_t payload[1024]; // maximum PAT/PMT payload length
 } mpeg_ts_enc_context_t;
 
 static void mpeg_ts_pmt_destroy(struct pmt_t* pmt);
 
-static int mpeg_ts_write_section_header(const mpeg_ts_enc_context_t *ts, int pid, unsigned int* cc, const void* payload, size_t len)
+/// @param[out] data TS packet buffer, TS_PACKET_SIZE bytes, continuity_counter set on write
+static void mpeg_ts_write_section_header(uint8_t* data, int pid, const void* payload, size_t len)
 {
-	int r;
-	uint8_t *data = NULL;
-	data = ts->func.alloc(ts->param, TS_PACKET_SIZE);
-	if(!data) return ENOMEM;
-
 	assert(len < TS_PACKET_SIZE - 5); // TS-header + pointer
 
 	// TS Header
@@ -61,8 +64,7 @@ static int mpeg_ts_write_section_header(const mpeg_ts_enc_context_t *ts, int pid
 	data[2] = pid & 0xFF;
 	// transport_scrambling_control = 0x00
 	// adaptation_field_control = 0x01-No adaptation_field, payload only, 0x03-adaptation and payload
-	data[3] = 0x10 | (*cc & 0x0F);
-	*cc = (*cc + 1) % 16; // update continuity_counter
+	data[3] = 0x10;
 
 //	// Adaptation
 //	if(len < TS_PACKET_SIZE - 5)
@@ -85,155 +87,267 @@ static int mpeg_ts_write_section_header(const mpeg_ts_enc_context_t *ts, int pid
     //memmove(data + TS_PACKET_SIZE - len, payload, len);
     memmove(data + 5, payload, len);
     memset(data+5+len, 0xff, TS_PACKET_SIZE-len-5);
+}
+
+/// PAT/PMT changed(program/stream/PCR_PID), serialize sections again on next write
+static void mpeg_ts_psi_invalidate(mpeg_ts_enc_context_t* tsctx)
+{
+	tsctx->psi_count = 0;
+}
+
+static int mpeg_ts_psi_build(mpeg_ts_enc_context_t* tsctx)
+{
+	size_t i, n;
+	void* ptr;
+
+	n = 1 + tsctx->pat.pmt_count;
+	if (n > tsctx->psi_capacity)
+	{
+		ptr = realloc(tsctx->psi, n * TS_PACKET_SIZE);
+		if (!ptr) return ENOMEM;
+		tsctx->psi = (uint8_t*)ptr;
+		tsctx->psi_capacity = n;
+	}
+
+	// PAT(program_association_section)
+	n = pat_write(&tsctx->pat, tsctx->payload);
+	mpeg_ts_write_section_header(tsctx->psi, PAT_TID_PAS, tsctx->payload, n); // PID = 0x00 program association table
+
+	// PMT(Transport stream program map section)
+	for (i = 0; i < tsctx->pat.pmt_count; i++)
+	{
+		n = pmt_write(&tsctx->pat.pmts[i], tsctx->payload);
+		mpeg_ts_write_section_header(tsctx->psi + (i + 1) * TS_PACKET_SIZE, tsctx->pat.pmts[i].pid, tsctx->payload, n);
+	}
+
+	tsctx->psi_count = 1 + tsctx->pat.pmt_count;
+	return 0;
+}
+
+static void mpeg_ts_psi_cc(mpeg_ts_enc_context_t* tsctx, uint8_t* data, size_t i)
+{
+	unsigned int* cc;
+	cc = 0 == i ? &tsctx->pat.cc : &tsctx->pat.pmts[i - 1].cc;
+	data[3] = (data[3] & 0xF0) | (*cc & 0x0F);
+	*cc = (*cc + 1) % 16; // update continuity_counter
+}
+
+static int mpeg_ts_psi_write(mpeg_ts_enc_context_t* tsctx)
+{
+	int r;
+	size_t i;
+	uint8_t* data;
+
+	if (0 == tsctx->psi_count)
+	{
+		r = mpeg_ts_psi_build(tsctx);
+		if (0 != r) return r;
+	}
+
+	if (tsctx->batch)
+	{
+		data = tsctx->func.alloc(tsctx->param, tsctx->psi_count * TS_PACKET_SIZE);
+		if (!data) return ENOMEM;
+
+		memcpy(data, tsctx->psi, tsctx->psi_count * TS_PACKET_SIZE);
+		for (i = 0; i < tsctx->psi_count; i++)
+			mpeg_ts_psi_cc(tsctx, data + i * TS_PACKET_SIZE, i);
+
+		r = tsctx->func.write(tsctx->param, data, tsctx->psi_count * TS_PACKET_SIZE);
+		tsctx->func.free(tsctx->param, data);
+		return r;
+	}
 
-	r = ts->func.write(ts->param, data, TS_PACKET_SIZE);
-	ts->func.free(ts->param, data);
+	for (r = 0, i = 0; 0 == r && i < tsctx->psi_count; i++)
+	{
+		data = tsctx->func.alloc(tsctx->param, TS_PACKET_SIZE);
+		if (!data) return ENOMEM;
+
+		memcpy(data, tsctx->psi + i * TS_PACKET_SIZE, TS_PACKET_SIZE);
+		mpeg_ts_psi_cc(tsctx, data, i);
+
+		r = tsctx->func.write(tsctx->param, data, TS_PACKET_SIZE);
+		tsctx->func.free(tsctx->param, data);
+	}
 	return r;
 }
 
-static int ts_write_pes(mpeg_ts_enc_context_t *tsctx, const struct pmt_t* pmt, struct pes_t *stream, const uint8_t* payload, size_t bytes)
+/// Fill one TS packet with PES data
+/// @param[in] data TS packet buffer, TS_PACKET_SIZE bytes
+/// @param[in] start 1-first TS packet of PES(write PES header), 0-continue
+/// @param[in] bytes remain payload length in byte(Annex B)
+/// @return consumed payload length in byte
+static size_t ts_write_pes_packet(mpeg_ts_enc_context_t *tsctx, const struct pmt_t* pmt, struct pes_t *stream, uint8_t* data, int start, struct mpeg_avcc_reader_t* payload, size_t bytes)
 {
 	// 2.4.3.6 PES packet
 	// Table 2-21
 
-	int r = 0;
 	size_t len = 0;
-	int start = 1; // first packet
-    uint8_t *p = NULL;
-	uint8_t *data = NULL;
-    uint8_t *header = NULL;
+	uint8_t *p = NULL;
+	uint8_t *header = NULL;
 
-	while(0 == r && bytes > 0)
+	// TS Header
+	data[0] = 0x47;	// sync_byte
+	data[1] = 0x00 | ((stream->pid >>8) & 0x1F);
+	data[2] = stream->pid & 0xFF;
+	data[3] = 0x10 | (stream->cc & 0x0F); // no adaptation, payload only
+	data[4] = 0; // clear adaptation length
+	data[5] = 0; // clear adaptation flags
+
+	stream->cc = (stream->cc + 1) % 16;
+
+	// 2.7.2 Frequency of coding the program clock reference
+	// http://www.bretl.com/mpeghtml/SCR.HTM
+	// the maximum between PCRs is 100ms.  
+	if(start && stream->pid == pmt->PCR_PID)
 	{
-		data = tsctx->func.alloc(tsctx->param, TS_PACKET_SIZE);
-		if(!data) return ENOMEM;
+		data[3] |= 0x20; // +AF
+		data[5] |= AF_FLAG_PCR; // +PCR_flag
+	}
 
-		// TS Header
-		data[0] = 0x47;	// sync_byte
-		data[1] = 0x00 | ((stream->pid >>8) & 0x1F);
-		data[2] = stream->pid & 0xFF;
-		data[3] = 0x10 | (stream->cc & 0x0F); // no adaptation, payload only
-		data[4] = 0; // clear adaptation length
-		data[5] = 0; // clear adaptation flags
+	// random_access_indicator
+	if(start && stream->data_alignment_indicator && PTS_NO_VALUE != stream->pts)
+	{
+		//In the PCR_PID the random_access_indicator may only be set to '1' 
+		//in a transport stream packet containing the PCR fields.
+		data[3] |= 0x20; // +AF
+		data[5] |= AF_FLAG_RANDOM_ACCESS_INDICATOR; // +random_access_indicator
+	}
 
-		stream->cc = (stream->cc + 1) % 16;
+	if(data[3] & 0x20)
+	{
+		data[4] = 1; // 1-byte flag
 
-		// 2.7.2 Frequency of coding the program clock reference
-		// http://www.bretl.com/mpeghtml/SCR.HTM
-		// the maximum between PCRs is 100ms.  
-		if(start && stream->pid == pmt->PCR_PID)
+		if(data[5] & AF_FLAG_PCR) // PCR_flag
 		{
-			data[3] |= 0x20; // +AF
-			data[5] |= AF_FLAG_PCR; // +PCR_flag
+			int64_t pcr = 0;
+			pcr = (PTS_NO_VALUE==stream->dts) ? stream->pts : stream->dts;
+			pcr_write(data + 6, (pcr - PCR_DELAY) * 300); // TODO: delay???
+			data[4] += 6; // 6-PCR
 		}
 
-		// random_access_indicator
-		if(start && stream->data_alignment_indicator && PTS_NO_VALUE != stream->pts)
-		{
-			//In the PCR_PID the random_access_indicator may only be set to '1' 
-			//in a transport stream packet containing the PCR fields.
-			data[3] |= 0x20; // +AF
-			data[5] |= AF_FLAG_RANDOM_ACCESS_INDICATOR; // +random_access_indicator
-		}
+            header = data + TS_HEADER_LEN + 1 + data[4]; // 4-TS + 1-AF-Len + AF-Payload
+	}
+	else
+	{
+            header = data + TS_HEADER_LEN;
+	}
 
-		if(data[3] & 0x20)
-		{
-			data[4] = 1; // 1-byte flag
+	p = header;
+
+	// PES header
+	if(start)
+	{
+		data[1] |= TS_PAYLOAD_UNIT_START_INDICATOR; // payload_unit_start_indicator
 
-			if(data[5] & AF_FLAG_PCR) // PCR_flag
-			{
-				int64_t pcr = 0;
-				pcr = (PTS_NO_VALUE==stream->dts) ? stream->pts : stream->dts;
-				pcr_write(data + 6, (pcr - PCR_DELAY) * 300); // TODO: delay???
-				data[4] += 6; // 6-PCR
-			}
+            p += pes_write_header(stream, header, TS_PACKET_SIZE - (header - data));
 
-            header = data + TS_HEADER_LEN + 1 + data[4]; // 4-TS + 1-AF-Len + AF-Payload
+		if(PSI_STREAM_H264 == stream->codecid && !tsctx->h264_h265_with_aud)
+		{
+			// 2.14 Carriage of Rec. ITU-T H.264 | ISO/IEC 14496-10 video
+			// Each AVC access unit shall contain an access unit delimiter NAL Unit
+			nbo_w32(p, 0x00000001);
+			p[4] = 0x09; // AUD
+			p[5] = 0xF0; // any slice type (0xe) + rbsp stop one bit
+			p += 6;
 		}
-		else
+		else if (PSI_STREAM_H265 == stream->codecid && !tsctx->h264_h265_with_aud)
 		{
-            header = data + TS_HEADER_LEN;
+			// 2.17 Carriage of HEVC
+			// Each HEVC access unit shall contain an access unit delimiter NAL unit.
+			nbo_w32(p, 0x00000001);
+			p[4] = 0x46; // 35-AUD_NUT
+			p[5] = 0x01;
+			p[6] = 0x50; // B&P&I (0x2) + rbsp stop one bit
+			p += 7;
 		}
 
-		p = header;
-
-		// PES header
-		if(start)
-		{
-			data[1] |= TS_PAYLOAD_UNIT_START_INDICATOR; // payload_unit_start_indicator
+		// PES_packet_length = PES-Header + Payload-Size
+		// A value of 0 indicates that the PES packet length is neither specified nor bounded 
+		// and is allowed only in PES packets whose payload consists of bytes from a 
+		// video elementary stream contained in transport stream packets
+		if((p - header - PES_HEADER_LEN) + bytes > 0xFFFF)
+			nbo_w16(header + 4, 0); // 2.4.3.7 PES packet => PES_packet_length
+		else
+			nbo_w16(header + 4, (uint16_t)((p - header - PES_HEADER_LEN) + bytes));
+	}
 
-            p += pes_write_header(stream, header, TS_PACKET_SIZE - (header - data));
+	len = p - data; // TS + PES header length
+	if(len + bytes < TS_PACKET_SIZE)
+	{
+		// stuffing_len = TS_PACKET_SIZE - (len + bytes)
 
-			if(PSI_STREAM_H264 == stream->codecid && !tsctx->h264_h265_with_aud)
-			{
-				// 2.14 Carriage of Rec. ITU-T H.264 | ISO/IEC 14496-10 video
-				// Each AVC access unit shall contain an access unit delimiter NAL Unit
-				nbo_w32(p, 0x00000001);
-				p[4] = 0x09; // AUD
-				p[5] = 0xF0; // any slice type (0xe) + rbsp stop one bit
-				p += 6;
-			}
-			else if (PSI_STREAM_H265 == stream->codecid && !tsctx->h264_h265_with_aud)
-			{
-				// 2.17 Carriage of HEVC
-				// Each HEVC access unit shall contain an access unit delimiter NAL unit.
-				nbo_w32(p, 0x00000001);
-				p[4] = 0x46; // 35-AUD_NUT
-				p[5] = 0x01;
-				p[6] = 0x50; // B&P&I (0x2) + rbsp stop one bit
-				p += 7;
-			}
-
-			// PES_packet_length = PES-Header + Payload-Size
-			// A value of 0 indicates that the PES packet length is neither specified nor bounded 
-			// and is allowed only in PES packets whose payload consists of bytes from a 
-			// video elementary stream contained in transport stream packets
-			if((p - header - PES_HEADER_LEN) + bytes > 0xFFFF)
-				nbo_w16(header + 4, 0); // 2.4.3.7 PES packet => PES_packet_length
-			else
-				nbo_w16(header + 4, (uint16_t)((p - header - PES_HEADER_LEN) + bytes));
+		// move pes header
+		if(p - header > 0)
+		{
+			assert(start);
+			memmove(data + (TS_PACKET_SIZE - bytes - (p - header)), header, p - header);
 		}
 
-		len = p - data; // TS + PES header length
-		if(len + bytes < TS_PACKET_SIZE)
+		// adaptation
+		if(data[3] & 0x20) // has AF?
+		{
+			assert(0 != data[5] && data[4] > 0);
+			memset(data + TS_HEADER_LEN + 1 + data[4], 0xFF, TS_PACKET_SIZE - (len + bytes));
+			data[4] += (uint8_t)(TS_PACKET_SIZE - (len + bytes));
+		}
+		else
 		{
-			// stuffing_len = TS_PACKET_SIZE - (len + bytes)
-
-			// move pes header
-			if(p - header > 0)
-			{
-				assert(start);
-				memmove(data + (TS_PACKET_SIZE - bytes - (p - header)), header, p - header);
-			}
-
-			// adaptation
-			if(data[3] & 0x20) // has AF?
-			{
-				assert(0 != data[5] && data[4] > 0);
-				memset(data + TS_HEADER_LEN + 1 + data[4], 0xFF, TS_PACKET_SIZE - (len + bytes));
-				data[4] += (uint8_t)(TS_PACKET_SIZE - (len + bytes));
-			}
-			else
-			{
                 assert(len == (size_t)(p - header) + TS_HEADER_LEN);
                 data[3] |= 0x20; // +AF
                 data[4] = (uint8_t)(TS_PACKET_SIZE - (len + bytes) - 1/*AF length*/);
                 if (data[4] > 0) data[5] = 0; // no flag
                 if (data[4] > 1) memset(data + 6, 0xFF, TS_PACKET_SIZE - (len + bytes) - 2);
-			}
+		}
             len = bytes;
 
-			p = data + 5 + data[4] + (p - header);
-		}
-		else
+		p = data + 5 + data[4] + (p - header);
+	}
+	else
+	{
+		len = TS_PACKET_SIZE - len;
+	}
+
+	// payload
+	mpeg_avcc_read(payload, p, len);
+	return len;
+}
+
+static int ts_write_pes(mpeg_ts_enc_context_t *tsctx, const struct pmt_t* pmt, struct pes_t *stream, struct mpeg_avcc_reader_t* payload)
+{
+	int r = 0;
+	size_t n = 0;
+	size_t bytes = payload->total;
+	size_t len = 0;
+	int start = 1; // first packet
+	uint8_t *data = NULL;
+
+	if (tsctx->batch && bytes > 0)
+	{
+		// all TS packets of the PES in one buffer: the first packet may
+		// carry no payload(PES header), the others at least 184 bytes
+		n = TS_PACKET_SIZE * (1 + (bytes + TS_PACKET_SIZE - TS_HEADER_LEN - 1) / (TS_PACKET_SIZE - TS_HEADER_LEN));
+		data = tsctx->func.alloc(tsctx->param, n);
+		if (!data) return ENOMEM;
+
+		for (n = 0; bytes > 0; n += TS_PACKET_SIZE)
 		{
-			len = TS_PACKET_SIZE - len;
+			len = ts_write_pes_packet(tsctx, pmt, stream, data + n, start, payload, bytes);
+			bytes -= len;
+			start = 0;
 		}
 
-		// payload
-		memcpy(p, payload, len);
+		r = tsctx->func.write(tsctx->param, data, n);
+		tsctx->func.free(tsctx->param, data);
+		return r;
+	}
+
+	while(0 == r && bytes > 0)
+	{
+		data = tsctx->func.alloc(tsctx->param, TS_PACKET_SIZE);
+		if(!data) return ENOMEM;
 
-		payload += len;
+		len = ts_write_pes_packet(tsctx, pmt, stream, data, start, payload, bytes);
 		bytes -= len;
 		start = 0;
 
@@ -267,9 +381,9 @@ static struct pes_t *mpeg_ts_find(mpeg_ts_enc_context_t *ts, int pid, struct pmt
 int mpeg_ts_write(void* ts, int pid, int flags, int64_t pts, int64_t dts, const void* data, size_t bytes)
 {
 	int r = 0;
-	size_t i, n;
     struct pmt_t *pmt = NULL;
 	struct pes_t *stream = NULL;
+	struct mpeg_avcc_reader_t payload;
 	mpeg_ts_enc_context_t *tsctx;
 
 	tsctx = (mpeg_ts_enc_context_t*)ts;
@@ -277,6 +391,10 @@ int mpeg_ts_write(void* ts, int pid, int flags, int64_t pts, int64_t dts, const
     if (NULL == stream)
         return -ENOENT; // not found
 
+    r = mpeg_avcc_reader_init(&payload, stream->avcc, data, bytes);
+    if (0 != r)
+        return r;
+
     stream->pts = pts;
     stream->dts = dts;
     stream->data_alignment_indicator = (flags & MPEG_FLAG_IDR_FRAME) ? 1 : 0; // idr frame
@@ -288,6 +406,7 @@ int mpeg_ts_write(void* ts, int pid, int flags, int64_t pts, int64_t dts, const
     {
         pmt->PCR_PID = stream->pid;
         tsctx->pat_period = 0;
+        mpeg_ts_psi_invalidate(tsctx);
     }
 
 	if (pmt->PCR_PID == stream->pid)
@@ -297,21 +416,22 @@ int mpeg_ts_write(void* ts, int pid, int flags, int64_t pts, int64_t dts, const
 	{
 		tsctx->pat_period = dts;
 
-		// PAT(program_association_section)
-		n = pat_write(&tsctx->pat, tsctx->payload);
-		r = mpeg_ts_write_section_header(ts, PAT_TID_PAS, &tsctx->pat.cc, tsctx->payload, n); // PID = 0x00 program association table
+		// PAT + PMT
+		r = mpeg_ts_psi_write(tsctx);
 		if (0 != r) return r;
-
-		// PMT(Transport stream program map section)
-		for(i = 0; i < tsctx->pat.pmt_count; i++)
-		{
-			n = pmt_write(&tsctx->pat.pmts[i], tsctx->payload);
-			r = mpeg_ts_write_section_header(ts, tsctx->pat.pmts[i].pid, &tsctx->pat.pmts[i].cc, tsctx->payload, n);
-			if (0 != r) return r;
-		}
 	}
 
-	return ts_write_pes(tsctx, pmt, stream, data, bytes);
+	return ts_write_pes(tsctx, pmt, stream, &payload);
+}
+
+int mpeg_ts_set_avcc(void* ts, int pid, const void* record, size_t bytes)
+{
+	struct pmt_t *pmt = NULL;
+	struct pes_t *stream = NULL;
+	stream = mpeg_ts_find((mpeg_ts_enc_context_t*)ts, pid, &pmt);
+	if (NULL == stream)
+		return -ENOENT; // not found
+	return mpeg_avcc_set(&stream->avcc, stream->codecid, record, bytes);
 }
 
 void* mpeg_ts_create(const struct mpeg_ts_func_t *func, void* param)
@@ -367,6 +487,8 @@ int mpeg_ts_destroy(void* ts)
 
 	if (tsctx->pat.pmts && tsctx->pat.pmts != tsctx->pat.pmt_default)
 		free(tsctx->pat.pmts);
+	if (tsctx->psi)
+		free(tsctx->psi);
 	free(tsctx);
 	return 0;
 }
@@ -381,6 +503,14 @@ int mpeg_ts_reset(void* ts)
 	return 0;
 }
 
+int mpeg_ts_set_batch(void* ts, int batch)
+{
+	mpeg_ts_enc_context_t *tsctx;
+	tsctx = (mpeg_ts_enc_context_t*)ts;
+	tsctx->batch = batch ? 1 : 0;
+	return 0;
+}
+
 int mpeg_ts_add_program(void* ts, uint16_t pn, const void* info, int bytes)
 {
 	unsigned int i;
@@ -419,6 +549,7 @@ int mpeg_ts_add_program(void* ts, uint16_t pn, const void* info, int bytes)
 	}
 
 	tsctx->pat.pmt_count++;
+	mpeg_ts_psi_invalidate(tsctx);
 	mpeg_ts_reset(ts); // update PAT/PMT
 	return 0;
 }
@@ -441,6 +572,7 @@ int mpeg_ts_remove_program(void* ts, uint16_t pn)
 		if (i + 1 < tsctx->pat.pmt_count)
 			memmove(&tsctx->pat.pmts[i], &tsctx->pat.pmts[i + 1], (tsctx->pat.pmt_count - i - 1) * sizeof(tsctx->pat.pmts[0]));
 		tsctx->pat.pmt_count--;
+		mpeg_ts_psi_invalidate(tsctx);
 		mpeg_ts_reset(ts); // update PAT/PMT
 		return 0;
 	}
@@ -455,22 +587,27 @@ static void mpeg_ts_pmt_destroy(struct pmt_t* pmt)
 	{
 		if (pmt->streams[i].esinfo)
 			free(pmt->streams[i].esinfo);
+		if (pmt->streams[i].avcc)
+			free(pmt->streams[i].avcc);
 	}
 
 	if (pmt->pminfo)
 		free(pmt->pminfo);
+	pmt_free_streams(pmt);
 }
 
 static int mpeg_ts_pmt_add_stream(mpeg_ts_enc_context_t* ts, struct pmt_t* pmt, int codecid, const void* extra_data, size_t extra_data_size)
 {
 	struct pes_t* stream = NULL;
-	if (!ts || !pmt || pmt->stream_count >= sizeof(pmt->streams) / sizeof(pmt->streams[0]))
+	if (!ts || !pmt)
 	{
 		assert(0);
 		return -1;
 	}
 
-	stream = &pmt->streams[pmt->stream_count];
+	stream = pmt_alloc_stream(pmt);
+	if (!stream)
+		return -ENOMEM;
 	stream->codecid = (uint8_t)codecid;
 	stream->pid = (uint16_t)ts->pid++;
 	stream->esinfo_len = 0;
@@ -505,8 +642,21 @@ static int mpeg_ts_pmt_add_stream(mpeg_ts_enc_context_t* ts, struct pmt_t* pmt,
 		stream->esinfo_len = (uint16_t)extra_data_size;
 	}
 
+	// PMT is written as one TS packet(mpeg_ts_write_section_header)
 	pmt->stream_count++;
+	if (pmt_write(pmt, ts->payload) >= TS_PACKET_SIZE - 5)
+	{
+		pmt->stream_count--;
+		if (stream->esinfo)
+			free(stream->esinfo);
+		stream->esinfo = NULL;
+		stream->esinfo_len = 0;
+		ts->pid--;
+		return -E2BIG;
+	}
+
 	pmt->ver = (pmt->ver + 1) % 32;
+	mpeg_ts_psi_invalidate(ts);
 	mpeg_ts_reset(ts); // immediate update pat/pmt
 	return stream->pid;
 }
@@ -1,5 +1,6 @@
 #include "mpeg-types.h"
 #include "mpeg-util.h"
+#include "mpeg4-annexb.h"
 #include <assert.h>
 #include <string.h>
 
@@ -15,21 +16,14 @@
 /// @return -1-not found, other nalu position(after 00 00 01)
 int mpeg_h264_find_nalu(const uint8_t* p, size_t bytes, size_t* leading)
 {
-    size_t i, zeros;
-    for (zeros = i = 0; i + 1 < bytes; i++)
-    {
-        if (0x01 == p[i] && zeros >= 2)
-        {
-            assert(i >= zeros);
-            if (leading)
-                *leading = (zeros > 2 ? 3 : zeros) + 1; // zeros + 0x01
-            return (int)(i + 1);
-        }
+    const uint8_t* nalu;
+    nalu = mpeg4_annexb_nalu_find(p, p + bytes);
+    if (!nalu)
+        return -1;
 
-        zeros = 0x00 != p[i] ? 0 : (zeros + 1);
-    }
-
-    return -1;
+    if (leading)
+        *leading = (nalu - 3 > p && 0x00 == nalu[-4]) ? 4 : 3; // zeros + 0x01
+    return (int)(nalu - p);
 }
 
 /// @param[out] leading optional leading zero bytes
@@ -53,16 +47,13 @@ static int mpeg_h264_find_access_unit_delimiter(const uint8_t* p, size_t bytes,
 
 int mpeg_h264_find_keyframe(const uint8_t* p, size_t bytes)
 {
-	size_t i;
 	uint8_t type;
-	for (i = 2; i + 1 < bytes; i++)
+	const uint8_t* end;
+	for (end = p + bytes; NULL != (p = mpeg4_annexb_nalu_find(p, end)); )
 	{
-		if (0x01 == p[i] && 0x00 == p[i - 1] && 0x00 == p[i - 2])
-		{
-			type = p[i + 1] & 0x1f;
-			if (H264_NAL_IDR >= type && 1 <= type)
-				return H264_NAL_IDR == type ? 1 : 0;
-		}
+		type = p[0] & 0x1f;
+		if (H264_NAL_IDR >= type && 1 <= type)
+			return H264_NAL_IDR == type ? 1 : 0;
 	}
 
 	return 0;
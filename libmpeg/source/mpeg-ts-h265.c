@@ -1,5 +1,6 @@
 #include "mpeg-types.h"
 #include "mpeg-util.h"
+#include "mpeg4-annexb.h"
 #include <assert.h>
 #include <string.h>
 
@@ -9,18 +10,17 @@
 /// @return -1-not found, other-AUD position(include start code)
 static int mpeg_h265_find_access_unit_delimiter(const uint8_t* p, size_t bytes, size_t* leading)
 {
-    size_t i, zeros;
-    for (zeros = i = 0; i + 1 < bytes; i++)
+    size_t i;
+    const uint8_t* nalu, *end;
+    for (nalu = p, end = p + bytes; NULL != (nalu = mpeg4_annexb_nalu_find(nalu, end)); )
     {
-        if (0x01 == p[i] && zeros >= 2 && H265_NAL_AUD == ((p[i + 1] >> 1) & 0x3f))
+        if (H265_NAL_AUD == ((nalu[0] >> 1) & 0x3f))
         {
-            assert(i >= zeros);
+            i = (nalu - 3 > p && 0x00 == nalu[-4]) ? 4 : 3; // zeros + 0x01
             if (leading)
-                *leading = (zeros > 2 ? 3 : 2) + 1; // zeros - (zeros > 2 ? 3 : 2);
-            return (int)(i - (zeros > 2 ? 3 : 2));
+                *leading = i;
+            return (int)(nalu - p - i);
         }
-        
-        zeros = 0x00 != p[i] ? 0 : (zeros + 1);
     }
 
 	return -1;
@@ -32,16 +32,13 @@ static int mpeg_h265_find_access_unit_delimiter(const uint8_t* p, size_t bytes,
 //   in the range of BLA_W_LP to RSV_IRAP_VCL23, inclusive.
 static int mpeg_h265_find_keyframe(const uint8_t* p, size_t bytes)
 {
-	size_t i;
 	uint8_t type;
-	for (i = 2; i + 1 < bytes; i++)
+	const uint8_t* end;
+	for (end = p + bytes; NULL != (p = mpeg4_annexb_nalu_find(p, end)); )
 	{
-		if (0x01 == p[i] && 0x00 == p[i - 1] && 0x00 == p[i - 2])
-		{
-			type = (p[i + 1] >> 1) & 0x3f;
-			if (type < 32)
-				return (16 <= type && type <= 23) ? 1 : 0;
-		}
+		type = (p[0] >> 1) & 0x3f;
+		if (type < 32)
+			return (16 <= type && type <= 23) ? 1 : 0;
 	}
 
 	return 0;
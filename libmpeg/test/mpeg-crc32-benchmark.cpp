@@ -0,0 +1,76 @@
+#include "sys/system.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+extern "C" uint32_t mpeg_crc32(uint32_t crc, const uint8_t *buffer, uint32_t size);
+
+#define N_BYTES (64 * 1024 * 1024) // total bytes per size
+
+static uint32_t s_crc32table[256];
+
+// one byte at a time, as mpeg_crc32 before slice-by-8
+static uint32_t mpeg_crc32_byte(uint32_t crc, const uint8_t* buffer, uint32_t size)
+{
+	uint32_t i;
+	for (i = 0; i < size; i++)
+		crc = s_crc32table[(crc ^ buffer[i]) & 0xff] ^ (crc >> 8);
+	return crc;
+}
+
+static void mpeg_crc32_byte_init(void)
+{
+	uint32_t i, j, c;
+
+	// MSB-first 0x04C11DB7, stored byte-swapped
+	for (i = 0; i < 256; i++)
+	{
+		c = i << 24;
+		for (j = 0; j < 8; j++)
+			c = (c & 0x80000000) ? ((c << 1) ^ 0x04C11DB7) : (c << 1);
+		s_crc32table[i] = ((c >> 24) & 0xff) | ((c >> 8) & 0xff00) | ((c << 8) & 0xff0000) | (c << 24);
+	}
+}
+
+static double mpeg_crc32_speed(uint32_t(*crc32)(uint32_t, const uint8_t*, uint32_t), const uint8_t* data, uint32_t size, uint32_t* result)
+{
+	int i, n;
+	uint32_t crc;
+	uint64_t clock;
+
+	crc = 0;
+	n = N_BYTES / size;
+	clock = system_clock();
+	for (i = 0; i < n; i++)
+		crc ^= crc32(0xffffffff, data + (i & 7), size);
+	clock = system_clock() - clock;
+
+	*result = crc;
+	return clock ? (double)size * n / 1024 / 1024 * 1000 / clock : 0.0;
+}
+
+void mpeg_crc32_benchmark_test(void)
+{
+	// PAT, PMT, SDT, max PSI section, large buffer
+	static const uint32_t s_sizes[] = { 12, 23, 64, 188, 1021, 4093, 65536 };
+	uint32_t i, r1, r2;
+	double v1, v2;
+	uint8_t* data;
+
+	mpeg_crc32_byte_init();
+	data = (uint8_t*)malloc(65536 + 8);
+	for (i = 0; i < 65536 + 8; i++)
+		data[i] = (uint8_t)rand();
+
+	for (i = 0; i < sizeof(s_sizes) / sizeof(s_sizes[0]); i++)
+	{
+		v1 = mpeg_crc32_speed(mpeg_crc32_byte, data, s_sizes[i], &r1);
+		v2 = mpeg_crc32_speed(mpeg_crc32, data, s_sizes[i], &r2);
+		assert(r1 == r2);
+		printf("mpeg_crc32 %5u bytes: byte %7.1f MB/s, slice-by-8 %7.1f MB/s (x%.2f)\n", (unsigned int)s_sizes[i], v1, v2, v1 > 0 ? v2 / v1 : 0.0);
+	}
+
+	free(data);
+}
@@ -0,0 +1,198 @@
+#include "mpeg-ts.h"
+#include "mpeg-ps.h"
+#include "mpeg-ts-proto.h"
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define N 100 // video frame count
+
+static uint8_t s_frame[2 * 1024 * 1024];
+
+static void* mpeg_alloc(void* /*param*/, size_t bytes)
+{
+	static char s_buffer[2 * 1024 * 1024];
+	assert(bytes <= sizeof(s_buffer));
+	return s_buffer;
+}
+
+static void mpeg_free(void* /*param*/, void* /*packet*/)
+{
+	return;
+}
+
+static int ts_write(void* param, const void* packet, size_t bytes)
+{
+	std::vector<uint8_t>* v = (std::vector<uint8_t>*)param;
+	v->insert(v->end(), (const uint8_t*)packet, (const uint8_t*)packet + bytes);
+	return 0;
+}
+
+static int ps_write(void* param, int /*stream*/, void* packet, size_t bytes)
+{
+	return ts_write(param, packet, bytes);
+}
+
+static void mpeg_fragment_packet(std::vector<std::string>* packets, int stream, int codecid, int flags, int64_t pts, int64_t dts, const void* data, size_t bytes)
+{
+	char header[128];
+	snprintf(header, sizeof(header), "%d %d %d %lld %lld %u:", stream, codecid, flags, (long long)pts, (long long)dts, (unsigned int)bytes);
+	packets->push_back(std::string(header) + std::string((const char*)data, bytes));
+}
+
+static int ts_onpacket(void* param, int /*program*/, int stream, int codecid, int flags, int64_t pts, int64_t dts, const void* data, size_t bytes)
+{
+	mpeg_fragment_packet((std::vector<std::string>*)param, stream, codecid, flags, pts, dts, data, bytes);
+	return 0;
+}
+
+static int ps_onpacket(void* param, int stream, int codecid, int flags, int64_t pts, int64_t dts, const void* data, size_t bytes)
+{
+	return ts_onpacket(param, 0, stream, codecid, flags, pts, dts, data, bytes);
+}
+
+static int ts_onfragment(void* param, int program, int stream, int codecid, int flags, int64_t pts, int64_t dts, const struct mpeg_fragment_t* fragments, int count)
+{
+	size_t n;
+
+	n = mpeg_fragment_copy(fragments, count, s_frame, sizeof(s_frame));
+	assert(n > 0 && 0 == mpeg_fragment_copy(fragments, count, s_frame, n - 1));
+
+	// fragment mode keep AUD(muxer: 00 00 00 01 09 xx)
+	if (PSI_STREAM_H264 == codecid && n >= 6 && 0 == memcmp(s_frame, "\x00\x00\x00\x01", 4) && 9 == (s_frame[4] & 0x1f))
+		return ts_onpacket(param, program, stream, codecid, flags, pts, dts, s_frame + 6, n - 6);
+	return ts_onpacket(param, program, stream, codecid, flags, pts, dts, s_frame, n);
+}
+
+static int ps_onfragment(void* param, int stream, int codecid, int flags, int64_t pts, int64_t dts, const struct mpeg_fragment_t* fragments, int count)
+{
+	return ts_onfragment(param, 0, stream, codecid, flags, pts, dts, fragments, count);
+}
+
+static void mpeg_fragment_mux(std::vector<uint8_t>& ts, std::vector<uint8_t>& ps)
+{
+	int i, j, n, r[2], audio[2], video[2];
+	uint8_t adts[512];
+	std::vector<uint8_t> au;
+
+	struct mpeg_ts_func_t tshandler;
+	tshandler.alloc = mpeg_alloc;
+	tshandler.write = ts_write;
+	tshandler.free = mpeg_free;
+	void* tsmuxer = mpeg_ts_create(&tshandler, &ts);
+	video[0] = mpeg_ts_add_stream(tsmuxer, PSI_STREAM_H264, NULL, 0);
+	audio[0] = mpeg_ts_add_stream(tsmuxer, PSI_STREAM_AAC, NULL, 0);
+
+	struct ps_muxer_func_t pshandler;
+	pshandler.alloc = mpeg_alloc;
+	pshandler.write = ps_write;
+	pshandler.free = mpeg_free;
+	struct ps_muxer_t* psmuxer = ps_muxer_create(&pshandler, &ps);
+	video[1] = ps_muxer_add_stream(psmuxer, PSI_STREAM_H264, NULL, 0);
+	audio[1] = ps_muxer_add_stream(psmuxer, PSI_STREAM_AAC, NULL, 0);
+	assert(video[0] > 0 && audio[0] > 0 && video[1] > 0 && audio[1] > 0);
+
+	srand(1);
+	for (i = 0; i < N; i++)
+	{
+		// Annex B slice, payload without zero byte(no start code emulation)
+		au.assign(4, 0);
+		au[3] = 0x01;
+		au.push_back(0 == i % 25 ? 0x65 : 0x41);
+		n = 16 + rand() % (0 == i % 25 ? 100000 : 5000);
+		for (j = 0; j < n; j++)
+			au.push_back((uint8_t)(rand() | 0x01));
+		r[0] = mpeg_ts_write(tsmuxer, video[0], 0 == i % 25 ? 0x0001 : 0, i * 3600, i * 3600, au.data(), au.size());
+		r[1] = ps_muxer_input(psmuxer, video[1], 0 == i % 25 ? 0x0001 : 0, i * 3600, i * 3600, au.data(), au.size());
+		assert(0 == r[0] && 0 == r[1]);
+
+		// AAC-LC 44.1kHz stereo ADTS frame
+		n = 7 + rand() % (sizeof(adts) - 7);
+		adts[0] = 0xFF;
+		adts[1] = 0xF1;
+		adts[2] = 0x50;
+		adts[3] = (uint8_t)(0x80 | ((n >> 11) & 0x03));
+		adts[4] = (uint8_t)(n >> 3);
+		adts[5] = (uint8_t)(((n & 0x07) << 5) | 0x1F);
+		adts[6] = 0xFC;
+		for (j = 7; j < n; j++)
+			adts[j] = (uint8_t)rand();
+		r[0] = mpeg_ts_write(tsmuxer, audio[0], 0, i * 3600 + 1800, i * 3600 + 1800, adts, n);
+		r[1] = ps_muxer_input(psmuxer, audio[1], 0, i * 3600 + 1800, i * 3600 + 1800, adts, n);
+		assert(0 == r[0] && 0 == r[1]);
+	}
+	mpeg_ts_destroy(tsmuxer);
+	ps_muxer_destroy(psmuxer);
+}
+
+/// @param[in] chunk 0-random split, >0-fixed input size
+static void mpeg_fragment_ts_demux(const std::vector<uint8_t>& ts, int fragment, size_t chunk, std::vector<std::string>& packets)
+{
+	int r;
+	size_t i, n;
+	struct ts_demuxer_t* demuxer = ts_demuxer_create(ts_onpacket, &packets);
+	if (fragment)
+		ts_demuxer_set_onfragment(demuxer, ts_onfragment, &packets);
+	for (i = 0; i < ts.size(); i += n)
+	{
+		n = chunk ? chunk : (size_t)(1 + rand() % 100000);
+		n = n < ts.size() - i ? n : ts.size() - i;
+		r = ts_demuxer_input(demuxer, &ts[i], n);
+		assert(0 == r);
+	}
+	ts_demuxer_flush(demuxer);
+	ts_demuxer_destroy(demuxer);
+}
+
+static void mpeg_fragment_ps_demux(const std::vector<uint8_t>& ps, int fragment, size_t chunk, std::vector<std::string>& packets)
+{
+	int r;
+	size_t i, n;
+	std::vector<uint8_t> buffer;
+	struct ps_demuxer_t* demuxer = ps_demuxer_create(ps_onpacket, &packets);
+	if (fragment)
+		ps_demuxer_set_onfragment(demuxer, ps_onfragment, &packets);
+	for (i = 0; i < ps.size(); i += n)
+	{
+		n = chunk ? chunk : (size_t)(1 + rand() % 100000);
+		n = n < ps.size() - i ? n : ps.size() - i;
+		buffer.insert(buffer.end(), ps.begin() + i, ps.begin() + i + n);
+		r = ps_demuxer_input(demuxer, buffer.data(), buffer.size());
+		assert(r >= 0);
+		buffer.erase(buffer.begin(), buffer.begin() + r);
+	}
+	ps_demuxer_destroy(demuxer);
+}
+
+// zero-copy fragment mode: linearized fragments same as copy mode(except AUD)
+void mpeg_fragment_test(void)
+{
+	int i;
+	std::vector<uint8_t> ts, ps;
+	std::vector<std::string> baseline, packets;
+	static const size_t s_chunks[] = { 188, 7 * 188, 0, 1024 * 1024, 64 * 1024 * 1024 };
+
+	mpeg_fragment_mux(ts, ps);
+
+	mpeg_fragment_ts_demux(ts, 0, 188, baseline);
+	assert(2 * N == (int)baseline.size());
+	for (i = 0; i < (int)(sizeof(s_chunks) / sizeof(s_chunks[0])); i++)
+	{
+		packets.clear();
+		mpeg_fragment_ts_demux(ts, 1, s_chunks[i], packets);
+		assert(baseline == packets);
+	}
+
+	baseline.clear();
+	mpeg_fragment_ps_demux(ps, 0, 4096, baseline);
+	assert(2 * N - 1 <= (int)baseline.size()); // last frame: no ps_demuxer_flush
+	for (i = 2; i < (int)(sizeof(s_chunks) / sizeof(s_chunks[0])); i++)
+	{
+		packets.clear();
+		mpeg_fragment_ps_demux(ps, 1, s_chunks[i], packets);
+		assert(baseline == packets);
+	}
+}
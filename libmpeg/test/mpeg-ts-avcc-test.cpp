@@ -0,0 +1,266 @@
+#include "mpeg-ps.h"
+#include "mpeg-ts.h"
+#include "mpeg-ts-proto.h"
+#include "mpeg4-avc.h"
+#include "mpeg4-hevc.h"
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+
+#define N 60 // frame count
+#define GOP 25
+
+static uint8_t s_packet[2 * 1024 * 1024];
+static uint8_t s_annexb[1024 * 1024];
+
+// mpeg4-avc.c mpeg4_avc_test
+static uint8_t s_avc_record[] = {
+	0x01,0x42,0xe0,0x1e,0xff,0xe1,0x00,0x21,0x67,0x42,0xe0,0x1e,0xab,0x40,0xf0,0x28,
+	0xd0,0x80,0x00,0x00,0x00,0x80,0x00,0x00,0x19,0x70,0x20,0x00,0x78,0x00,0x00,0x0f,
+	0x00,0x16,0xb1,0xb0,0x3c,0x50,0xaa,0x80,0x80,0x01,0x00,0x04,0x28,0xce,0x3c,0x80
+};
+
+// mpeg4-hevc.c mpeg4_hevc_test
+static uint8_t s_hevc_record[] = {
+	0x01,0x01,0x60,0x00,0x00,0x00,0x80,0x00,0x00,0x00,0x00,0x00,0xb4,0xf0,0x00,
+	0xfc,0xfd,0xf8,0xf8,0x00,0x00,0x0f,0x03,0xa0,0x00,0x01,0x00,0x18,0x40,0x01,
+	0x0c,0x01,0xff,0xff,0x01,0x60,0x00,0x00,0x03,0x00,0x80,0x00,0x00,0x03,0x00,
+	0x00,0x03,0x00,0xb4,0x9d,0xc0,0x90,0xa1,0x00,0x01,0x00,0x29,0x42,0x01,0x01,
+	0x01,0x60,0x00,0x00,0x03,0x00,0x80,0x00,0x00,0x03,0x00,0x00,0x03,0x00,0xb4,
+	0xa0,0x01,0xe0,0x20,0x02,0x1c,0x59,0x67,0x79,0x24,0x6d,0xae,0x01,0x00,0x00,
+	0x03,0x03,0xe8,0x00,0x00,0x5d,0xc0,0x08,0xa2,0x00,0x01,0x00,0x06,0x44,0x01,
+	0xc1,0x73,0xd1,0x89
+};
+
+struct mpeg_ts_avcc_test_t
+{
+	int h265;
+	int ps; // 1-ps_muxer, 0-mpeg_ts
+	int length; // NALU length size
+	struct mpeg4_avc_t avc;
+	struct mpeg4_hevc_t hevc;
+
+	void* ts[2]; // 0-h264_mp4toannexb + Annex B input, 1-length-prefixed input
+	struct ps_muxer_t* muxer[2];
+	int stream[2];
+	std::vector<uint8_t> out[2];
+};
+
+static void* ts_alloc(void* /*param*/, size_t bytes)
+{
+	assert(bytes <= sizeof(s_packet));
+	return s_packet;
+}
+
+static void ts_free(void* /*param*/, void* /*packet*/)
+{
+	return;
+}
+
+static int ts_write(void* param, const void* packet, size_t bytes)
+{
+	std::vector<uint8_t>* out = (std::vector<uint8_t>*)param;
+	out->insert(out->end(), (const uint8_t*)packet, (const uint8_t*)packet + bytes);
+	return 0;
+}
+
+static int ps_write(void* param, int /*stream*/, void* packet, size_t bytes)
+{
+	return ts_write(param, packet, bytes);
+}
+
+/// FLV/MP4 sample NALU: length + NALU header + slice data(no zero byte)
+static void mpeg_ts_avcc_nalu(struct mpeg_ts_avcc_test_t* ctx, std::vector<uint8_t>& sample, int type, int bytes)
+{
+	int i;
+	for (i = ctx->length - 1; i >= 0; i--)
+		sample.push_back((uint8_t)(bytes >> (8 * i)));
+
+	if (ctx->h265)
+	{
+		sample.push_back((uint8_t)(type << 1));
+		sample.push_back(0x01);
+		bytes -= 2;
+	}
+	else
+	{
+		sample.push_back((uint8_t)((5 == type ? 0x60 : 0x40) | type));
+		bytes -= 1;
+	}
+
+	for (i = 0; i < bytes; i++)
+		sample.push_back((uint8_t)(rand() | 0x01));
+}
+
+/// in-band parameter sets: copy from record
+static void mpeg_ts_avcc_ps(struct mpeg_ts_avcc_test_t* ctx, std::vector<uint8_t>& sample, const uint8_t* nalu, int bytes)
+{
+	int i;
+	for (i = ctx->length - 1; i >= 0; i--)
+		sample.push_back((uint8_t)(bytes >> (8 * i)));
+	sample.insert(sample.end(), nalu, nalu + bytes);
+}
+
+/// IDR: SEI(H.264) + slices, parameter sets in-band every other GOP
+/// @return MPEG_FLAG_XXX
+static int mpeg_ts_avcc_sample(struct mpeg_ts_avcc_test_t* ctx, int i, std::vector<uint8_t>& sample)
+{
+	int j, slices, maxsize;
+	sample.clear();
+
+	maxsize = ctx->length > 2 ? 100000 : (1 << (8 * ctx->length)) - 4; // multi PES packets per frame
+	slices = 1 + rand() % 3;
+	if (0 == i % GOP)
+	{
+		if (0 == (i / GOP) % 2)
+		{
+			if (ctx->h265)
+				mpeg_ts_avcc_ps(ctx, sample, ctx->hevc.nalu[0].data, ctx->hevc.nalu[0].bytes);
+			mpeg_ts_avcc_ps(ctx, sample, ctx->h265 ? ctx->hevc.nalu[1].data : ctx->avc.sps[0].data, ctx->h265 ? ctx->hevc.nalu[1].bytes : ctx->avc.sps[0].bytes);
+			mpeg_ts_avcc_ps(ctx, sample, ctx->h265 ? ctx->hevc.nalu[2].data : ctx->avc.pps[0].data, ctx->h265 ? ctx->hevc.nalu[2].bytes : ctx->avc.pps[0].bytes);
+		}
+
+		// h265_mp4toannexb inserts VPS/SPS/PPS before the IRAP slice(after SEI), mpeg-ts at the access unit beginning
+		if (!ctx->h265)
+			mpeg_ts_avcc_nalu(ctx, sample, 6, 20); // SEI
+		for (j = 0; j < slices; j++)
+			mpeg_ts_avcc_nalu(ctx, sample, ctx->h265 ? 19 : 5, 3 + rand() % maxsize);
+		return MPEG_FLAG_IDR_FRAME;
+	}
+
+	for (j = 0; j < slices; j++)
+		mpeg_ts_avcc_nalu(ctx, sample, 1, 3 + rand() % (maxsize / 4));
+	return 0;
+}
+
+static int mpeg_ts_avcc_input(struct mpeg_ts_avcc_test_t* ctx, int i, int flags, int64_t pts, const void* data, size_t bytes)
+{
+	if (ctx->ps)
+		return ps_muxer_input(ctx->muxer[i], ctx->stream[i], flags, pts, pts, data, bytes);
+	return mpeg_ts_write(ctx->ts[i], ctx->stream[i], flags, pts, pts, data, bytes);
+}
+
+static void mpeg_ts_avcc_mux(struct mpeg_ts_avcc_test_t* ctx, int batch)
+{
+	int i, r, n, flags;
+	uint8_t* record;
+	size_t bytes;
+	std::vector<uint8_t> sample;
+	struct mpeg_ts_func_t tshandler;
+	struct ps_muxer_func_t pshandler;
+	int codecid = ctx->h265 ? PSI_STREAM_H265 : PSI_STREAM_H264;
+
+	// lengthSizeMinusOne
+	record = ctx->h265 ? s_hevc_record : s_avc_record;
+	bytes = ctx->h265 ? sizeof(s_hevc_record) : sizeof(s_avc_record);
+	if (ctx->h265)
+		s_hevc_record[21] = (uint8_t)((s_hevc_record[21] & 0xFC) | (ctx->length - 1));
+	else
+		s_avc_record[4] = (uint8_t)((s_avc_record[4] & 0xFC) | (ctx->length - 1));
+	r = ctx->h265 ? mpeg4_hevc_decoder_configuration_record_load(record, bytes, &ctx->hevc) : mpeg4_avc_decoder_configuration_record_load(record, bytes, &ctx->avc);
+	assert(r == (int)bytes);
+
+	tshandler.alloc = ts_alloc;
+	tshandler.write = ts_write;
+	tshandler.free = ts_free;
+	pshandler.alloc = ts_alloc;
+	pshandler.write = ps_write;
+	pshandler.free = ts_free;
+	for (i = 0; i < 2; i++)
+	{
+		ctx->out[i].clear();
+		if (ctx->ps)
+		{
+			ctx->muxer[i] = ps_muxer_create(&pshandler, &ctx->out[i]);
+			ctx->stream[i] = ps_muxer_add_stream(ctx->muxer[i], codecid, NULL, 0);
+		}
+		else
+		{
+			ctx->ts[i] = mpeg_ts_create(&tshandler, &ctx->out[i]);
+			mpeg_ts_set_batch(ctx->ts[i], batch);
+			ctx->stream[i] = mpeg_ts_add_stream(ctx->ts[i], codecid, NULL, 0);
+		}
+	}
+
+	r = ctx->ps ? ps_muxer_set_avcc(ctx->muxer[1], ctx->stream[1], record, bytes) : mpeg_ts_set_avcc(ctx->ts[1], ctx->stream[1], record, bytes);
+	assert(0 == r);
+
+	srand(1);
+	for (i = 0; i < N; i++)
+	{
+		flags = mpeg_ts_avcc_sample(ctx, i, sample);
+
+		// baseline: FLV/MP4 sample to Annex B before muxing
+		n = ctx->h265 ? h265_mp4toannexb(&ctx->hevc, &sample[0], (int)sample.size(), s_annexb, sizeof(s_annexb)) : h264_mp4toannexb(&ctx->avc, &sample[0], (int)sample.size(), s_annexb, sizeof(s_annexb));
+		assert(n > 0);
+		r = mpeg_ts_avcc_input(ctx, 0, flags, i * 3600, s_annexb, n);
+		assert(0 == r);
+
+		r = mpeg_ts_avcc_input(ctx, 1, flags, i * 3600, &sample[0], sample.size());
+		assert(0 == r);
+	}
+	assert(ctx->out[0].size() > 0 && ctx->out[0] == ctx->out[1]);
+
+	// last NALU truncated, NALU length over sample
+	assert(-EINVAL == mpeg_ts_avcc_input(ctx, 1, 0, i * 3600, &sample[0], sample.size() - 1));
+	sample[0] = 0xFF;
+	assert(-EINVAL == mpeg_ts_avcc_input(ctx, 1, 0, i * 3600, &sample[0], ctx->length + 1));
+
+	for (i = 0; i < 2; i++)
+	{
+		if (ctx->ps)
+			ps_muxer_destroy(ctx->muxer[i]);
+		else
+			mpeg_ts_destroy(ctx->ts[i]);
+	}
+}
+
+static void mpeg_ts_avcc_record_test(void)
+{
+	int stream;
+	void* ts;
+	std::vector<uint8_t> out;
+	struct mpeg_ts_func_t tshandler;
+
+	tshandler.alloc = ts_alloc;
+	tshandler.write = ts_write;
+	tshandler.free = ts_free;
+	ts = mpeg_ts_create(&tshandler, &out);
+
+	stream = mpeg_ts_add_stream(ts, PSI_STREAM_H264, NULL, 0);
+	assert(-EINVAL == mpeg_ts_set_avcc(ts, stream, s_avc_record, 5));
+	assert(-EINVAL == mpeg_ts_set_avcc(ts, stream, s_avc_record, sizeof(s_avc_record) - 1)); // PPS truncated
+	assert(0 == mpeg_ts_set_avcc(ts, stream, s_avc_record, sizeof(s_avc_record)));
+	assert(0 == mpeg_ts_set_avcc(ts, stream, NULL, 0)); // Annex B input
+
+	stream = mpeg_ts_add_stream(ts, PSI_STREAM_H265, NULL, 0);
+	assert(-EINVAL == mpeg_ts_set_avcc(ts, stream, s_hevc_record, 22));
+	assert(0 == mpeg_ts_set_avcc(ts, stream, s_hevc_record, sizeof(s_hevc_record)));
+
+	stream = mpeg_ts_add_stream(ts, PSI_STREAM_AAC, NULL, 0);
+	assert(0 != mpeg_ts_set_avcc(ts, stream, s_avc_record, sizeof(s_avc_record)));
+	mpeg_ts_destroy(ts);
+}
+
+void mpeg_ts_avcc_test(void)
+{
+	int batch;
+	struct mpeg_ts_avcc_test_t ctx;
+
+	for (ctx.h265 = 0; ctx.h265 < 2; ctx.h265++)
+	{
+		for (ctx.length = 1; ctx.length <= 4; ctx.length *= 2)
+		{
+			for (ctx.ps = 0; ctx.ps < 2; ctx.ps++)
+			{
+				for (batch = 0; batch < 2 - ctx.ps; batch++)
+					mpeg_ts_avcc_mux(&ctx, batch);
+			}
+		}
+	}
+
+	mpeg_ts_avcc_record_test();
+}
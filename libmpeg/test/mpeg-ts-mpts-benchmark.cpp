@@ -0,0 +1,207 @@
+#include "mpeg-ts.h"
+#include "mpeg-ts-proto.h"
+#include "sys/system.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#define N_PROGRAM	32
+#define N_AUDIO		6 // audio streams per program, e.g. multi-language
+#define N_SECONDS	5
+#define BITRATE		(80 * 1000 * 1000) // mux bitrate(bps)
+#define VIDEO_FPS	25
+#define AUDIO_FPS	47 // AAC 1024 samples @ 48kHz
+#define AUDIO_BYTES	384 // 144kbps per audio stream
+#define N_LOOP		10
+
+struct mpeg_ts_mpts_benchmark_t
+{
+	uint8_t* ptr;
+	size_t size;
+	size_t capacity;
+
+	uint8_t packet[188];
+	int program;
+	int64_t frames;
+	int64_t bytes;
+	int64_t errors;
+};
+
+static void* ts_alloc(void* param, size_t bytes)
+{
+	struct mpeg_ts_mpts_benchmark_t* ctx = (struct mpeg_ts_mpts_benchmark_t*)param;
+	assert(bytes <= sizeof(ctx->packet));
+	return ctx->packet;
+}
+
+static void ts_free(void* /*param*/, void* /*packet*/)
+{
+}
+
+static int ts_write(void* param, const void* packet, size_t bytes)
+{
+	struct mpeg_ts_mpts_benchmark_t* ctx = (struct mpeg_ts_mpts_benchmark_t*)param;
+	if (ctx->size + bytes > ctx->capacity)
+	{
+		ctx->capacity = ctx->capacity * 2 + bytes;
+		ctx->ptr = (uint8_t*)realloc(ctx->ptr, ctx->capacity);
+		assert(ctx->ptr);
+	}
+	memcpy(ctx->ptr + ctx->size, packet, bytes);
+	ctx->size += bytes;
+	return 0;
+}
+
+static int ts_onpacket(void* param, int /*program*/, int /*stream*/, int /*codecid*/, int flags, int64_t /*pts*/, int64_t /*dts*/, const void* /*data*/, size_t bytes)
+{
+	struct mpeg_ts_mpts_benchmark_t* ctx = (struct mpeg_ts_mpts_benchmark_t*)param;
+	ctx->frames++;
+	ctx->bytes += bytes;
+	ctx->errors += (flags & (MPEG_FLAG_PACKET_LOST | MPEG_FLAG_PACKET_CORRUPT)) ? 1 : 0;
+	return 0;
+}
+
+static int ts_onfragment(void* param, int program, int stream, int codecid, int flags, int64_t pts, int64_t dts, const struct mpeg_fragment_t* fragments, int count)
+{
+	int i;
+	size_t bytes;
+	for (bytes = i = 0; i < count; i++)
+		bytes += fragments[i].bytes;
+	return ts_onpacket(param, program, stream, codecid, flags, pts, dts, fragments[0].ptr, bytes);
+}
+
+static int ts_onfilter(void* param, int program, int /*stream*/, int /*codecid*/)
+{
+	struct mpeg_ts_mpts_benchmark_t* ctx = (struct mpeg_ts_mpts_benchmark_t*)param;
+	return program == ctx->program ? 1 : 0;
+}
+
+// H.264 slice NALU with random payload(no start code emulation)
+static void mpeg_ts_mpts_frame(uint8_t* data, size_t bytes, int idr)
+{
+	size_t i;
+	data[0] = 0x00;
+	data[1] = 0x00;
+	data[2] = 0x00;
+	data[3] = 0x01;
+	data[4] = idr ? 0x65 : 0x41;
+	data[5] = 0x88; // first_mb_in_slice = 0
+	for (i = 6; i < bytes; i++)
+		data[i] = (uint8_t)(0x80 | rand());
+}
+
+static void mpeg_ts_mpts_mux(struct mpeg_ts_mpts_benchmark_t* ctx)
+{
+	int i, j, k, n, r;
+	int stream[N_PROGRAM][1 + N_AUDIO];
+	size_t vbytes;
+	int64_t pts;
+	uint8_t* frame;
+	void* ts;
+	struct mpeg_ts_func_t h;
+
+	h.alloc = ts_alloc;
+	h.free = ts_free;
+	h.write = ts_write;
+	ts = mpeg_ts_create(&h, ctx);
+	for (i = 0; i < N_PROGRAM; i++)
+	{
+		r = mpeg_ts_add_program(ts, (uint16_t)(i + 1), NULL, 0);
+		assert(0 == r);
+		stream[i][0] = mpeg_ts_add_program_stream(ts, (uint16_t)(i + 1), PSI_STREAM_H264, NULL, 0);
+		for (j = 1; j <= N_AUDIO; j++)
+			stream[i][j] = mpeg_ts_add_program_stream(ts, (uint16_t)(i + 1), PSI_STREAM_AAC, NULL, 0);
+	}
+
+	// video takes the bitrate left by audio, 184-bytes payload per TS packet(PES header 14-bytes)
+	vbytes = (BITRATE / 8 / N_PROGRAM - N_AUDIO * AUDIO_FPS * (AUDIO_BYTES + 14 + 183) / 184 * 188) / VIDEO_FPS * 184 / 188;
+	frame = (uint8_t*)malloc(vbytes * 2);
+
+	for (n = k = 0; n < N_SECONDS * VIDEO_FPS; n++)
+	{
+		pts = (int64_t)n * 90000 / VIDEO_FPS;
+		for (i = 0; i < N_PROGRAM; i++)
+		{
+			// GOP 2s, IDR frame 2x size
+			mpeg_ts_mpts_frame(frame, 0 == n % 50 ? vbytes * 2 : vbytes * 49 / 50, 0 == n % 50);
+			r = mpeg_ts_write(ts, stream[i][0], 0 == n % 50 ? MPEG_FLAG_IDR_FRAME : 0, pts, pts, frame, 0 == n % 50 ? vbytes * 2 : vbytes * 49 / 50);
+			assert(0 == r);
+		}
+
+		for (; (int64_t)k * 90000 / AUDIO_FPS <= pts; k++)
+		{
+			for (i = 0; i < N_PROGRAM; i++)
+			{
+				for (j = 1; j <= N_AUDIO; j++)
+				{
+					r = mpeg_ts_write(ts, stream[i][j], 0, (int64_t)k * 90000 / AUDIO_FPS, (int64_t)k * 90000 / AUDIO_FPS, frame + 6, AUDIO_BYTES);
+					assert(0 == r);
+				}
+			}
+		}
+	}
+
+	free(frame);
+	mpeg_ts_destroy(ts);
+}
+
+/// @param[in] program 0-all programs
+/// @param[in] chunk input size, e.g. 7 x 188 UDP datagram, file read size
+/// @param[in] fragment 1-zero-copy mode(ts_demuxer_set_onfragment)
+static double mpeg_ts_mpts_demux(struct mpeg_ts_mpts_benchmark_t* ctx, int program, size_t chunk, int fragment)
+{
+	int r, k;
+	size_t i, n;
+	uint64_t clock;
+	struct ts_demuxer_t* ts;
+
+	ctx->program = program;
+	clock = system_clock();
+	for (k = 0; k < N_LOOP; k++)
+	{
+		ctx->frames = ctx->bytes = ctx->errors = 0;
+		ts = ts_demuxer_create(ts_onpacket, ctx);
+		if (program > 0)
+			ts_demuxer_set_filter(ts, ts_onfilter, ctx);
+		if (fragment)
+			ts_demuxer_set_onfragment(ts, ts_onfragment, ctx);
+		for (i = 0; i < ctx->size; i += n)
+		{
+			n = ctx->size - i > chunk ? chunk : ctx->size - i;
+			r = ts_demuxer_input(ts, ctx->ptr + i, n);
+			assert(0 == r);
+		}
+		ts_demuxer_flush(ts);
+		ts_demuxer_destroy(ts);
+	}
+	clock = system_clock() - clock;
+	return clock > 0 ? (double)ctx->size * 8 * N_LOOP / 1000 / clock : 0.0; // Mbps
+}
+
+void mpeg_ts_mpts_benchmark_test(void)
+{
+	double mbps;
+	struct mpeg_ts_mpts_benchmark_t ctx;
+
+	memset(&ctx, 0, sizeof(ctx));
+	mpeg_ts_mpts_mux(&ctx);
+	printf("MPTS: %d programs x %d streams, %d seconds, %.1f Mbps\n", N_PROGRAM, 1 + N_AUDIO, N_SECONDS, (double)ctx.size * 8 / N_SECONDS / 1000000);
+
+	mbps = mpeg_ts_mpts_demux(&ctx, 0, 7 * 188, 0);
+	assert(0 == ctx.errors);
+	printf("ts_demuxer all programs: %.1f Mbps (%.1fx realtime), %" PRId64 " frames\n", mbps, mbps * 1000000 / BITRATE, ctx.frames);
+
+	mbps = mpeg_ts_mpts_demux(&ctx, N_PROGRAM / 2, 7 * 188, 0);
+	assert(0 == ctx.errors);
+	printf("ts_demuxer one program: %.1f Mbps (%.1fx realtime), %" PRId64 " frames\n", mbps, mbps * 1000000 / BITRATE, ctx.frames);
+
+	mbps = mpeg_ts_mpts_demux(&ctx, 0, 4 * 1024 * 1024, 0);
+	printf("ts_demuxer 4MB read: %.1f Mbps, %" PRId64 " frames\n", mbps, ctx.frames);
+
+	mbps = mpeg_ts_mpts_demux(&ctx, 0, 4 * 1024 * 1024, 1);
+	printf("ts_demuxer 4MB read zero-copy: %.1f Mbps, %" PRId64 " frames\n", mbps, ctx.frames);
+
+	free(ctx.ptr);
+}
@@ -0,0 +1,80 @@
+#include "mpeg-ts.h"
+#include "mpeg-ts-proto.h"
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <set>
+#include <vector>
+
+static void* ts_alloc(void* /*param*/, size_t bytes)
+{
+	static char s_buffer[188];
+	assert(bytes <= sizeof(s_buffer));
+	return s_buffer;
+}
+
+static void ts_free(void* /*param*/, void* /*packet*/)
+{
+	return;
+}
+
+static int ts_write(void* param, const void* packet, size_t bytes)
+{
+	std::vector<uint8_t>* ts = (std::vector<uint8_t>*)param;
+	ts->insert(ts->end(), (const uint8_t*)packet, (const uint8_t*)packet + bytes);
+	return 0;
+}
+
+static int ts_onpacket(void* param, int /*program*/, int stream, int codecid, int /*flags*/, int64_t /*pts*/, int64_t /*dts*/, const void* /*data*/, size_t /*bytes*/)
+{
+	std::set<int>* streams = (std::set<int>*)param;
+	assert(PSI_STREAM_AAC == codecid);
+	streams->insert(stream);
+	return 0;
+}
+
+// PMT is one TS packet: add stream until full, all added streams must be demuxed
+void mpeg_ts_pmt_test(void)
+{
+	int i, r, n;
+	int streams[PMT_STREAM_MAX];
+	uint8_t esinfo[170];
+	uint8_t adts[] = { 0xFF, 0xF1, 0x50, 0x80, 0x01, 0x9F, 0xFC, 0x21, 0x00, 0x49, 0x90, 0x02 };
+	std::vector<uint8_t> ts;
+	std::set<int> pids;
+
+	struct mpeg_ts_func_t tshandler;
+	tshandler.alloc = ts_alloc;
+	tshandler.write = ts_write;
+	tshandler.free = ts_free;
+	void* muxer = mpeg_ts_create(&tshandler, &ts);
+
+	for (n = 0; n < 40; n++)
+	{
+		r = mpeg_ts_add_stream(muxer, PSI_STREAM_AAC, NULL, 0);
+		if (r <= 0)
+			break;
+		streams[n] = r;
+	}
+	assert(-E2BIG == r && n > 4 && n < 40);
+
+	// stream descriptor don't fit, same as before
+	memset(esinfo, 0, sizeof(esinfo));
+	r = mpeg_ts_add_stream(muxer, PSI_STREAM_AAC, esinfo, sizeof(esinfo));
+	assert(-E2BIG == r);
+
+	for (i = 0; i < n; i++)
+	{
+		r = mpeg_ts_write(muxer, streams[i], 0, i * 1024, i * 1024, adts, sizeof(adts));
+		assert(0 == r);
+	}
+	mpeg_ts_destroy(muxer);
+
+	struct ts_demuxer_t* demuxer = ts_demuxer_create(ts_onpacket, &pids);
+	for (i = 0; i + 188 <= (int)ts.size(); i += 188)
+		ts_demuxer_input(demuxer, &ts[i], 188);
+	ts_demuxer_flush(demuxer);
+	ts_demuxer_destroy(demuxer);
+	assert(n == (int)pids.size());
+}
@@ -0,0 +1,174 @@
+#include "mpeg-ts.h"
+#include "mpeg-ts-proto.h"
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define N 200 // video frame count
+
+static void* ts_alloc(void* /*param*/, size_t bytes)
+{
+	static char s_buffer[188];
+	assert(bytes <= sizeof(s_buffer));
+	return s_buffer;
+}
+
+static void ts_free(void* /*param*/, void* /*packet*/)
+{
+	return;
+}
+
+static int ts_write(void* param, const void* packet, size_t bytes)
+{
+	std::vector<uint8_t>* ts = (std::vector<uint8_t>*)param;
+	ts->insert(ts->end(), (const uint8_t*)packet, (const uint8_t*)packet + bytes);
+	return 0;
+}
+
+static int ts_onpacket(void* param, int program, int stream, int codecid, int flags, int64_t pts, int64_t dts, const void* data, size_t bytes)
+{
+	char header[128];
+	std::vector<std::string>* packets = (std::vector<std::string>*)param;
+	snprintf(header, sizeof(header), "%d %d %d %d %lld %lld %u:", program, stream, codecid, flags, (long long)pts, (long long)dts, (unsigned int)bytes);
+	packets->push_back(std::string(header) + std::string((const char*)data, bytes));
+	return 0;
+}
+
+/// random bytes without sync byte
+static void mpeg_ts_sync_junk(std::vector<uint8_t>& v, int bytes)
+{
+	int i;
+	for (i = 0; i < bytes; i++)
+		v.push_back((uint8_t)(0x47 + 1 + rand() % 255));
+}
+
+static void mpeg_ts_sync_mux(std::vector<uint8_t>& ts)
+{
+	int i, j, n, audio, video;
+	uint8_t adts[512];
+	std::vector<uint8_t> au;
+
+	struct mpeg_ts_func_t tshandler;
+	tshandler.alloc = ts_alloc;
+	tshandler.write = ts_write;
+	tshandler.free = ts_free;
+	void* muxer = mpeg_ts_create(&tshandler, &ts);
+	video = mpeg_ts_add_stream(muxer, PSI_STREAM_H264, NULL, 0);
+	audio = mpeg_ts_add_stream(muxer, PSI_STREAM_AAC, NULL, 0);
+	assert(video > 0 && audio > 0);
+
+	srand(1);
+	for (i = 0; i < N; i++)
+	{
+		// Annex B slice, payload without zero byte(no start code emulation)
+		au.assign(4, 0);
+		au[3] = 0x01;
+		au.push_back(0 == i % 25 ? 0x65 : 0x41);
+		n = 16 + rand() % (0 == i % 25 ? 30000 : 3000);
+		for (j = 0; j < n; j++)
+			au.push_back((uint8_t)(rand() | 0x01));
+		j = mpeg_ts_write(muxer, video, 0 == i % 25 ? 0x0001 : 0, i * 3600, i * 3600, au.data(), au.size());
+		assert(0 == j);
+
+		// AAC-LC 44.1kHz stereo ADTS frame
+		n = 7 + rand() % (sizeof(adts) - 7);
+		adts[0] = 0xFF;
+		adts[1] = 0xF1;
+		adts[2] = 0x50;
+		adts[3] = (uint8_t)(0x80 | ((n >> 11) & 0x03));
+		adts[4] = (uint8_t)(n >> 3);
+		adts[5] = (uint8_t)(((n & 0x07) << 5) | 0x1F);
+		adts[6] = 0xFC;
+		for (j = 7; j < n; j++)
+			adts[j] = (uint8_t)rand();
+		j = mpeg_ts_write(muxer, audio, 0, i * 3600 + 1800, i * 3600 + 1800, adts, n);
+		assert(0 == j);
+	}
+	mpeg_ts_destroy(muxer);
+	assert(ts.size() > 0 && 0 == ts.size() % 188);
+}
+
+/// @param[in] chunk 0-random split, >0-fixed input size
+static void mpeg_ts_sync_demux(const std::vector<uint8_t>& ts, size_t chunk, std::vector<std::string>& packets)
+{
+	int r;
+	size_t i, n;
+	struct ts_demuxer_t* demuxer = ts_demuxer_create(ts_onpacket, &packets);
+	for (i = 0; i < ts.size(); i += n)
+	{
+		n = chunk ? chunk : (size_t)(1 + rand() % 1000);
+		n = n < ts.size() - i ? n : ts.size() - i;
+		r = ts_demuxer_input(demuxer, &ts[i], n);
+		assert(0 == r);
+	}
+	ts_demuxer_flush(demuxer);
+	ts_demuxer_destroy(demuxer);
+}
+
+// ts_demuxer_input: input split, leading garbage, junk between packets and M2TS framing are demuxed same as 188-bytes packets
+void mpeg_ts_sync_test(void)
+{
+	size_t i;
+	std::vector<uint8_t> ts, v;
+	std::vector<std::string> baseline, packets;
+
+	mpeg_ts_sync_mux(ts);
+
+	// baseline: one 188-bytes packet per call
+	mpeg_ts_sync_demux(ts, 188, baseline);
+	assert(2 * N == (int)baseline.size());
+
+	// UDP datagram: 7 packets per call
+	mpeg_ts_sync_demux(ts, 7 * 188, packets);
+	assert(baseline == packets);
+
+	// random split
+	packets.clear();
+	mpeg_ts_sync_demux(ts, 0, packets);
+	assert(baseline == packets);
+
+	// garbage before the first sync byte
+	v.clear();
+	mpeg_ts_sync_junk(v, 1000);
+	v.insert(v.end(), ts.begin(), ts.end());
+	packets.clear();
+	mpeg_ts_sync_demux(v, 188, packets);
+	assert(baseline == packets);
+	packets.clear();
+	mpeg_ts_sync_demux(v, 0, packets);
+	assert(baseline == packets);
+
+	// junk between packets, re-synchronize(packet size is locked by 3 consecutive packets)
+	v.clear();
+	mpeg_ts_sync_junk(v, 37);
+	for (i = 0; i < ts.size(); i += 188)
+	{
+		v.insert(v.end(), ts.begin() + i, ts.begin() + i + 188);
+		if (49 == i / 188 % 50 && i + 3 * 188 < ts.size())
+			mpeg_ts_sync_junk(v, 1 + rand() % 400);
+	}
+	packets.clear();
+	mpeg_ts_sync_demux(v, 0, packets);
+	assert(baseline == packets);
+
+	// M2TS(BDAV): 4-bytes TP_extra_header + 188-bytes TS packet
+	v.clear();
+	mpeg_ts_sync_junk(v, 100);
+	for (i = 0; i < ts.size(); i += 188)
+	{
+		v.push_back((uint8_t)(i >> 24));
+		v.push_back((uint8_t)(i >> 16));
+		v.push_back((uint8_t)(i >> 8));
+		v.push_back((uint8_t)i);
+		v.insert(v.end(), ts.begin() + i, ts.begin() + i + 188);
+	}
+	packets.clear();
+	mpeg_ts_sync_demux(v, 192, packets);
+	assert(baseline == packets);
+	packets.clear();
+	mpeg_ts_sync_demux(v, 0, packets);
+	assert(baseline == packets);
+}
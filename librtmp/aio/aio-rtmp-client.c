@@ -25,6 +25,7 @@ static void aio_rtmp_transport_ondestroy(void* param);
 static void aio_rtmp_transport_onsend(void* param, int code, size_t bytes);
 static void aio_rtmp_transport_onrecv(void* param, int code, const void* data, size_t bytes);
 static int rtmp_client_send(void* param, const void* header, size_t len, const void* payload, size_t bytes);
+static int rtmp_client_sendv(void* param, const struct rtmp_iovec_t* vec, int n);
 static int rtmp_client_onaudio(void* param, const void* audio, size_t bytes, uint32_t timestamp);
 static int rtmp_client_onvideo(void* param, const void* video, size_t bytes, uint32_t timestamp);
 static int rtmp_client_onscript(void* param, const void* script, size_t bytes, uint32_t timestamp);
@@ -41,6 +42,7 @@ struct aio_rtmp_client_t* aio_rtmp_client_create(aio_socket_t aio, const char* a
 		c->param = param;
 		
 		h2.send = rtmp_client_send;
+		h2.sendv = rtmp_client_sendv;
 		h2.onaudio = rtmp_client_onaudio;
 		h2.onvideo = rtmp_client_onvideo;
 		h2.onscript = rtmp_client_onscript;
@@ -111,6 +113,13 @@ static int rtmp_client_send(void* param, const void* header, size_t len, const v
 	return aio_rtmp_transport_send(client->aio, header, len, payload, bytes);
 }
 
+static int rtmp_client_sendv(void* param, const struct rtmp_iovec_t* vec, int n)
+{
+	struct aio_rtmp_client_t* client;
+	client = (struct aio_rtmp_client_t*)param;
+	return aio_rtmp_transport_sendv(client->aio, vec, n);
+}
+
 static int rtmp_client_onaudio(void* param, const void* audio, size_t bytes, uint32_t timestamp)
 {
 	struct aio_rtmp_client_t* client;
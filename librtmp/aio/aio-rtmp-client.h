@@ -41,6 +41,7 @@ int aio_rtmp_client_stop(aio_rtmp_client_t* client);
 int aio_rtmp_client_pause(aio_rtmp_client_t* rtmp, int pause); // VOD only
 int aio_rtmp_client_seek(aio_rtmp_client_t* rtmp, double timestamp); // VOD only
 
+/// @param[in] flv audio/video data is sent without copy, keep it valid until sent(onsend/aio_rtmp_client_get_unsend() == 0)
 int aio_rtmp_client_send_audio(aio_rtmp_client_t* client, const void* flv, size_t bytes, uint32_t timestamp);
 int aio_rtmp_client_send_video(aio_rtmp_client_t* client, const void* flv, size_t bytes, uint32_t timestamp);
 int aio_rtmp_client_send_script(aio_rtmp_client_t* client, const void* flv, size_t bytes, uint32_t timestamp);
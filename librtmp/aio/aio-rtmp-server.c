@@ -39,6 +39,8 @@ static void rtmp_session_onsend(void* param, int code, size_t bytes);
 static void rtmp_session_onrecv(void* param, int code, const void* data, size_t bytes);
 
 static int rtmp_handler_send(void* param, const void* header, size_t len, const void* payload, size_t bytes);
+static int rtmp_handler_sendv(void* param, const struct rtmp_iovec_t* vec, int n);
+static int rtmp_handler_sendprepared(void* param, const void* header, size_t len, rtmp_prepared_t* msg, const void* body, size_t bytes);
 static int rtmp_handler_onpublish(void* param, const char* app, const char* stream, const char* type);
 static int rtmp_handler_onscript(void* param, const void* data, size_t bytes, uint32_t timestamp);
 static int rtmp_handler_onaudio(void* param, const void* data, size_t bytes, uint32_t timestamp);
@@ -111,6 +113,11 @@ int aio_rtmp_server_send_script(struct aio_rtmp_session_t* session, const void*
 	return rtmp_server_send_script(session->rtmp, data, bytes, timestamp);
 }
 
+int aio_rtmp_server_send_prepared(struct aio_rtmp_session_t* session, rtmp_prepared_t* msg)
+{
+	return rtmp_server_send_prepared(session->rtmp, msg);
+}
+
 size_t aio_rtmp_server_get_unsend(struct aio_rtmp_session_t* session)
 {
 	return aio_rtmp_transport_get_unsend(session->aio);
@@ -148,6 +155,8 @@ static void aio_rtmp_server_onaccept(void* param, int code, socket_t socket, con
 		memcpy(&session->sa, sa, session->salen);
 
 		handler.send = rtmp_handler_send;
+		handler.sendv = rtmp_handler_sendv;
+		handler.sendprepared = rtmp_handler_sendprepared;
 		handler.onplay = rtmp_handler_onplay;
 		handler.onseek = rtmp_handler_onseek;
 		handler.onpause = rtmp_handler_onpause;
@@ -224,6 +233,20 @@ static int rtmp_handler_send(void* param, const void* header, size_t len, const
 	return aio_rtmp_transport_send(session->aio, header, len, payload, bytes);
 }
 
+static int rtmp_handler_sendv(void* param, const struct rtmp_iovec_t* vec, int n)
+{
+	struct aio_rtmp_session_t* session;
+	session = (struct aio_rtmp_session_t*)param;
+	return aio_rtmp_transport_sendv(session->aio, vec, n);
+}
+
+static int rtmp_handler_sendprepared(void* param, const void* header, size_t len, rtmp_prepared_t* msg, const void* body, size_t bytes)
+{
+	struct aio_rtmp_session_t* session;
+	session = (struct aio_rtmp_session_t*)param;
+	return aio_rtmp_transport_send_prepared(session->aio, header, len, msg, body, bytes);
+}
+
 static int rtmp_handler_onplay(void* param, const char* app, const char* stream, double start, double duration, uint8_t reset)
 {
 	struct aio_rtmp_session_t* session;
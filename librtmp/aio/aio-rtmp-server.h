@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "rtmp-server.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,10 +49,15 @@ aio_rtmp_server_t* aio_rtmp_server_create(const char* ip, int port, struct aio_r
 int aio_rtmp_server_destroy(aio_rtmp_server_t* server);
 
 /// @param[in] session oncreate session parameter
+/// @param[in] flv audio/video data is sent without copy, keep it valid until sent(onsend/aio_rtmp_server_get_unsend() == 0)
 int aio_rtmp_server_send_audio(aio_rtmp_session_t* session, const void* flv, size_t bytes, uint32_t timestamp);
 int aio_rtmp_server_send_video(aio_rtmp_session_t* session, const void* flv, size_t bytes, uint32_t timestamp);
 int aio_rtmp_server_send_script(aio_rtmp_session_t* session, const void* flv, size_t bytes, uint32_t timestamp);
 
+/// live fan-out: rtmp_prepared_create once per audio/video/script tag, send to every play session, then rtmp_prepared_release
+/// @param[in] msg prepared message, the session holds a reference until sent
+int aio_rtmp_server_send_prepared(aio_rtmp_session_t* session, rtmp_prepared_t* msg);
+
 size_t aio_rtmp_server_get_unsend(aio_rtmp_session_t* session);
 int aio_rtmp_server_get_addr(aio_rtmp_session_t* session, char ip[65], unsigned short* port);
 
@@ -1,5 +1,6 @@
 #include "aio-rtmp-transport.h"
 #include "aio-tcp-transport.h"
+#include "rtmp-server.h"
 #include "sys/sock.h"
 #include "sys/locker.h"
 #include "sys/system.h"
@@ -9,13 +10,22 @@
 #include <string.h>
 #include <assert.h>
 
-#define VEC 8
+#define VEC 256 // >= one sendv message(64 chunk header + payload slices)
 
 struct aio_rtmp_chunk_t
 {
 	struct list_head node;
 	uint8_t* data;
 	size_t size;
+
+	// shared prepared message body(optional)
+	rtmp_prepared_t* msg;
+	const void* body;
+	size_t bytes;
+
+	// sendv slices(optional), chunk headers copied to data, payload referenced
+	int n;
+	struct rtmp_iovec_t* vec;
 };
 
 struct aio_rtmp_transport_t
@@ -23,6 +33,7 @@ struct aio_rtmp_transport_t
 	int code;
 
 	int vecsize;
+	int nodes; // sending list nodes
 	socket_bufvec_t vec[VEC];
 	aio_tcp_transport_t* aio;
 	char buffer[2 * 1024];
@@ -38,6 +49,7 @@ struct aio_rtmp_transport_t
 
 static int aio_rtmp_send(struct aio_rtmp_transport_t* t)
 {
+	int i;
 	struct list_head* p;
 	struct aio_rtmp_chunk_t* c;
 
@@ -48,12 +60,25 @@ static int aio_rtmp_send(struct aio_rtmp_transport_t* t)
 		return 0;
 	}
 
-	assert(0 == t->vecsize);
-	for (p = t->root.next; t->vecsize < VEC && t->vecsize < t->count; t->vecsize++)
+	assert(0 == t->vecsize && 0 == t->nodes);
+	for (p = t->root.next; t->nodes < t->count; t->nodes++)
 	{
 		assert(p != &t->root);
 		c = list_entry(p, struct aio_rtmp_chunk_t, node);
-		socket_setbufvec(t->vec, t->vecsize, c->data, c->size);
+		if (t->vecsize + (c->n > 0 ? c->n : 2) > VEC)
+			break;
+
+		if (c->n > 0)
+		{
+			for (i = 0; i < c->n; i++)
+				socket_setbufvec(t->vec, t->vecsize++, (void*)c->vec[i].base, c->vec[i].len);
+		}
+		else
+		{
+			socket_setbufvec(t->vec, t->vecsize++, c->data, c->size);
+			if (c->msg)
+				socket_setbufvec(t->vec, t->vecsize++, (void*)c->body, c->bytes);
+		}
 		p = p->next;
 	}
 
@@ -76,6 +101,8 @@ static void aio_rtmp_ondestroy(void* param)
 	list_for_each_safe(p, n, &t->root)
 	{
 		c = list_entry(p, struct aio_rtmp_chunk_t, node);
+		if (c->msg)
+			rtmp_prepared_release(c->msg);
 		free(c);
 	}
 
@@ -110,14 +137,17 @@ static void aio_rtmp_onsend(void* param, int code, size_t bytes)
 	if (0 == code)
 	{
 		locker_lock(&t->locker);
-		for (assert(t->vecsize > 0); t->vecsize > 0; --t->vecsize)
+		for (assert(t->nodes > 0); t->nodes > 0; --t->nodes)
 		{
 			assert(!list_empty(&t->root));
 			c = list_entry(t->root.next, struct aio_rtmp_chunk_t, node);
 			list_remove(t->root.next);
+			if (c->msg)
+				rtmp_prepared_release(c->msg);
 			free(c);
 			t->count -= 1;
 		}
+		t->vecsize = 0;
 		t->bytes -= bytes;
 		locker_unlock(&t->locker);
 	}
@@ -175,6 +205,8 @@ int aio_rtmp_transport_send(struct aio_rtmp_transport_t* t, const void* header,
 
 	c->data = (uint8_t*)(c + 1);
 	c->size = len + bytes;
+	c->msg = NULL;
+	c->n = 0;
 	if(len > 0) memcpy(c->data, header, len);
 	if (bytes > 0) memcpy(c->data + len, payload, bytes);
 
@@ -187,6 +219,83 @@ int aio_rtmp_transport_send(struct aio_rtmp_transport_t* t, const void* header,
 	return 0 == aio_rtmp_send(t) ? len + bytes : -1;
 }
 
+int aio_rtmp_transport_sendv(struct aio_rtmp_transport_t* t, const struct rtmp_iovec_t* vec, int n)
+{
+	int i;
+	size_t len, bytes;
+	struct aio_rtmp_chunk_t* c;
+	if (0 != t->code)
+		return -1;
+	if (n < 1 || n > VEC)
+		return -EINVAL;
+
+	for (len = bytes = i = 0; i < n; i++)
+	{
+		bytes += vec[i].len;
+		if (0 == i % 2)
+			len += vec[i].len;
+	}
+
+	// one list node per rtmp message(all chunks), copy chunk headers only
+	c = (struct aio_rtmp_chunk_t*)malloc(sizeof(*c) + sizeof(c->vec[0]) * n + len);
+	if (NULL == c)
+		return -ENOMEM;
+
+	c->vec = (struct rtmp_iovec_t*)(c + 1);
+	c->data = (uint8_t*)(c->vec + n);
+	c->size = len;
+	c->msg = NULL;
+	c->n = n;
+	for (len = i = 0; i < n; i++)
+	{
+		c->vec[i].len = vec[i].len;
+		c->vec[i].base = vec[i].base;
+		if (0 == i % 2 && vec[i].len > 0)
+		{
+			memcpy(c->data + len, vec[i].base, vec[i].len);
+			c->vec[i].base = c->data + len;
+			len += vec[i].len;
+		}
+	}
+
+	locker_lock(&t->locker);
+	t->count += 1;
+	t->bytes += bytes;
+	list_insert_before(&c->node, &t->root); // link to end
+	locker_unlock(&t->locker);
+
+	return 0 == aio_rtmp_send(t) ? (int)bytes : -1;
+}
+
+int aio_rtmp_transport_send_prepared(struct aio_rtmp_transport_t* t, const void* header, size_t len, rtmp_prepared_t* msg, const void* body, size_t bytes)
+{
+	struct aio_rtmp_chunk_t* c;
+	if (0 != t->code)
+		return -1;
+
+	// copy session chunk header only, body is shared by reference
+	c = (struct aio_rtmp_chunk_t*)malloc(sizeof(*c) + len);
+	if (NULL == c)
+		return -ENOMEM;
+
+	c->data = (uint8_t*)(c + 1);
+	c->size = len;
+	c->n = 0;
+	if (len > 0) memcpy(c->data, header, len);
+	rtmp_prepared_addref(msg);
+	c->msg = msg;
+	c->body = body;
+	c->bytes = bytes;
+
+	locker_lock(&t->locker);
+	t->count += 1;
+	t->bytes += len + bytes;
+	list_insert_before(&c->node, &t->root); // link to end
+	locker_unlock(&t->locker);
+
+	return 0 == aio_rtmp_send(t) ? (int)(len + bytes) : -1;
+}
+
 size_t aio_rtmp_transport_get_unsend(struct aio_rtmp_transport_t* t)
 {
 	return t->bytes;
@@ -2,6 +2,7 @@
 #define _aio_rtmp_transport_h_
 
 #include "aio-tcp-transport.h"
+#include "rtmp-iovec.h"
 #include <stdint.h>
 #include <stddef.h>
 
@@ -10,6 +11,7 @@ extern "C" {
 #endif
 
 typedef struct aio_rtmp_transport_t aio_rtmp_transport_t;
+struct rtmp_prepared_t;
 
 struct aio_rtmp_handler_t
 {
@@ -39,6 +41,17 @@ int aio_rtmp_transport_start(aio_rtmp_transport_t* transport);
 
 int aio_rtmp_transport_send(aio_rtmp_transport_t* transport, const void* header, size_t len, const void* payload, size_t bytes);
 
+/// send all chunks of a rtmp message with one list node
+/// @param[in] vec vec[2*i] chunk header(copied), vec[2*i+1] payload slice(referenced, must be valid until sent)
+/// @param[in] n vec count
+/// @return >0-sent bytes, <0-error
+int aio_rtmp_transport_sendv(aio_rtmp_transport_t* transport, const struct rtmp_iovec_t* vec, int n);
+
+/// send session chunk header + shared prepared message body without copy
+/// @param[in] msg prepared message, hold a reference until body sent
+/// @return >0-sent bytes, <0-error
+int aio_rtmp_transport_send_prepared(aio_rtmp_transport_t* transport, const void* header, size_t len, struct rtmp_prepared_t* msg, const void* body, size_t bytes);
+
 size_t aio_rtmp_transport_get_unsend(aio_rtmp_transport_t* transport);
 
 /// set recv/send timeout in ms(default 2min, 0-infinite)
@@ -0,0 +1,53 @@
+#ifndef _rtmp_atomic_h_
+#define _rtmp_atomic_h_
+
+#if defined(OS_WINDOWS) || defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+
+static inline long rtmp_atomic_increment(volatile long* value)
+{
+	return InterlockedIncrement(value);
+}
+
+static inline long rtmp_atomic_decrement(volatile long* value)
+{
+	return InterlockedDecrement(value);
+}
+
+static inline void rtmp_spinlock_lock(volatile long* lock)
+{
+	while (0 != InterlockedExchange(lock, 1))
+		YieldProcessor();
+}
+
+static inline void rtmp_spinlock_unlock(volatile long* lock)
+{
+	InterlockedExchange(lock, 0);
+}
+
+#else
+
+static inline long rtmp_atomic_increment(volatile long* value)
+{
+	return __sync_add_and_fetch(value, 1);
+}
+
+static inline long rtmp_atomic_decrement(volatile long* value)
+{
+	return __sync_sub_and_fetch(value, 1);
+}
+
+static inline void rtmp_spinlock_lock(volatile long* lock)
+{
+	while (0 != __sync_lock_test_and_set(lock, 1))
+		;
+}
+
+static inline void rtmp_spinlock_unlock(volatile long* lock)
+{
+	__sync_lock_release(lock);
+}
+
+#endif
+
+#endif /* !_rtmp_atomic_h_ */
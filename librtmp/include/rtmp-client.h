@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "rtmp-iovec.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -16,6 +17,12 @@ struct rtmp_client_handler_t
 	///@return >0-sent bytes, <0-error
 	int (*send)(void* param, const void* header, size_t len, const void* payload, size_t bytes);
 
+	///network implementation(optional), send a whole audio/video message(all chunk headers and payload slices) at once
+	///@param[in] vec vec[2*i] chunk header(stack buffer), vec[2*i+1] payload slice of the rtmp_client_send_audio/rtmp_client_send_video data
+	///@param[in] n vec count
+	///@return >0-sent bytes, <0-error
+	int (*sendv)(void* param, const struct rtmp_iovec_t* vec, int n);
+
 	///VOD only
 	///@param[in] video FLV VideoTagHeader + AVCVIDEOPACKET: AVCDecoderConfigurationRecord(ISO 14496-15) / One or more NALUs(four-bytes length + NALU)
 	///@param[in] audio FLV AudioTagHeader + AACAUDIODATA: AudioSpecificConfig(14496-3) / Raw AAC frame data in UI8
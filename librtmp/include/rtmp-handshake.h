@@ -18,6 +18,10 @@ enum
 	RTMP_HANDSHAKE_2, // received C2/S2, handshake done
 };
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 int rtmp_handshake_c0(uint8_t* c0, int version);
 int rtmp_handshake_c1(uint8_t* c1, uint32_t timestamp);
 int rtmp_handshake_c2(uint8_t* c2, uint32_t timestamp, const uint8_t* s1, size_t bytes);
@@ -26,4 +30,7 @@ int rtmp_handshake_s0(uint8_t* s0, int version);
 int rtmp_handshake_s1(uint8_t* s1, uint32_t timestamp);
 int rtmp_handshake_s2(uint8_t* s2, uint32_t timestamp, const uint8_t* c1, size_t bytes);
 
+#if defined(__cplusplus)
+}
+#endif
 #endif /* !_rtmp_handshake_h_ */
@@ -4,9 +4,13 @@
 #include "rtmp-chunk-header.h"
 #include "rtmp-netconnection.h"
 #include "rtmp-netstream.h"
+#include "rtmp-iovec.h"
 
-#define N_CHUNK_STREAM	8 // maximum chunk stream count
+#define N_CHUNK_STREAM	8 // initial chunk stream count(inline hash table)
+#define N_CHUNK_STREAM_MAX	256 // maximum chunk streams per connection(each may buffer a 16MB message)
 #define N_STREAM_NAME	256
+#define N_CHUNK_VEC		64 // maximum chunk count per sendv call
+#define RTMP_OUTPUT_CHUNK_SIZE	4096 // server output chunk size
 
 #define RTMP_STREAM_LIVE	"live"
 #define RTMP_STREAM_RECORD	"record"
@@ -61,11 +65,37 @@ struct rtmp_packet_t
 	uint32_t delta; // delta / timestamp
 	uint32_t clock; // timestamp
 
-	uint8_t* payload;
+	uint8_t* payload; // rtmp_pool_alloc, only in-flight message
 	size_t capacity; // only for network read
 	size_t bytes; // only for network read
 };
 
+// chunk streams, open-addressed hash table by cid(linear probing)
+struct rtmp_packets_t
+{
+	struct rtmp_packet_t* table; // NULL-use packets
+	uint32_t capacity; // table size(power of 2), 0-N_CHUNK_STREAM
+	uint32_t count; // chunk streams in table, <= N_CHUNK_STREAM_MAX
+	struct rtmp_packet_t packets[N_CHUNK_STREAM];
+};
+
+// pre-chunked message shared by many sessions
+struct rtmp_prepared_t
+{
+	volatile long ref;
+
+	uint8_t type; // RTMP_TYPE_AUDIO/RTMP_TYPE_VIDEO/RTMP_TYPE_DATA
+	uint32_t cid; // chunk stream id
+	uint32_t timestamp;
+	uint32_t chunk_size; // body chunk size
+
+	uint8_t* payload; // message payload
+	size_t bytes;
+
+	uint8_t* body; // chunk(0) + [type-3 basic header + chunk(n)]..., without the first chunk header
+	size_t size;
+};
+
 // 5.3.1. Chunk Format (p11)
 /* 3-bytes basic header + 11-bytes message header + 4-bytes extended timestamp */
 #define MAX_CHUNK_HEADER 18
@@ -104,14 +134,20 @@ struct rtmp_t
 	uint8_t limit_type; // client bandwidth limit
 	
 	// chunk header
-	struct rtmp_packet_t in_packets[N_CHUNK_STREAM]; // receive from network
-	struct rtmp_packet_t out_packets[N_CHUNK_STREAM]; // send to network
+	struct rtmp_packets_t in_packets; // receive from network
+	struct rtmp_packets_t out_packets; // send to network
 	struct rtmp_parser_t parser;
 
 	void* param;
 
 	/// @return 0-ok, other-error
 	int (*send)(void* param, const uint8_t* header, uint32_t headerBytes, const uint8_t* payload, uint32_t payloadBytes);
+	/// optional, send chunk header/payload slices at once(vec[2*i] header, vec[2*i+1] payload)
+	/// @return 0-ok, other-error
+	int (*sendv)(void* param, const struct rtmp_iovec_t* vec, int n);
+	/// optional, send first chunk header + prepared message body(msg->body)
+	/// @return 0-ok, other-error
+	int (*sendprepared)(void* param, const uint8_t* header, uint32_t headerBytes, struct rtmp_prepared_t* msg);
 	
 	int (*onaudio)(void* param, const uint8_t* data, size_t bytes, uint32_t timestamp);
 	int (*onvideo)(void* param, const uint8_t* data, size_t bytes, uint32_t timestamp);
@@ -149,10 +185,28 @@ struct rtmp_t
 	} u;
 };
 
+/// @param[in] create 1-create chunk stream if not found
+/// @return NULL-not found or no memory, other-chunk stream(valid until next create)
+struct rtmp_packet_t* rtmp_packets_find(struct rtmp_packets_t* packets, uint32_t cid, int create);
+/// iterate chunk streams: for (i = 0; NULL != (pkt = rtmp_packets_next(packets, &i));)
+/// @param[in,out] index table position, start from 0
+/// @return NULL-no more chunk stream, other-chunk stream
+struct rtmp_packet_t* rtmp_packets_next(struct rtmp_packets_t* packets, uint32_t* index);
+/// free all payload and table
+void rtmp_packets_free(struct rtmp_packets_t* packets);
+
+/// thread-safe payload buffer pool(power of 2 size class)
+/// @param[out] capacity buffer size, for rtmp_pool_free
+/// @return NULL-no memory
+void* rtmp_pool_alloc(size_t bytes, size_t* capacity);
+void rtmp_pool_free(void* ptr, size_t capacity);
+
 /// @return 0-ok, other-error
 int rtmp_chunk_read(struct rtmp_t* rtmp, const uint8_t* data, size_t bytes);
 /// @return 0-ok, other-error
 int rtmp_chunk_write(struct rtmp_t* rtmp, const struct rtmp_chunk_header_t* header, const uint8_t* payload);
+/// @return 0-ok, other-error
+int rtmp_chunk_write_prepared(struct rtmp_t* rtmp, const struct rtmp_chunk_header_t* header, struct rtmp_prepared_t* msg);
 
 int rtmp_handler(struct rtmp_t* rtmp, struct rtmp_chunk_header_t* header, const uint8_t* payload);
 int rtmp_event_handler(struct rtmp_t* rtmp, const struct rtmp_chunk_header_t* header, const uint8_t* data);
@@ -0,0 +1,13 @@
+#ifndef _rtmp_iovec_h_
+#define _rtmp_iovec_h_
+
+#include <stddef.h>
+
+/// scatter-gather buffer: chunk header or payload slice
+struct rtmp_iovec_t
+{
+	const void* base;
+	size_t len;
+};
+
+#endif /* !_rtmp_iovec_h_ */
@@ -3,12 +3,14 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "rtmp-iovec.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 typedef struct rtmp_server_t rtmp_server_t;
+typedef struct rtmp_prepared_t rtmp_prepared_t;
 
 struct rtmp_server_handler_t
 {
@@ -18,6 +20,18 @@ struct rtmp_server_handler_t
 	///@return >0-sent bytes, <0-error
 	int (*send)(void* param, const void* header, size_t len, const void* payload, size_t bytes);
 
+	///network implementation(optional), send a whole audio/video message(all chunk headers and payload slices) at once
+	///@param[in] vec vec[2*i] chunk header(stack buffer), vec[2*i+1] payload slice of the rtmp_server_send_audio/rtmp_server_send_video data
+	///@param[in] n vec count
+	///@return >0-sent bytes, <0-error
+	int (*sendv)(void* param, const struct rtmp_iovec_t* vec, int n);
+
+	///network implementation(optional), send a session chunk header + shared prepared message body
+	///@param[in] msg rtmp_server_send_prepared message, call rtmp_prepared_addref to keep body after return
+	///@param[in] body pre-chunked message data, valid until msg released
+	///@return >0-sent bytes, <0-error
+	int (*sendprepared)(void* param, const void* header, size_t len, rtmp_prepared_t* msg, const void* body, size_t bytes);
+
 	///@return 0-ok, other-error
 	//int (*oncreate_stream)(void* param, uint32_t* stream_id);
 	//int (*ondelete_stream)(void* param, uint32_t stream_id);
@@ -66,6 +80,20 @@ int rtmp_server_send_audio(rtmp_server_t* rtmp, const void* data, size_t bytes,
 int rtmp_server_send_video(rtmp_server_t* rtmp, const void* data, size_t bytes, uint32_t timestamp);
 int rtmp_server_send_script(rtmp_server_t* rtmp, const void* data, size_t bytes, uint32_t timestamp);
 
+/// prepared(pre-chunked) message, chunked once and shared by all play sessions of a live stream
+/// @param[in] type 8-audio, 9-video, 18-script(RTMP_TYPE_AUDIO/RTMP_TYPE_VIDEO/RTMP_TYPE_DATA)
+/// @param[in] data FLV audio/video/script tag data(same as rtmp_server_send_xxx)
+/// @return NULL-error, other-message with reference count 1
+rtmp_prepared_t* rtmp_prepared_create(int type, const void* data, size_t bytes, uint32_t timestamp);
+/// @return reference count after addref/release, free on 0
+int rtmp_prepared_addref(rtmp_prepared_t* msg);
+int rtmp_prepared_release(rtmp_prepared_t* msg);
+
+/// send prepared message, only the first chunk header is built per session
+/// @param[in] rtmp rtmp_server_create instance
+/// @return 0-ok, other-error
+int rtmp_server_send_prepared(rtmp_server_t* rtmp, rtmp_prepared_t* msg);
+
 #ifdef __cplusplus
 }
 #endif
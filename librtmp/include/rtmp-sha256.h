@@ -0,0 +1,51 @@
+#ifndef _rtmp_sha256_h_
+#define _rtmp_sha256_h_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(_OPENSSL_)
+#if !defined(OPENSSL_SUPPRESS_DEPRECATED)
+#define OPENSSL_SUPPRESS_DEPRECATED // SHA256_CTX lives on stack, EVP_MD_CTX needs heap
+#endif
+#include <openssl/sha.h>
+#endif
+
+#define RTMP_SHA256_DIGEST_LENGTH 32
+#define RTMP_SHA256_BLOCK_LENGTH 64
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/// SHA-256 context, stack allocated, one per computation
+struct rtmp_sha256_t
+{
+#if defined(_OPENSSL_)
+	SHA256_CTX ctx;
+#else
+	uint32_t state[8];
+	uint64_t bytes; // total input bytes
+	uint8_t block[RTMP_SHA256_BLOCK_LENGTH];
+#endif
+};
+
+/// HMAC-SHA256 context, no heap memory and no shared state
+struct rtmp_hmac_sha256_t
+{
+	struct rtmp_sha256_t inner;
+	struct rtmp_sha256_t outer;
+};
+
+void rtmp_sha256_init(struct rtmp_sha256_t* sha);
+void rtmp_sha256_update(struct rtmp_sha256_t* sha, const void* data, size_t bytes);
+void rtmp_sha256_final(struct rtmp_sha256_t* sha, uint8_t digest[RTMP_SHA256_DIGEST_LENGTH]);
+
+void rtmp_hmac_sha256_init(struct rtmp_hmac_sha256_t* hmac, const uint8_t* key, size_t len);
+void rtmp_hmac_sha256_update(struct rtmp_hmac_sha256_t* hmac, const void* data, size_t bytes);
+void rtmp_hmac_sha256_final(struct rtmp_hmac_sha256_t* hmac, uint8_t digest[RTMP_SHA256_DIGEST_LENGTH]);
+
+#if defined(__cplusplus)
+}
+#endif
+#endif /* !_rtmp_sha256_h_ */
@@ -7,39 +7,6 @@
 
 #define MIN(x, y) ((x) < (y) ? (x) : (y))
 
-static struct rtmp_packet_t* rtmp_packet_find(struct rtmp_t* rtmp, uint32_t cid)
-{
-	uint32_t i;
-	struct rtmp_packet_t* pkt;
-
-	// The protocol supports up to 65597 streams with IDs 3-65599
-	assert(cid <= 65535 + 64 && cid >= 2 /* Protocol Control Messages */);
-	for (i = 0; i < N_CHUNK_STREAM; i++)
-	{
-		pkt = rtmp->in_packets + ((i + cid) % N_CHUNK_STREAM);
-		if (pkt->header.cid == cid)
-			return pkt;
-	}
-	return NULL;
-}
-
-static struct rtmp_packet_t* rtmp_packet_create(struct rtmp_t* rtmp, uint32_t cid)
-{
-	uint32_t i;
-	struct rtmp_packet_t* pkt;
-
-	// The protocol supports up to 65597 streams with IDs 3-65599
-	assert(cid <= 65535 + 64 && cid >= 2 /* Protocol Control Messages */);
-	assert(NULL == rtmp_packet_find(rtmp, cid));
-	for (i = 0; i < N_CHUNK_STREAM; i++)
-	{
-		pkt = rtmp->in_packets + ((i + cid) % N_CHUNK_STREAM);
-		if (0 == pkt->header.cid)
-			return pkt;
-	}
-	return NULL;
-}
-
 static struct rtmp_packet_t* rtmp_packet_parse(struct rtmp_t* rtmp, const uint8_t* buffer)
 {
 	uint8_t fmt = 0;
@@ -50,13 +17,13 @@ static struct rtmp_packet_t* rtmp_packet_parse(struct rtmp_t* rtmp, const uint8_
 	buffer += rtmp_chunk_basic_header_read(buffer, &fmt, &cid);
 
 	// load previous header
-	packet = rtmp_packet_find(rtmp, cid);
+	packet = rtmp_packets_find(&rtmp->in_packets, cid, 0);
 	if (NULL == packet)
 	{
 		if (RTMP_CHUNK_TYPE_0 != fmt && RTMP_CHUNK_TYPE_1 != fmt)
 			return NULL; // don't know stream length
 
-		packet = rtmp_packet_create(rtmp, cid);
+		packet = rtmp_packets_find(&rtmp->in_packets, cid, 1);
 		if (NULL == packet)
 			return NULL;
 	}
@@ -71,34 +38,119 @@ static struct rtmp_packet_t* rtmp_packet_parse(struct rtmp_t* rtmp, const uint8_
 
 static int rtmp_packet_alloc(struct rtmp_t* rtmp, struct rtmp_packet_t* packet)
 {
-	void* p;
 	(void)rtmp;
 
 	// 24-bytes length
 	assert(0 == packet->bytes);
 	assert(packet->header.length < (1 << 24));
 	// fixed SMS (Chinacache Smart Media Server) packet->header.length = 0
-	if (0 == packet->capacity || packet->capacity < packet->header.length)
+	if (NULL == packet->payload || packet->capacity < packet->header.length)
 	{
-		p = realloc(packet->payload, packet->header.length + 1024);
-		if (NULL == p)
+		if (packet->payload)
+			rtmp_pool_free(packet->payload, packet->capacity);
+		packet->payload = (uint8_t*)rtmp_pool_alloc(packet->header.length, &packet->capacity);
+		if (NULL == packet->payload)
+		{
+			packet->capacity = 0;
 			return ENOMEM;
-		packet->payload = p;
-		packet->capacity = packet->header.length + 1024;
+		}
 	}
 
 	return 0;
 }
 
-int rtmp_chunk_read(struct rtmp_t* rtmp, const uint8_t* data, size_t bytes)
+static const uint32_t s_header_size[] = { 11, 7, 3, 0 };
+
+/// first chunk of message, handle timestamp/delta
+static void rtmp_packet_timestamp(struct rtmp_packet_t* pkt, uint32_t extended_timestamp)
+{
+	assert(0 == pkt->bytes);
+	pkt->delta = extended_timestamp;
+
+	if (RTMP_CHUNK_TYPE_0 == pkt->header.fmt)
+		pkt->clock = pkt->delta;
+	else
+		pkt->clock += pkt->delta;
+}
+
+static int rtmp_packet_dispatch(struct rtmp_t* rtmp, struct rtmp_packet_t* pkt, const uint8_t* payload)
+{
+	int r;
+	struct rtmp_chunk_header_t header;
+
+	memcpy(&header, &pkt->header, sizeof(header));
+	header.timestamp = pkt->clock;
+	r = rtmp_handler(rtmp, &header, payload);
+
+	// return payload buffer to pool, memory per in-flight message only
+	if (pkt->payload)
+	{
+		rtmp_pool_free(pkt->payload, pkt->capacity);
+		pkt->payload = NULL;
+		pkt->capacity = 0;
+	}
+	return r;
+}
+
+/// fast path: complete chunk header(bytes >= MAX_CHUNK_HEADER) in one step
+/// @param[out] consumed header(and single chunk message) bytes
+/// @return 0-ok, other-error
+static int rtmp_chunk_read_fast(struct rtmp_t* rtmp, const uint8_t* data, size_t bytes, size_t* consumed)
 {
-	const static uint32_t s_header_size[] = { 11, 7, 3, 0 };
+	uint32_t size, extended_timestamp;
+	struct rtmp_packet_t* pkt;
+	struct rtmp_parser_t* parser = &rtmp->parser;
+
+	assert(bytes >= MAX_CHUNK_HEADER && RTMP_PARSE_INIT == parser->state);
+	if (0 == (data[0] & 0x3F))
+		parser->basic_bytes = 2;
+	else if (1 == (data[0] & 0x3F))
+		parser->basic_bytes = 3;
+	else
+		parser->basic_bytes = 1;
+
+	size = s_header_size[data[0] >> 6] + parser->basic_bytes;
+	pkt = rtmp_packet_parse(rtmp, data);
+	if (NULL == pkt)
+		return ENOMEM;
+
+	extended_timestamp = pkt->header.timestamp;
+	if (pkt->header.timestamp == 0xFFFFFF)
+	{
+		// parse extended timestamp
+		rtmp_chunk_extended_timestamp_read(data + size, &extended_timestamp);
+		if (RTMP_CHUNK_TYPE_3 != pkt->header.fmt || extended_timestamp == pkt->delta)
+			size += 4;
+	}
 
+	// single chunk message in buffer: dispatch without copy
+	if (0 == pkt->bytes && pkt->header.length <= rtmp->in_chunk_size && pkt->header.length <= bytes - size)
+	{
+		rtmp_packet_timestamp(pkt, extended_timestamp);
+		*consumed = size + pkt->header.length;
+		return rtmp_packet_dispatch(rtmp, pkt, data + size);
+	}
+
+	// first chunk
+	if (0 == pkt->bytes)
+	{
+		rtmp_packet_timestamp(pkt, extended_timestamp);
+		if (0 != rtmp_packet_alloc(rtmp, pkt))
+			return ENOMEM;
+	}
+
+	*consumed = size;
+	parser->pkt = pkt;
+	parser->state = RTMP_PARSE_PAYLOAD;
+	return 0;
+}
+
+int rtmp_chunk_read(struct rtmp_t* rtmp, const uint8_t* data, size_t bytes)
+{
 	int r;
 	size_t size, offset = 0;
 	uint32_t extended_timestamp = 0;
 	struct rtmp_parser_t* parser = &rtmp->parser;
-	struct rtmp_chunk_header_t header;
 
 	while (offset < bytes)
 	{
@@ -106,6 +158,15 @@ int rtmp_chunk_read(struct rtmp_t* rtmp, const uint8_t* data, size_t bytes)
 		{
 		case RTMP_PARSE_INIT:
 			parser->pkt = NULL;
+			if (bytes - offset >= MAX_CHUNK_HEADER)
+			{
+				size = 0;
+				r = rtmp_chunk_read_fast(rtmp, data + offset, bytes - offset, &size);
+				offset += size;
+				if (0 != r) return r;
+				break;
+			}
+
 			parser->bytes = 1;
 			parser->buffer[0] = data[offset++];
 
@@ -177,14 +238,7 @@ int rtmp_chunk_read(struct rtmp_t* rtmp, const uint8_t* data, size_t bytes)
 				// first chunk
 				if (0 == parser->pkt->bytes)
 				{
-					parser->pkt->delta = extended_timestamp;
-
-					// handle timestamp/delta
-					if (RTMP_CHUNK_TYPE_0 == parser->pkt->header.fmt)
-						parser->pkt->clock = parser->pkt->delta;
-					else
-						parser->pkt->clock += parser->pkt->delta;
-
+					rtmp_packet_timestamp(parser->pkt, extended_timestamp);
 					if (0 != rtmp_packet_alloc(rtmp, parser->pkt))
 						return ENOMEM;
 				}
@@ -215,9 +269,7 @@ int rtmp_chunk_read(struct rtmp_t* rtmp, const uint8_t* data, size_t bytes)
 				parser->state = RTMP_PARSE_INIT; // reset parser state
 				parser->pkt->bytes = 0; // clear bytes
 
-				memcpy(&header, &parser->pkt->header, sizeof(header));
-				header.timestamp = parser->pkt->clock;
-				r = rtmp_handler(rtmp, &header, parser->pkt->payload);
+				r = rtmp_packet_dispatch(rtmp, parser->pkt, parser->pkt->payload);
 				if(0 != r) return r;
 			}
 			else if (0 == (parser->pkt->bytes % rtmp->in_chunk_size))
@@ -1,5 +1,6 @@
 #include "rtmp-chunk-header.h"
 #include "rtmp-internal.h"
+#include "rtmp-msgtypeid.h"
 #include "rtmp-util.h"
 #include <string.h>
 #include <assert.h>
@@ -9,41 +10,9 @@
 /* 3-bytes basic header + 11-bytes message header + 4-bytes extended timestamp */
 //#define MAX_CHUNK_HEADER 18
 
-static struct rtmp_packet_t* rtmp_packet_find(struct rtmp_t* rtmp, uint32_t cid)
-{
-	uint32_t i;
-	struct rtmp_packet_t* pkt;
-
-	// The protocol supports up to 65597 streams with IDs 3-65599
-	assert(cid <= 65535 + 64 && cid >= 2 /* Protocol Control Messages */);
-	for (i = 0; i < N_CHUNK_STREAM; i++)
-	{
-		pkt = rtmp->out_packets + ((i + cid) % N_CHUNK_STREAM);
-		if (pkt->header.cid == cid)
-			return pkt;
-	}
-	return NULL;
-}
-
-//static struct rtmp_packet_t* rtmp_packet_create(struct rtmp_t* rtmp, uint32_t cid)
-//{
-//	uint32_t i;
-//	struct rtmp_packet_t* pkt;
-//
-//	// The protocol supports up to 65597 streams with IDs 3-65599
-//	assert(cid <= 65535 + 64 && cid >= 2 /* Protocol Control Messages */);
-//	assert(NULL == rtmp_packet_find(rtmp, cid));
-//	for (i = 0; i < N_CHUNK_STREAM; i++)
-//	{
-//		pkt = rtmp->out_packets + ((i + cid) % N_CHUNK_STREAM);
-//		if (0 == pkt->header.cid)
-//			return pkt;
-//	}
-//	return NULL;
-//}
-
 static const struct rtmp_chunk_header_t* rtmp_chunk_header_zip(struct rtmp_t* rtmp, const struct rtmp_chunk_header_t* header)
 {
+	int first;
 	struct rtmp_packet_t* pkt; // previous saved chunk header
 	struct rtmp_chunk_header_t h;
 
@@ -53,19 +22,19 @@ static const struct rtmp_chunk_header_t* rtmp_chunk_header_zip(struct rtmp_t* rt
 	memcpy(&h, header, sizeof(h));
 
 	// find previous chunk header
-	pkt = rtmp_packet_find(rtmp, h.cid);
+	first = 0;
+	pkt = rtmp_packets_find(&rtmp->out_packets, h.cid, 0);
 	if (NULL == pkt)
 	{
-		//pkt = rtmp_packet_create(rtmp, h.cid);
-		//if (NULL == pkt)
-		//	return NULL; // too many chunk stream id
-		assert(0);
-		return NULL; // can't find chunk stream id 
+		first = 1; // new chunk stream, full header
+		pkt = rtmp_packets_find(&rtmp->out_packets, h.cid, 1);
+		if (NULL == pkt)
+			return NULL; // no memory
 	}
 
 	h.fmt = RTMP_CHUNK_TYPE_0;
 	if (RTMP_CHUNK_TYPE_0 != header->fmt /* enable compress */
-		&& header->cid == pkt->header.cid /* not the first packet */
+		&& 0 == first /* not the first packet */
 		&& header->timestamp >= pkt->clock /* timestamp wrap */
 		&& header->timestamp - pkt->clock < 0xFFFFFF /* timestamp delta < 1 << 24 */
 		&& header->stream_id == pkt->header.stream_id /* message stream id */)
@@ -86,17 +55,56 @@ static const struct rtmp_chunk_header_t* rtmp_chunk_header_zip(struct rtmp_t* rt
 	return &pkt->header;
 }
 
-int rtmp_chunk_write(struct rtmp_t* rtmp, const struct rtmp_chunk_header_t* h, const uint8_t* payload)
+static int rtmp_chunk_writev(struct rtmp_t* rtmp, const struct rtmp_chunk_header_t* header, const uint8_t* payload)
+{
+	int r, n;
+	uint32_t chunkSize, payloadSize;
+	uint8_t p[N_CHUNK_VEC][MAX_CHUNK_HEADER];
+	struct rtmp_iovec_t vec[N_CHUNK_VEC * 2];
+
+	r = 0;
+	payloadSize = header->length;
+	while (payloadSize > 0 && 0 == r)
+	{
+		for (n = 0; n < N_CHUNK_VEC && payloadSize > 0; n++)
+		{
+			if (payloadSize == header->length)
+			{
+				vec[2 * n].len = rtmp_chunk_basic_header_write(p[n], header->fmt, header->cid);
+				vec[2 * n].len += rtmp_chunk_message_header_write(p[n] + vec[2 * n].len, header);
+			}
+			else
+			{
+				vec[2 * n].len = rtmp_chunk_basic_header_write(p[n], RTMP_CHUNK_TYPE_3, header->cid);
+			}
+			if (header->timestamp >= 0xFFFFFF)
+				vec[2 * n].len += rtmp_chunk_extended_timestamp_write(p[n] + vec[2 * n].len, header->timestamp);
+			vec[2 * n].base = p[n];
+
+			chunkSize = payloadSize < rtmp->out_chunk_size ? payloadSize : rtmp->out_chunk_size;
+			vec[2 * n + 1].base = payload;
+			vec[2 * n + 1].len = chunkSize;
+
+			payload += chunkSize;
+			payloadSize -= chunkSize;
+		}
+
+		r = rtmp->sendv(rtmp->param, vec, n * 2); // callback
+	}
+
+	return r;
+}
+
+static int rtmp_chunk_write_zipped(struct rtmp_t* rtmp, const struct rtmp_chunk_header_t* header, const uint8_t* payload)
 {
 	int r = 0;
 	uint8_t p[MAX_CHUNK_HEADER];
 	uint32_t chunkSize, headerSize, payloadSize;
-	const struct rtmp_chunk_header_t* header;
 
-	// compression rtmp chunk header
-	header = rtmp_chunk_header_zip(rtmp, h);
-	if (!header || header->length >= 0xFFFFFF)
-		return -EINVAL; // invalid length
+	// scatter-gather: all chunks of the message with one callback,
+	// audio/video only, other payloads(command/control) are transient
+	if (rtmp->sendv && header->length > 0 && (RTMP_TYPE_AUDIO == header->type || RTMP_TYPE_VIDEO == header->type))
+		return rtmp_chunk_writev(rtmp, header, payload);
 
 	payloadSize = header->length;
 	headerSize = rtmp_chunk_basic_header_write(p, header->fmt, header->cid);
@@ -122,3 +130,38 @@ int rtmp_chunk_write(struct rtmp_t* rtmp, const struct rtmp_chunk_header_t* h, c
 
 	return r;
 }
+
+int rtmp_chunk_write(struct rtmp_t* rtmp, const struct rtmp_chunk_header_t* h, const uint8_t* payload)
+{
+	const struct rtmp_chunk_header_t* header;
+
+	// compression rtmp chunk header
+	header = rtmp_chunk_header_zip(rtmp, h);
+	if (!header || header->length >= 0xFFFFFF)
+		return -EINVAL; // invalid length
+
+	return rtmp_chunk_write_zipped(rtmp, header, payload);
+}
+
+int rtmp_chunk_write_prepared(struct rtmp_t* rtmp, const struct rtmp_chunk_header_t* h, struct rtmp_prepared_t* msg)
+{
+	uint8_t p[MAX_CHUNK_HEADER];
+	uint32_t headerSize;
+	const struct rtmp_chunk_header_t* header;
+
+	assert(h->length == msg->bytes && h->cid == msg->cid);
+	header = rtmp_chunk_header_zip(rtmp, h);
+	if (!header || header->length >= 0xFFFFFF)
+		return -EINVAL; // invalid length
+
+	// the shared body has neither extended timestamp nor other chunk size
+	if (0 == header->length || header->timestamp >= 0xFFFFFF || msg->chunk_size != rtmp->out_chunk_size)
+		return rtmp_chunk_write_zipped(rtmp, header, msg->payload);
+
+	// per-session first chunk header + shared chunked body
+	headerSize = rtmp_chunk_basic_header_write(p, header->fmt, header->cid);
+	headerSize += rtmp_chunk_message_header_write(p + headerSize, header);
+	if (rtmp->sendprepared)
+		return rtmp->sendprepared(rtmp->param, p, headerSize, msg); // callback
+	return rtmp->send(rtmp->param, p, headerSize, msg->body, (uint32_t)msg->size); // callback
+}
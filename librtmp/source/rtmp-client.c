@@ -331,6 +331,18 @@ static int rtmp_client_send(void* param, const uint8_t* header, uint32_t headerB
 	return (r == (int)(payloadBytes + headerBytes)) ? 0 : -1;
 }
 
+static int rtmp_client_sendv(void* param, const struct rtmp_iovec_t* vec, int n)
+{
+	int i, r;
+	size_t bytes;
+	struct rtmp_client_t* ctx;
+	ctx = (struct rtmp_client_t*)param;
+	for (bytes = i = 0; i < n; i++)
+		bytes += vec[i].len;
+	r = ctx->handler.sendv(ctx->param, vec, n);
+	return (r == (int)bytes) ? 0 : -1;
+}
+
 struct rtmp_client_t* rtmp_client_create(const char* appname, const char* playpath, const char* tcurl, void* param, const struct rtmp_client_handler_t* handler)
 {
 	struct rtmp_client_t* ctx;
@@ -354,6 +366,7 @@ struct rtmp_client_t* rtmp_client_create(const char* appname, const char* playpa
 
 	ctx->rtmp.param = ctx;
 	ctx->rtmp.send = rtmp_client_send;
+	ctx->rtmp.sendv = ctx->handler.sendv ? rtmp_client_sendv : NULL;
 	ctx->rtmp.onaudio = rtmp_client_onaudio;
 	ctx->rtmp.onvideo = rtmp_client_onvideo;
 	ctx->rtmp.onabort = rtmp_client_onabort;
@@ -377,30 +390,18 @@ struct rtmp_client_t* rtmp_client_create(const char* appname, const char* playpa
 	ctx->connect.videoFunction = SUPPORT_VID_CLIENT_SEEK;
 	ctx->connect.encoding = RTMP_ENCODING_AMF_0;
 
-	ctx->rtmp.out_packets[RTMP_CHANNEL_PROTOCOL].header.cid = RTMP_CHANNEL_PROTOCOL;
-	ctx->rtmp.out_packets[RTMP_CHANNEL_INVOKE].header.cid = RTMP_CHANNEL_INVOKE;
-	ctx->rtmp.out_packets[RTMP_CHANNEL_AUDIO].header.cid = RTMP_CHANNEL_AUDIO;
-	ctx->rtmp.out_packets[RTMP_CHANNEL_VIDEO].header.cid = RTMP_CHANNEL_VIDEO;
-	ctx->rtmp.out_packets[RTMP_CHANNEL_DATA].header.cid = RTMP_CHANNEL_DATA;
+	rtmp_packets_find(&ctx->rtmp.out_packets, RTMP_CHANNEL_PROTOCOL, 1);
+	rtmp_packets_find(&ctx->rtmp.out_packets, RTMP_CHANNEL_INVOKE, 1);
+	rtmp_packets_find(&ctx->rtmp.out_packets, RTMP_CHANNEL_AUDIO, 1);
+	rtmp_packets_find(&ctx->rtmp.out_packets, RTMP_CHANNEL_VIDEO, 1);
+	rtmp_packets_find(&ctx->rtmp.out_packets, RTMP_CHANNEL_DATA, 1);
 	return ctx;
 }
 
 void rtmp_client_destroy(struct rtmp_client_t* ctx)
 {
-	size_t i;
-	assert(sizeof(ctx->rtmp.in_packets) == sizeof(ctx->rtmp.out_packets));
-	for (i = 0; i < N_CHUNK_STREAM; i++)
-	{
-		assert(NULL == ctx->rtmp.out_packets[i].payload);
-		if (ctx->rtmp.in_packets[i].payload)
-		{
-#if defined(DEBUG) || defined(_DEBUG)
-			memset(ctx->rtmp.in_packets[i].payload, 0xCC, ctx->rtmp.in_packets[i].capacity);
-#endif
-			free(ctx->rtmp.in_packets[i].payload);
-			ctx->rtmp.in_packets[i].payload = NULL;
-		}
-	}
+	rtmp_packets_free(&ctx->rtmp.in_packets);
+	rtmp_packets_free(&ctx->rtmp.out_packets);
 
 #if defined(DEBUG) || defined(_DEBUG)
 	memset(ctx, 0xCC, sizeof(*ctx));
@@ -502,15 +503,15 @@ int rtmp_client_stop(struct rtmp_client_t* ctx)
 
 int rtmp_client_pause(struct rtmp_client_t* ctx, int pause)
 {
-	int r, i;
+	int r;
+	uint32_t i;
 	uint32_t timestamp = 0;
+	struct rtmp_packet_t* pkt;
 
-	for (i = 0; i < N_CHUNK_STREAM; i++)
+	for (i = 0; NULL != (pkt = rtmp_packets_next(&ctx->rtmp.in_packets, &i));)
 	{
-		if(0 == ctx->rtmp.in_packets[i].header.cid)
-			continue;
-		if (timestamp < ctx->rtmp.in_packets[i].header.timestamp)
-			timestamp = ctx->rtmp.in_packets[i].header.timestamp;
+		if (timestamp < pkt->header.timestamp)
+			timestamp = pkt->header.timestamp;
 	}
 
 	r = (int)(rtmp_netstream_pause(ctx->payload, sizeof(ctx->payload), 0, pause, timestamp) - ctx->payload);
@@ -1,17 +1,12 @@
 #include "rtmp-handshake.h"
 #include "rtmp-util.h"
+#include "rtmp-sha256.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <math.h>
 
-#if defined(_OPENSSL_)
-#include <openssl/sha.h>
-#include <openssl/hmac.h>
-#define _FLASH_HANDSHAKE_
-#elif defined(_IETF_HMAC_)
-#include "sha.h"
-#define SHA256_DIGEST_LENGTH SHA256HashSize
+#if !defined(_RTMP_SIMPLE_HANDSHAKE_)
 #define _FLASH_HANDSHAKE_
 #endif
 
@@ -47,58 +42,25 @@ static const uint8_t rtmp_client_version[] = {
 	0x0C, 0x00, 0x0D, 0x0E
 };
 
-#if defined(_OPENSSL_)
-static int rtmp_handshake_make_digest(const uint8_t* key, size_t len, const uint8_t* ptr, size_t ptrlen, const uint8_t* digest, uint8_t* dst)
-{
-	static HMAC_CTX        *hmac;
-	unsigned int            digestlen;
-
-	if (hmac == NULL) {
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-		static HMAC_CTX  shmac;
-		hmac = &shmac;
-		HMAC_CTX_init(hmac);
-#else
-		hmac = HMAC_CTX_new();
-#endif
-	}
-
-	HMAC_Init_ex(hmac, key, len, EVP_sha256(), NULL);
-	if (digest)
-	{
-		assert(digest + SHA256_DIGEST_LENGTH <= ptr + ptrlen);
-		HMAC_Update(hmac, ptr, digest - ptr);
-		if (digest + SHA256_DIGEST_LENGTH < ptr + ptrlen)
-			HMAC_Update(hmac, digest + SHA256_DIGEST_LENGTH, ptrlen - (digest - ptr) - SHA256_DIGEST_LENGTH);
-	}
-	else
-	{
-		HMAC_Update(hmac, ptr, ptrlen);
-	}
-	HMAC_Final(hmac, dst, &digestlen);
-	assert(digestlen == SHA256_DIGEST_LENGTH);
-	return 0;
-}
-#else
+// per-call HMAC context, safe to run handshakes on multiple threads
 static int rtmp_handshake_make_digest(const uint8_t* key, size_t len, const uint8_t* ptr, size_t ptrlen, const uint8_t* digest, uint8_t* dst)
 {
-	HMACContext hmac;
-	hmacReset(&hmac, SHA256, key, len);
+	struct rtmp_hmac_sha256_t hmac;
+	rtmp_hmac_sha256_init(&hmac, key, len);
 	if (digest)
 	{
-		assert(digest + SHA256_DIGEST_LENGTH <= ptr + ptrlen);
-		hmacInput(&hmac, ptr, digest - ptr);
-		if (digest + SHA256_DIGEST_LENGTH < ptr + ptrlen)
-			hmacInput(&hmac, digest + SHA256_DIGEST_LENGTH, ptrlen - (digest - ptr) - SHA256_DIGEST_LENGTH);
+		assert(digest + RTMP_SHA256_DIGEST_LENGTH <= ptr + ptrlen);
+		rtmp_hmac_sha256_update(&hmac, ptr, digest - ptr);
+		if (digest + RTMP_SHA256_DIGEST_LENGTH < ptr + ptrlen)
+			rtmp_hmac_sha256_update(&hmac, digest + RTMP_SHA256_DIGEST_LENGTH, ptrlen - (digest - ptr) - RTMP_SHA256_DIGEST_LENGTH);
 	}
 	else
 	{
-		hmacInput(&hmac, ptr, ptrlen);
+		rtmp_hmac_sha256_update(&hmac, ptr, ptrlen);
 	}
-	hmacResult(&hmac, dst);
+	rtmp_hmac_sha256_final(&hmac, dst);
 	return 0;
 }
-#endif
 
 /*
 // http://blog.csdn.net/win_lin/article/details/13006803
@@ -117,7 +79,7 @@ random-data: (764-4-offset-32)bytes
 static const uint8_t* rtmp_handshake_find_digest(const uint8_t* handshake, size_t offset, const uint8_t* key, size_t len)
 {
 	uint32_t bytes;
-	uint8_t digest[SHA256_DIGEST_LENGTH];
+	uint8_t digest[RTMP_SHA256_DIGEST_LENGTH];
 
 	bytes = handshake[offset + 0];
 	bytes += handshake[offset + 1];
@@ -126,12 +88,12 @@ static const uint8_t* rtmp_handshake_find_digest(const uint8_t* handshake, size_
 	bytes %= 728;/*764 - 4bytesoffset - 32bytesdigest*/
 
 	rtmp_handshake_make_digest(key, len, handshake, RTMP_HANDSHAKE_SIZE, handshake + offset + 4 + bytes, digest);
-	if (0 == memcmp(digest, handshake + offset + 4 + bytes, SHA256_DIGEST_LENGTH))
+	if (0 == memcmp(digest, handshake + offset + 4 + bytes, RTMP_SHA256_DIGEST_LENGTH))
 		return handshake + offset + 4 + bytes;
 	return NULL;
 }
 
-static int rtmp_handshake_parse_challenge(const uint8_t* handshake, const uint8_t* key, size_t len, uint8_t digest[SHA256_DIGEST_LENGTH])
+static int rtmp_handshake_parse_challenge(const uint8_t* handshake, const uint8_t* key, size_t len, uint8_t digest[RTMP_SHA256_DIGEST_LENGTH])
 {
 	uint32_t epoch;
 	uint32_t version;
@@ -151,7 +113,7 @@ static int rtmp_handshake_parse_challenge(const uint8_t* handshake, const uint8_
 		p = rtmp_handshake_find_digest(handshake, 8, key, len);
 
 	if (p)
-		memcpy(digest, p, SHA256_DIGEST_LENGTH);
+		memcpy(digest, p, RTMP_SHA256_DIGEST_LENGTH);
 	return p ? 1 : 0;
 }
 
@@ -171,9 +133,9 @@ static int rtmp_handshake_create_challenge(uint8_t* handshake, const uint8_t* ke
 
 static int rtmp_handshake_create_response(uint8_t* handshake, const uint8_t* key, size_t len)
 {
-	uint8_t digest[SHA256_DIGEST_LENGTH];
-	rtmp_handshake_make_digest(key, len, handshake, RTMP_HANDSHAKE_SIZE - SHA256_DIGEST_LENGTH, NULL, digest);
-	memcpy(handshake + RTMP_HANDSHAKE_SIZE - SHA256_DIGEST_LENGTH, digest, SHA256_DIGEST_LENGTH);
+	uint8_t digest[RTMP_SHA256_DIGEST_LENGTH];
+	rtmp_handshake_make_digest(key, len, handshake, RTMP_HANDSHAKE_SIZE - RTMP_SHA256_DIGEST_LENGTH, NULL, digest);
+	memcpy(handshake + RTMP_HANDSHAKE_SIZE - RTMP_SHA256_DIGEST_LENGTH, digest, RTMP_SHA256_DIGEST_LENGTH);
 	return 0;
 }
 
@@ -182,11 +144,16 @@ static int rtmp_handshake_create_response(uint8_t* handshake, const uint8_t* key
 static void rtmp_handshake_random(uint8_t* p, uint32_t timestamp)
 {
 	int i;
-	
-	srand(timestamp);
+	uint32_t seed;
+
+	// xorshift32, srand/rand share one global state between threads
+	seed = (timestamp ^ (uint32_t)(uintptr_t)p) | 1;
 	for (i = 0; i * 4 < RTMP_HANDSHAKE_SIZE - 8; i++)
 	{
-		*((int*)p + i) = rand();
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		be_write_uint32(p + i * 4, seed);
 	}
 }
 
@@ -214,13 +181,13 @@ int rtmp_handshake_c1(uint8_t* c1, uint32_t timestamp)
 int rtmp_handshake_c2(uint8_t* c2, uint32_t timestamp, const uint8_t* s1, size_t bytes)
 {
 #if defined(_FLASH_HANDSHAKE_)
-	uint8_t digest[SHA256_DIGEST_LENGTH];
+	uint8_t digest[RTMP_SHA256_DIGEST_LENGTH];
 	assert(RTMP_HANDSHAKE_SIZE == bytes);
 	if (1 == rtmp_handshake_parse_challenge(s1, rtmp_server_key, 36, digest))
 	{
-		rtmp_handshake_make_digest(rtmp_client_key, sizeof(rtmp_client_key), digest, SHA256_DIGEST_LENGTH, NULL, digest);
+		rtmp_handshake_make_digest(rtmp_client_key, sizeof(rtmp_client_key), digest, RTMP_SHA256_DIGEST_LENGTH, NULL, digest);
 		rtmp_handshake_random(c2, timestamp);
-		rtmp_handshake_create_response(c2, digest, SHA256_DIGEST_LENGTH);
+		rtmp_handshake_create_response(c2, digest, RTMP_SHA256_DIGEST_LENGTH);
 	}
 	else
 	{
@@ -259,13 +226,13 @@ int rtmp_handshake_s1(uint8_t* s1, uint32_t timestamp)
 int rtmp_handshake_s2(uint8_t* s2, uint32_t timestamp, const uint8_t* c1, size_t bytes)
 {
 #if defined(_FLASH_HANDSHAKE_)
-	uint8_t digest[SHA256_DIGEST_LENGTH];
+	uint8_t digest[RTMP_SHA256_DIGEST_LENGTH];
 	assert(RTMP_HANDSHAKE_SIZE == bytes);
 	if (1 == rtmp_handshake_parse_challenge(c1, rtmp_client_key, 30, digest))
 	{
-		rtmp_handshake_make_digest(rtmp_server_key, sizeof(rtmp_server_key), digest, SHA256_DIGEST_LENGTH, NULL, digest);
+		rtmp_handshake_make_digest(rtmp_server_key, sizeof(rtmp_server_key), digest, RTMP_SHA256_DIGEST_LENGTH, NULL, digest);
 		rtmp_handshake_random(s2, timestamp);
-		rtmp_handshake_create_response(s2, digest, SHA256_DIGEST_LENGTH);
+		rtmp_handshake_create_response(s2, digest, RTMP_SHA256_DIGEST_LENGTH);
 	}
 	else
 	{
@@ -0,0 +1,143 @@
+#include "rtmp-internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static inline uint32_t rtmp_packets_capacity(const struct rtmp_packets_t* packets)
+{
+	return packets->capacity ? packets->capacity : N_CHUNK_STREAM;
+}
+
+static inline struct rtmp_packet_t* rtmp_packets_table(struct rtmp_packets_t* packets)
+{
+	return packets->table ? packets->table : packets->packets;
+}
+
+static int rtmp_packets_grow(struct rtmp_packets_t* packets)
+{
+	uint32_t i, j, n, capacity;
+	struct rtmp_packet_t* table;
+	struct rtmp_packet_t* pkt;
+
+	capacity = rtmp_packets_capacity(packets);
+	n = capacity * 2;
+	table = (struct rtmp_packet_t*)calloc(n, sizeof(struct rtmp_packet_t));
+	if (NULL == table)
+		return -1;
+
+	// rehash
+	pkt = rtmp_packets_table(packets);
+	for (i = 0; i < capacity; i++)
+	{
+		if (0 == pkt[i].header.cid)
+			continue;
+
+		j = pkt[i].header.cid & (n - 1);
+		while (0 != table[j].header.cid)
+			j = (j + 1) & (n - 1);
+		memcpy(table + j, pkt + i, sizeof(struct rtmp_packet_t));
+	}
+
+	if (packets->table)
+		free(packets->table);
+	else
+		memset(packets->packets, 0, sizeof(packets->packets));
+
+	packets->table = table;
+	packets->capacity = n;
+	return 0;
+}
+
+struct rtmp_packet_t* rtmp_packets_find(struct rtmp_packets_t* packets, uint32_t cid, int create)
+{
+	uint32_t i, capacity;
+	struct rtmp_packet_t* table;
+	struct rtmp_packet_t* pkt;
+
+	// The protocol supports up to 65597 streams with IDs 3-65599
+	assert(cid <= 65535 + 64 && cid >= 2 /* Protocol Control Messages */);
+	capacity = rtmp_packets_capacity(packets);
+	table = rtmp_packets_table(packets);
+	for (i = 0; i < capacity; i++)
+	{
+		pkt = table + ((cid + i) & (capacity - 1));
+		if (pkt->header.cid == cid)
+			return pkt;
+		if (0 == pkt->header.cid)
+			break; // never removed, stop at empty slot
+	}
+
+	if (!create)
+		return NULL;
+
+	// limit peer chunk streams, the reader fails the connection
+	if (packets->count >= N_CHUNK_STREAM_MAX)
+		return NULL;
+
+	// keep load factor <= 3/4, create is rare(once per chunk stream)
+	if ((packets->count + 1) * 4 > capacity * 3)
+	{
+		if (0 != rtmp_packets_grow(packets))
+			return NULL;
+		capacity = rtmp_packets_capacity(packets);
+		table = rtmp_packets_table(packets);
+	}
+
+	for (i = 0; i < capacity; i++)
+	{
+		pkt = table + ((cid + i) & (capacity - 1));
+		if (0 == pkt->header.cid)
+		{
+			memset(pkt, 0, sizeof(*pkt));
+			pkt->header.cid = cid;
+			packets->count++;
+			return pkt;
+		}
+	}
+
+	assert(0);
+	return NULL;
+}
+
+struct rtmp_packet_t* rtmp_packets_next(struct rtmp_packets_t* packets, uint32_t* index)
+{
+	uint32_t capacity;
+	struct rtmp_packet_t* table;
+
+	capacity = rtmp_packets_capacity(packets);
+	table = rtmp_packets_table(packets);
+	while (*index < capacity)
+	{
+		if (0 != table[*index].header.cid)
+			return table + (*index)++;
+		++*index;
+	}
+	return NULL;
+}
+
+void rtmp_packets_free(struct rtmp_packets_t* packets)
+{
+	uint32_t i, capacity;
+	struct rtmp_packet_t* table;
+
+	capacity = rtmp_packets_capacity(packets);
+	table = rtmp_packets_table(packets);
+	for (i = 0; i < capacity; i++)
+	{
+		if (table[i].payload)
+		{
+#if defined(DEBUG) || defined(_DEBUG)
+			memset(table[i].payload, 0xCC, table[i].capacity);
+#endif
+			rtmp_pool_free(table[i].payload, table[i].capacity);
+			table[i].payload = NULL;
+			table[i].capacity = 0;
+		}
+	}
+
+	if (packets->table)
+		free(packets->table);
+	packets->table = NULL;
+	packets->capacity = 0;
+	packets->count = 0;
+}
@@ -0,0 +1,84 @@
+#include "rtmp-internal.h"
+#include "rtmp-atomic.h"
+#include <stdlib.h>
+#include <assert.h>
+
+#define N_POOL_CLASS_MIN	9 // 512 bytes
+#define N_POOL_CLASS_MAX	24 // 16MB, rtmp message length is 24-bits
+#define N_POOL_CLASS		(N_POOL_CLASS_MAX - N_POOL_CLASS_MIN + 1)
+
+#if !defined(RTMP_POOL_CACHE_BYTES)
+#define RTMP_POOL_CACHE_BYTES (8 * 1024 * 1024) // maximum cached bytes per class
+#endif
+
+struct rtmp_pool_node_t
+{
+	struct rtmp_pool_node_t* next;
+};
+
+struct rtmp_pool_class_t
+{
+	volatile long locker;
+	size_t count; // cached buffers
+	struct rtmp_pool_node_t* head;
+};
+
+// size-classed payload buffer pool, shared by all rtmp_t instances
+static struct rtmp_pool_class_t s_pool[N_POOL_CLASS];
+
+static int rtmp_pool_class(size_t bytes)
+{
+	int i = 0;
+	while (i < N_POOL_CLASS && ((size_t)1 << (i + N_POOL_CLASS_MIN)) < bytes)
+		i++;
+	return i;
+}
+
+void* rtmp_pool_alloc(size_t bytes, size_t* capacity)
+{
+	int i;
+	struct rtmp_pool_node_t* node;
+	struct rtmp_pool_class_t* pool;
+
+	i = rtmp_pool_class(bytes);
+	if (i >= N_POOL_CLASS)
+		return NULL; // too large
+
+	pool = &s_pool[i];
+	rtmp_spinlock_lock(&pool->locker);
+	node = pool->head;
+	if (node)
+	{
+		pool->head = node->next;
+		pool->count--;
+	}
+	rtmp_spinlock_unlock(&pool->locker);
+
+	*capacity = (size_t)1 << (i + N_POOL_CLASS_MIN);
+	return node ? (void*)node : malloc(*capacity);
+}
+
+void rtmp_pool_free(void* ptr, size_t capacity)
+{
+	int i;
+	struct rtmp_pool_node_t* node;
+	struct rtmp_pool_class_t* pool;
+
+	i = rtmp_pool_class(capacity);
+	assert(i < N_POOL_CLASS && ((size_t)1 << (i + N_POOL_CLASS_MIN)) == capacity);
+
+	node = (struct rtmp_pool_node_t*)ptr;
+	pool = &s_pool[i];
+	rtmp_spinlock_lock(&pool->locker);
+	if (pool->count * capacity < RTMP_POOL_CACHE_BYTES || 0 == pool->count)
+	{
+		node->next = pool->head;
+		pool->head = node;
+		pool->count++;
+		node = NULL;
+	}
+	rtmp_spinlock_unlock(&pool->locker);
+
+	if (node)
+		free(node); // pool is full
+}
@@ -0,0 +1,68 @@
+#include "rtmp-server.h"
+#include "rtmp-internal.h"
+#include "rtmp-msgtypeid.h"
+#include "rtmp-atomic.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+struct rtmp_prepared_t* rtmp_prepared_create(int type, const void* data, size_t bytes, uint32_t timestamp)
+{
+	uint8_t* p;
+	size_t i, n, chunk;
+	struct rtmp_prepared_t* msg;
+
+	if (bytes >= 0xFFFFFF)
+		return NULL; // invalid length
+
+	// type-3 basic header per chunk(except the first one)
+	n = bytes > 0 ? (bytes - 1) / RTMP_OUTPUT_CHUNK_SIZE : 0;
+	msg = (struct rtmp_prepared_t*)malloc(sizeof(*msg) + bytes * 2 + n);
+	if (!msg)
+		return NULL;
+
+	msg->ref = 1;
+	msg->type = (uint8_t)type;
+	msg->timestamp = timestamp;
+	msg->chunk_size = RTMP_OUTPUT_CHUNK_SIZE;
+	switch (type)
+	{
+	case RTMP_TYPE_AUDIO: msg->cid = RTMP_CHANNEL_AUDIO; break;
+	case RTMP_TYPE_VIDEO: msg->cid = RTMP_CHANNEL_VIDEO; break;
+	default: msg->cid = RTMP_CHANNEL_INVOKE; break; // same as rtmp_server_send_script
+	}
+
+	msg->bytes = bytes;
+	msg->payload = (uint8_t*)(msg + 1);
+	memcpy(msg->payload, data, bytes);
+
+	// chunk(0) + [type-3 basic header + chunk(n)]...
+	msg->body = msg->payload + bytes;
+	for (p = msg->body, i = 0; i < bytes; i += chunk)
+	{
+		if (i > 0)
+			p += rtmp_chunk_basic_header_write(p, RTMP_CHUNK_TYPE_3, msg->cid);
+		chunk = bytes - i < RTMP_OUTPUT_CHUNK_SIZE ? bytes - i : RTMP_OUTPUT_CHUNK_SIZE;
+		memcpy(p, msg->payload + i, chunk);
+		p += chunk;
+	}
+	msg->size = p - msg->body;
+	assert(msg->size == bytes + n);
+	return msg;
+}
+
+int rtmp_prepared_addref(struct rtmp_prepared_t* msg)
+{
+	return (int)rtmp_atomic_increment(&msg->ref);
+}
+
+int rtmp_prepared_release(struct rtmp_prepared_t* msg)
+{
+	long ref;
+	ref = rtmp_atomic_decrement(&msg->ref);
+	assert(ref >= 0);
+	if (0 == ref)
+		free(msg);
+	return (int)ref;
+}
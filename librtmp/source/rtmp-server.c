@@ -15,7 +15,6 @@
 
 #define RTMP_FMSVER				"FMS/3,0,1,123"
 #define RTMP_CAPABILITIES		31
-#define RTMP_OUTPUT_CHUNK_SIZE	4096
 
 struct rtmp_server_t
 {
@@ -384,6 +383,27 @@ static int rtmp_server_send(void* param, const uint8_t* header, uint32_t headerB
 	return (r == (int)(payloadBytes + headerBytes)) ? 0 : -1;
 }
 
+static int rtmp_server_sendv(void* param, const struct rtmp_iovec_t* vec, int n)
+{
+	int i, r;
+	size_t bytes;
+	struct rtmp_server_t* ctx;
+	ctx = (struct rtmp_server_t*)param;
+	for (bytes = i = 0; i < n; i++)
+		bytes += vec[i].len;
+	r = ctx->handler.sendv(ctx->param, vec, n);
+	return (r == (int)bytes) ? 0 : -1;
+}
+
+static int rtmp_server_sendprepared(void* param, const uint8_t* header, uint32_t headerBytes, struct rtmp_prepared_t* msg)
+{
+	int r;
+	struct rtmp_server_t* ctx;
+	ctx = (struct rtmp_server_t*)param;
+	r = ctx->handler.sendprepared(ctx->param, header, headerBytes, msg, msg->body, msg->size);
+	return (r == (int)(headerBytes + msg->size)) ? 0 : -1;
+}
+
 struct rtmp_server_t* rtmp_server_create(void* param, const struct rtmp_server_handler_t* handler)
 {
 	struct rtmp_server_t* ctx;
@@ -407,6 +427,8 @@ struct rtmp_server_t* rtmp_server_create(void* param, const struct rtmp_server_h
 
 	ctx->rtmp.param = ctx;
 	ctx->rtmp.send = rtmp_server_send;
+	ctx->rtmp.sendv = ctx->handler.sendv ? rtmp_server_sendv : NULL;
+	ctx->rtmp.sendprepared = ctx->handler.sendprepared ? rtmp_server_sendprepared : NULL;
 	ctx->rtmp.onaudio = rtmp_server_onaudio;
 	ctx->rtmp.onvideo = rtmp_server_onvideo;
 	ctx->rtmp.onabort = rtmp_server_onabort;
@@ -422,25 +444,18 @@ struct rtmp_server_t* rtmp_server_create(void* param, const struct rtmp_server_h
 	ctx->rtmp.u.server.onreceive_audio = rtmp_server_onreceive_audio;
 	ctx->rtmp.u.server.onreceive_video = rtmp_server_onreceive_video;
 	
-	ctx->rtmp.out_packets[RTMP_CHANNEL_PROTOCOL].header.cid = RTMP_CHANNEL_PROTOCOL;
-	ctx->rtmp.out_packets[RTMP_CHANNEL_INVOKE].header.cid = RTMP_CHANNEL_INVOKE;
-	ctx->rtmp.out_packets[RTMP_CHANNEL_AUDIO].header.cid = RTMP_CHANNEL_AUDIO;
-	ctx->rtmp.out_packets[RTMP_CHANNEL_VIDEO].header.cid = RTMP_CHANNEL_VIDEO;
-	ctx->rtmp.out_packets[RTMP_CHANNEL_DATA].header.cid = RTMP_CHANNEL_DATA;
+	rtmp_packets_find(&ctx->rtmp.out_packets, RTMP_CHANNEL_PROTOCOL, 1);
+	rtmp_packets_find(&ctx->rtmp.out_packets, RTMP_CHANNEL_INVOKE, 1);
+	rtmp_packets_find(&ctx->rtmp.out_packets, RTMP_CHANNEL_AUDIO, 1);
+	rtmp_packets_find(&ctx->rtmp.out_packets, RTMP_CHANNEL_VIDEO, 1);
+	rtmp_packets_find(&ctx->rtmp.out_packets, RTMP_CHANNEL_DATA, 1);
 	return ctx;
 }
 
 void rtmp_server_destroy(struct rtmp_server_t* ctx)
 {
-	size_t i;
-	assert(sizeof(ctx->rtmp.in_packets) == sizeof(ctx->rtmp.out_packets));
-	for (i = 0; i < N_CHUNK_STREAM; i++)
-	{
-		assert(NULL == ctx->rtmp.out_packets[i].payload);
-		if (ctx->rtmp.in_packets[i].payload)
-			free(ctx->rtmp.in_packets[i].payload);
-	}
-
+	rtmp_packets_free(&ctx->rtmp.in_packets);
+	rtmp_packets_free(&ctx->rtmp.out_packets);
 	free(ctx);
 }
 
@@ -556,3 +571,19 @@ int rtmp_server_send_script(struct rtmp_server_t* ctx, const void* data, size_t
 
 	return rtmp_chunk_write(&ctx->rtmp, &header, (const uint8_t*)data);
 }
+
+int rtmp_server_send_prepared(struct rtmp_server_t* ctx, struct rtmp_prepared_t* msg)
+{
+	struct rtmp_chunk_header_t header;
+	if ( (RTMP_TYPE_AUDIO == msg->type && 0 == ctx->receiveAudio) || (RTMP_TYPE_VIDEO == msg->type && 0 == ctx->receiveVideo) )
+		return 0; // client don't want receive audio/video
+
+	header.fmt = RTMP_CHUNK_TYPE_1; // enable compact header
+	header.cid = msg->cid;
+	header.timestamp = msg->timestamp;
+	header.length = (uint32_t)msg->bytes;
+	header.type = msg->type;
+	header.stream_id = ctx->stream_id;
+
+	return rtmp_chunk_write_prepared(&ctx->rtmp, &header, msg);
+}
@@ -0,0 +1,179 @@
+// FIPS 180-4 SHA-256
+// RFC 2104 HMAC: Keyed-Hashing for Message Authentication
+
+#include "rtmp-sha256.h"
+#include <string.h>
+
+#if defined(_OPENSSL_)
+void rtmp_sha256_init(struct rtmp_sha256_t* sha)
+{
+	SHA256_Init(&sha->ctx);
+}
+
+void rtmp_sha256_update(struct rtmp_sha256_t* sha, const void* data, size_t bytes)
+{
+	SHA256_Update(&sha->ctx, data, bytes);
+}
+
+void rtmp_sha256_final(struct rtmp_sha256_t* sha, uint8_t digest[RTMP_SHA256_DIGEST_LENGTH])
+{
+	SHA256_Final(digest, &sha->ctx);
+}
+
+#else
+static const uint32_t s_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROTR(x, n)	(((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z)	(((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z)	(((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define SIGMA0(x)	(ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define SIGMA1(x)	(ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define SIGMA2(x)	(ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define SIGMA3(x)	(ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+static void rtmp_sha256_transform(uint32_t state[8], const uint8_t* p)
+{
+	int i;
+	uint32_t w[64];
+	uint32_t a, b, c, d, e, f, g, h, t1, t2;
+
+	for (i = 0; i < 16; i++)
+		w[i] = ((uint32_t)p[i * 4] << 24) | ((uint32_t)p[i * 4 + 1] << 16) | ((uint32_t)p[i * 4 + 2] << 8) | (uint32_t)p[i * 4 + 3];
+	for (i = 16; i < 64; i++)
+		w[i] = SIGMA3(w[i - 2]) + w[i - 7] + SIGMA2(w[i - 15]) + w[i - 16];
+
+	a = state[0]; b = state[1]; c = state[2]; d = state[3];
+	e = state[4]; f = state[5]; g = state[6]; h = state[7];
+	for (i = 0; i < 64; i++)
+	{
+		t1 = h + SIGMA1(e) + CH(e, f, g) + s_k[i] + w[i];
+		t2 = SIGMA0(a) + MAJ(a, b, c);
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void rtmp_sha256_init(struct rtmp_sha256_t* sha)
+{
+	sha->state[0] = 0x6a09e667;
+	sha->state[1] = 0xbb67ae85;
+	sha->state[2] = 0x3c6ef372;
+	sha->state[3] = 0xa54ff53a;
+	sha->state[4] = 0x510e527f;
+	sha->state[5] = 0x9b05688c;
+	sha->state[6] = 0x1f83d9ab;
+	sha->state[7] = 0x5be0cd19;
+	sha->bytes = 0;
+}
+
+void rtmp_sha256_update(struct rtmp_sha256_t* sha, const void* data, size_t bytes)
+{
+	size_t n;
+	const uint8_t* p;
+
+	p = (const uint8_t*)data;
+	n = (size_t)(sha->bytes % RTMP_SHA256_BLOCK_LENGTH);
+	sha->bytes += bytes;
+
+	if (n > 0)
+	{
+		if (n + bytes < RTMP_SHA256_BLOCK_LENGTH)
+		{
+			memcpy(sha->block + n, p, bytes);
+			return;
+		}
+
+		memcpy(sha->block + n, p, RTMP_SHA256_BLOCK_LENGTH - n);
+		rtmp_sha256_transform(sha->state, sha->block);
+		p += RTMP_SHA256_BLOCK_LENGTH - n;
+		bytes -= RTMP_SHA256_BLOCK_LENGTH - n;
+	}
+
+	for (; bytes >= RTMP_SHA256_BLOCK_LENGTH; bytes -= RTMP_SHA256_BLOCK_LENGTH, p += RTMP_SHA256_BLOCK_LENGTH)
+		rtmp_sha256_transform(sha->state, p);
+
+	if (bytes > 0)
+		memcpy(sha->block, p, bytes);
+}
+
+void rtmp_sha256_final(struct rtmp_sha256_t* sha, uint8_t digest[RTMP_SHA256_DIGEST_LENGTH])
+{
+	int i;
+	size_t n;
+	uint64_t bits;
+
+	bits = sha->bytes * 8;
+	n = (size_t)(sha->bytes % RTMP_SHA256_BLOCK_LENGTH);
+	sha->block[n++] = 0x80;
+	if (n > RTMP_SHA256_BLOCK_LENGTH - 8)
+	{
+		memset(sha->block + n, 0, RTMP_SHA256_BLOCK_LENGTH - n);
+		rtmp_sha256_transform(sha->state, sha->block);
+		n = 0;
+	}
+	memset(sha->block + n, 0, RTMP_SHA256_BLOCK_LENGTH - 8 - n);
+	for (i = 0; i < 8; i++)
+		sha->block[RTMP_SHA256_BLOCK_LENGTH - 1 - i] = (uint8_t)(bits >> (i * 8));
+	rtmp_sha256_transform(sha->state, sha->block);
+
+	for (i = 0; i < 8; i++)
+	{
+		digest[i * 4 + 0] = (uint8_t)(sha->state[i] >> 24);
+		digest[i * 4 + 1] = (uint8_t)(sha->state[i] >> 16);
+		digest[i * 4 + 2] = (uint8_t)(sha->state[i] >> 8);
+		digest[i * 4 + 3] = (uint8_t)sha->state[i];
+	}
+}
+#endif
+
+void rtmp_hmac_sha256_init(struct rtmp_hmac_sha256_t* hmac, const uint8_t* key, size_t len)
+{
+	size_t i;
+	uint8_t pad[RTMP_SHA256_BLOCK_LENGTH];
+	uint8_t digest[RTMP_SHA256_DIGEST_LENGTH];
+
+	// keys longer than the block size are hashed first
+	if (len > RTMP_SHA256_BLOCK_LENGTH)
+	{
+		rtmp_sha256_init(&hmac->inner);
+		rtmp_sha256_update(&hmac->inner, key, len);
+		rtmp_sha256_final(&hmac->inner, digest);
+		key = digest;
+		len = sizeof(digest);
+	}
+
+	for (i = 0; i < RTMP_SHA256_BLOCK_LENGTH; i++)
+		pad[i] = (uint8_t)((i < len ? key[i] : 0) ^ 0x36);
+	rtmp_sha256_init(&hmac->inner);
+	rtmp_sha256_update(&hmac->inner, pad, sizeof(pad));
+
+	for (i = 0; i < RTMP_SHA256_BLOCK_LENGTH; i++)
+		pad[i] ^= 0x36 ^ 0x5c;
+	rtmp_sha256_init(&hmac->outer);
+	rtmp_sha256_update(&hmac->outer, pad, sizeof(pad));
+}
+
+void rtmp_hmac_sha256_update(struct rtmp_hmac_sha256_t* hmac, const void* data, size_t bytes)
+{
+	rtmp_sha256_update(&hmac->inner, data, bytes);
+}
+
+void rtmp_hmac_sha256_final(struct rtmp_hmac_sha256_t* hmac, uint8_t digest[RTMP_SHA256_DIGEST_LENGTH])
+{
+	uint8_t inner[RTMP_SHA256_DIGEST_LENGTH];
+	rtmp_sha256_final(&hmac->inner, inner);
+	rtmp_sha256_update(&hmac->outer, inner, sizeof(inner));
+	rtmp_sha256_final(&hmac->outer, digest);
+}
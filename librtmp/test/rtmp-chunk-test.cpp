@@ -58,11 +58,11 @@ void rtmp_chunk_test(const char* flv)
 	rtmp.onaudio = rtmp_client_onaudio;
 	rtmp.onvideo = rtmp_client_onvideo;
 	rtmp.onscript = rtmp_client_onscript;
-	rtmp.out_packets[RTMP_CHANNEL_PROTOCOL].header.cid = RTMP_CHANNEL_PROTOCOL;
-	rtmp.out_packets[RTMP_CHANNEL_INVOKE].header.cid = RTMP_CHANNEL_INVOKE;
-	rtmp.out_packets[RTMP_CHANNEL_AUDIO].header.cid = RTMP_CHANNEL_AUDIO;
-	rtmp.out_packets[RTMP_CHANNEL_VIDEO].header.cid = RTMP_CHANNEL_VIDEO;
-	rtmp.out_packets[RTMP_CHANNEL_DATA].header.cid = RTMP_CHANNEL_DATA;
+	rtmp_packets_find(&rtmp.out_packets, RTMP_CHANNEL_PROTOCOL, 1);
+	rtmp_packets_find(&rtmp.out_packets, RTMP_CHANNEL_INVOKE, 1);
+	rtmp_packets_find(&rtmp.out_packets, RTMP_CHANNEL_AUDIO, 1);
+	rtmp_packets_find(&rtmp.out_packets, RTMP_CHANNEL_VIDEO, 1);
+	rtmp_packets_find(&rtmp.out_packets, RTMP_CHANNEL_DATA, 1);
 	
 	while (1 == flv_reader_read(reader, &type, &timestamp, &taglen, packet, sizeof(packet)))
 	{
@@ -105,6 +105,8 @@ void rtmp_chunk_test(const char* flv)
 		}
 	}
 
+	rtmp_packets_free(&rtmp.in_packets);
+	rtmp_packets_free(&rtmp.out_packets);
 	flv_reader_destroy(reader);
 	flv_writer_destroy(writer);
 }
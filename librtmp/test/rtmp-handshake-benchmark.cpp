@@ -0,0 +1,57 @@
+#include "rtmp-handshake.h"
+#include "sys/thread.h"
+#include "sys/system.h"
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#define N_HANDSHAKE 5000 // per thread
+#define N_THREAD_MAX 16
+
+// client C0C1 -> server S0S1S2 -> client C2
+static int STDCALL rtmp_handshake_onthread(void* param)
+{
+	int i;
+	uint32_t timestamp;
+	uint8_t c[1 + RTMP_HANDSHAKE_SIZE * 2];
+	uint8_t s[1 + RTMP_HANDSHAKE_SIZE * 2];
+
+	timestamp = (uint32_t)(intptr_t)param;
+	for (i = 0; i < N_HANDSHAKE; i++)
+	{
+		rtmp_handshake_c0(c, RTMP_VERSION);
+		rtmp_handshake_c1(c + 1, timestamp + i);
+
+		rtmp_handshake_s0(s, RTMP_VERSION);
+		rtmp_handshake_s1(s + 1, timestamp + i);
+		rtmp_handshake_s2(s + 1 + RTMP_HANDSHAKE_SIZE, timestamp + i, c + 1, RTMP_HANDSHAKE_SIZE);
+
+		rtmp_handshake_c2(c + 1 + RTMP_HANDSHAKE_SIZE, timestamp + i, s + 1, RTMP_HANDSHAKE_SIZE);
+
+		// complex handshake: S2/C2 carry a digest response instead of echo C1/S1
+		assert(0 != memcmp(s + 1 + RTMP_HANDSHAKE_SIZE, c + 1, RTMP_HANDSHAKE_SIZE));
+		assert(0 != memcmp(c + 1 + RTMP_HANDSHAKE_SIZE, s + 1, RTMP_HANDSHAKE_SIZE));
+	}
+	return 0;
+}
+
+void rtmp_handshake_benchmark_test(void)
+{
+	static const int s_threads[] = { 1, 2, 4, 8, 16 };
+	pthread_t threads[N_THREAD_MAX];
+	uint64_t clock;
+	int i, j, n;
+
+	for (i = 0; i < (int)(sizeof(s_threads) / sizeof(s_threads[0])); i++)
+	{
+		n = s_threads[i];
+		clock = system_clock();
+		for (j = 0; j < n; j++)
+			thread_create(&threads[j], rtmp_handshake_onthread, (void*)(intptr_t)(j * N_HANDSHAKE));
+		for (j = 0; j < n; j++)
+			thread_destroy(threads[j]);
+		clock = system_clock() - clock;
+
+		printf("rtmp handshake threads: %d, %d handshakes, %u ms, %.0f handshakes/s\n", n, n * N_HANDSHAKE, (unsigned int)clock, clock ? (double)n * N_HANDSHAKE * 1000 / clock : 0.0);
+	}
+}
@@ -0,0 +1,150 @@
+extern "C" {
+#include "rtmp-internal.h"
+#include "rtmp-msgtypeid.h"
+}
+#include "rtmp-server.h"
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define N 200 // message count
+
+struct rtmp_prepared_test_t
+{
+	std::string output; // chunk stream bytes
+	std::vector<std::string> messages; // chunk read: type + timestamp + payload
+};
+
+static std::string rtmp_prepared_message(int type, uint32_t timestamp, const void* data, size_t bytes)
+{
+	char header[32];
+	snprintf(header, sizeof(header), "%d %u:", type, (unsigned int)timestamp);
+	return std::string(header) + std::string((const char*)data, bytes);
+}
+
+static int rtmp_prepared_send(void* param, const uint8_t* header, uint32_t len, const uint8_t* data, uint32_t bytes)
+{
+	struct rtmp_prepared_test_t* ctx = (struct rtmp_prepared_test_t*)param;
+	ctx->output.append((const char*)header, len);
+	ctx->output.append((const char*)data, bytes);
+	return 0;
+}
+
+static int rtmp_prepared_sendprepared(void* param, const uint8_t* header, uint32_t len, struct rtmp_prepared_t* msg)
+{
+	return rtmp_prepared_send(param, header, len, msg->body, (uint32_t)msg->size);
+}
+
+static int rtmp_prepared_onaudio(void* param, const uint8_t* data, size_t bytes, uint32_t timestamp)
+{
+	struct rtmp_prepared_test_t* ctx = (struct rtmp_prepared_test_t*)param;
+	ctx->messages.push_back(rtmp_prepared_message(RTMP_TYPE_AUDIO, timestamp, data, bytes));
+	return 0;
+}
+
+static int rtmp_prepared_onvideo(void* param, const uint8_t* data, size_t bytes, uint32_t timestamp)
+{
+	struct rtmp_prepared_test_t* ctx = (struct rtmp_prepared_test_t*)param;
+	ctx->messages.push_back(rtmp_prepared_message(RTMP_TYPE_VIDEO, timestamp, data, bytes));
+	return 0;
+}
+
+static int rtmp_prepared_onscript(void* param, const uint8_t* data, size_t bytes, uint32_t timestamp)
+{
+	struct rtmp_prepared_test_t* ctx = (struct rtmp_prepared_test_t*)param;
+	ctx->messages.push_back(rtmp_prepared_message(RTMP_TYPE_DATA, timestamp, data, bytes));
+	return 0;
+}
+
+static void rtmp_prepared_init(struct rtmp_t* rtmp, struct rtmp_prepared_test_t* ctx)
+{
+	memset(rtmp, 0, sizeof(*rtmp));
+	rtmp->parser.state = RTMP_PARSE_INIT;
+	rtmp->in_chunk_size = RTMP_OUTPUT_CHUNK_SIZE;
+	rtmp->out_chunk_size = RTMP_OUTPUT_CHUNK_SIZE;
+	rtmp->param = ctx;
+	rtmp->send = rtmp_prepared_send;
+	rtmp->onaudio = rtmp_prepared_onaudio;
+	rtmp->onvideo = rtmp_prepared_onvideo;
+	rtmp->onscript = rtmp_prepared_onscript;
+	rtmp_packets_find(&rtmp->out_packets, RTMP_CHANNEL_PROTOCOL, 1);
+	rtmp_packets_find(&rtmp->out_packets, RTMP_CHANNEL_INVOKE, 1);
+	rtmp_packets_find(&rtmp->out_packets, RTMP_CHANNEL_AUDIO, 1);
+	rtmp_packets_find(&rtmp->out_packets, RTMP_CHANNEL_VIDEO, 1);
+	rtmp_packets_find(&rtmp->out_packets, RTMP_CHANNEL_DATA, 1);
+}
+
+/// prepared message output is byte-identical to rtmp_chunk_write:
+/// empty payload, extended timestamp, stream id change and chunk size change(fallback)
+/// @param[in] empty 1-with empty payload(nothing sent, but chunk header state changed, no read back)
+static void rtmp_prepared_test2(int sendprepared, int empty)
+{
+	int i, r;
+	size_t n;
+	static uint8_t payload[64 * 1024];
+	static struct rtmp_t rtmp[3]; // 0-rtmp_chunk_write, 1-rtmp_chunk_write_prepared, 2-chunk read
+	struct rtmp_prepared_test_t ctx[3];
+	struct rtmp_chunk_header_t header;
+	std::vector<std::string> messages;
+	rtmp_prepared_t* msg;
+
+	for (i = 0; i < 3; i++)
+		rtmp_prepared_init(&rtmp[i], &ctx[i]);
+	rtmp[1].sendprepared = sendprepared ? rtmp_prepared_sendprepared : NULL;
+
+	srand(1);
+	for (i = 0; i < (int)sizeof(payload); i++)
+		payload[i] = (uint8_t)rand();
+
+	for (i = 0; i < N; i++)
+	{
+		// session chunk size differs from the prepared message
+		rtmp[0].out_chunk_size = rtmp[1].out_chunk_size = rtmp[2].in_chunk_size = (i >= 60 && i < 80) ? 128 : RTMP_OUTPUT_CHUNK_SIZE;
+
+		memset(&header, 0, sizeof(header));
+		header.fmt = RTMP_CHUNK_TYPE_1; // enable compact header
+		header.type = 0 == i % 3 ? RTMP_TYPE_AUDIO : (1 == i % 3 ? RTMP_TYPE_VIDEO : RTMP_TYPE_DATA);
+		header.cid = RTMP_TYPE_AUDIO == header.type ? RTMP_CHANNEL_AUDIO : (RTMP_TYPE_VIDEO == header.type ? RTMP_CHANNEL_VIDEO : RTMP_CHANNEL_INVOKE);
+		header.timestamp = i < 100 ? i * 40 : 0xFFFFF0 + i * 40; // extended timestamp
+		header.length = empty && 0 == i % 7 ? 0 : (uint32_t)(1 + rand() % sizeof(payload));
+		header.stream_id = i < 150 ? 1 : 2;
+
+		r = rtmp_chunk_write(&rtmp[0], &header, payload);
+		assert(0 == r);
+
+		msg = rtmp_prepared_create(header.type, payload, header.length, header.timestamp);
+		assert(msg && msg->cid == header.cid);
+		n = ctx[1].output.size();
+		r = rtmp_chunk_write_prepared(&rtmp[1], &header, msg);
+		assert(0 == r);
+		assert(0 == rtmp_prepared_release(msg));
+
+		// read back with the same chunk size
+		if (!empty)
+		{
+			r = rtmp_chunk_read(&rtmp[2], (const uint8_t*)ctx[1].output.data() + n, ctx[1].output.size() - n);
+			assert(0 == r);
+			messages.push_back(rtmp_prepared_message(header.type, header.timestamp, payload, header.length));
+		}
+	}
+
+	assert(ctx[0].output.size() > 0 && ctx[0].output == ctx[1].output);
+	assert(messages == ctx[2].messages);
+
+	for (i = 0; i < 3; i++)
+	{
+		rtmp_packets_free(&rtmp[i].in_packets);
+		rtmp_packets_free(&rtmp[i].out_packets);
+	}
+}
+
+void rtmp_prepared_test(void)
+{
+	rtmp_prepared_test2(1, 1);
+	rtmp_prepared_test2(0, 1);
+	rtmp_prepared_test2(1, 0);
+	rtmp_prepared_test2(0, 0);
+}
@@ -38,8 +38,8 @@ static int STDCALL rtmp_client_push(void* flv)
 		else if (t + timestamp > t + 3 * 1000)
 			t = t - timestamp;
 
-		while (s_param.rtmp && aio_rtmp_client_get_unsend(s_param.rtmp) > 8 * 1024 * 1024)
-			system_sleep(1000); // can't send?
+		while (s_param.rtmp && aio_rtmp_client_get_unsend(s_param.rtmp) > 0)
+			system_sleep(10); // packet is referenced until sent
 
 		switch (type)
 		{
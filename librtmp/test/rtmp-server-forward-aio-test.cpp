@@ -36,6 +36,19 @@ struct rtmp_player_t
     }
 
 private:
+    // muxer data buffer is reused, hold a reference to the message until sent
+    static int send(aio_rtmp_session_t* rtmp, int type, const void* data, size_t bytes, uint32_t timestamp)
+    {
+        int r;
+        rtmp_prepared_t* msg;
+        msg = rtmp_prepared_create(type, data, bytes, timestamp);
+        if (!msg)
+            return -1;
+        r = aio_rtmp_server_send_prepared(rtmp, msg);
+        rtmp_prepared_release(msg);
+        return r;
+    }
+
     static int handler(void* param, int type, const void* data, size_t bytes, uint32_t timestamp)
     {
         rtmp_player_t* player = (rtmp_player_t*)param;
@@ -44,9 +57,8 @@ private:
         case FLV_TYPE_SCRIPT:
             return aio_rtmp_server_send_script(player->rtmp, data, bytes, timestamp);
         case FLV_TYPE_AUDIO:
-            return aio_rtmp_server_send_audio(player->rtmp, data, bytes, timestamp);
         case FLV_TYPE_VIDEO:
-            return aio_rtmp_server_send_video(player->rtmp, data, bytes, timestamp);
+            return send(player->rtmp, type, data, bytes, timestamp);
         default:
             assert(0);
             return -1;
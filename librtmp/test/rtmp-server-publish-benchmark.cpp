@@ -8,6 +8,7 @@
 
 #define N 5000
 #define M 8
+#define N_INGEST 50 // ingest loop count
 
 struct rtmp_server_publish_benchmark_t
 {
@@ -106,10 +107,41 @@ static int rtmp_server_onaudio(void* param, const void* data, size_t bytes, uint
 {
     return 0;
 }
+// single core ingest: input all packets without pacing
+static void rtmp_server_publish_ingest(const struct rtmp_server_handler_t* handler)
+{
+    uint64_t bytes = 0;
+    uint64_t clock = system_clock();
+    for (int i = 0; i < N_INGEST; i++)
+    {
+        rtmp_server_t* rtmp = rtmp_server_create(NULL, handler);
+        for (size_t j = 0; j < s_pkts.size(); j++)
+        {
+            rtmp_server_input(rtmp, s_pkts[j].data, s_pkts[j].size);
+            bytes += s_pkts[j].size;
+        }
+        rtmp_server_destroy(rtmp);
+    }
+    clock = system_clock() - clock;
+
+    printf("rtmp server ingest: %u KB x %d, %u ms, %.2f MB/s per core\n", (unsigned int)(bytes / N_INGEST / 1024), N_INGEST, (unsigned int)clock, clock > 0 ? bytes / 1024.0 / 1024 * 1000 / clock : 0.0);
+}
+
 void rtmp_server_publish_benchmark_test(const char* bin)
 {
     init_packets(bin);
 
+    {
+        struct rtmp_server_handler_t handler;
+        memset(&handler, 0, sizeof(handler));
+        handler.send = rtmp_server_send;
+        handler.onpublish = rtmp_server_onpublish;
+        handler.onscript = rtmp_server_onscript;
+        handler.onvideo = rtmp_server_onvideo;
+        handler.onaudio = rtmp_server_onaudio;
+        rtmp_server_publish_ingest(&handler);
+    }
+
     for (int i = 0; i < N; i++)
     {
         struct rtmp_server_handler_t handler;
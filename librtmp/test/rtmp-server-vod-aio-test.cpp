@@ -53,10 +53,10 @@ static int STDCALL aio_rtmp_server_worker(void* param)
             if (NULL == vod->session)
                 break;
 
-            while (aio_rtmp_server_get_unsend(vod->session) > 8 * 1024 * 1024)
+            while (aio_rtmp_server_get_unsend(vod->session) > 0)
             {
                 vod->locker.Unlock();
-                system_sleep(1000); // can't send?
+                system_sleep(10); // vod->packet is referenced until sent
                 vod->locker.Lock();
             }
 
@@ -37,6 +37,20 @@ enum
 	RTCP_SDES_PRIVATE	= 8,
 };
 
+// RFC4585 6.1 Common Packet Format for Feedback Messages, FMT(in rc field)
+enum
+{
+	RTCP_RTPFB_NACK		= 1, // Generic NACK
+	RTCP_RTPFB_TMMBR	= 3, // RFC5104 Temporary Maximum Media Stream Bit Rate Request
+	RTCP_RTPFB_TMMBN	= 4, // RFC5104 Temporary Maximum Media Stream Bit Rate Notification
+
+	RTCP_PSFB_PLI		= 1, // Picture Loss Indication
+	RTCP_PSFB_SLI		= 2, // Slice Loss Indication
+	RTCP_PSFB_RPSI		= 3, // Reference Picture Selection Indication
+	RTCP_PSFB_FIR		= 4, // RFC5104 Full Intra Request
+	RTCP_PSFB_AFB		= 15, // Application layer FB
+};
+
 typedef struct _rtcp_header_t
 {
 	uint32_t v:2;		// version
@@ -24,10 +24,16 @@ typedef int (*rtp_demuxer_onpacket)(void* param, const void *packet, int bytes,
 struct rtp_demuxer_t* rtp_demuxer_create(int jitter, int frequency, int payload, const char* encoding, rtp_demuxer_onpacket onpkt, void* param);
 int rtp_demuxer_destroy(struct rtp_demuxer_t** rtp);
 
+/// @param[in] flags payload decoder flags, e.g. RTP_PAYLOAD_DECODE_FLAG_ACCESS_UNIT(see more @rtp-payload.h)
+/// @return 0-ok, -ENOSYS-unsupported payload
+int rtp_demuxer_setflags(struct rtp_demuxer_t* rtp, int flags);
+
 /// @param[in] data a rtp/rtcp packet
 /// @return >0-rtcp message, 0-ok, <0-error
 int rtp_demuxer_input(struct rtp_demuxer_t* rtp, const void* data, int bytes);
 
+/// RTCP report(SR/RR) and feedback(NACK for jitter buffer holes, PLI for lost frames)
+/// call it frequently(e.g. every 10~20ms) to NACK lost packets in time
 /// @return >0-rtcp report length, 0-don't need send rtcp
 int rtp_demuxer_rtcp(struct rtp_demuxer_t* rtp, void* buf, int len);
 
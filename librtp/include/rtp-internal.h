@@ -42,11 +42,16 @@ int rtcp_sr_pack(struct rtp_context *ctx, uint8_t* data, int bytes);
 int rtcp_sdes_pack(struct rtp_context *ctx, uint8_t* data, int bytes);
 int rtcp_bye_pack(struct rtp_context *ctx, uint8_t* data, int bytes);
 int rtcp_app_pack(struct rtp_context *ctx, uint8_t* ptr, int bytes, const char name[4], const void* app, int len);
+int rtcp_nack_pack(struct rtp_context *ctx, uint8_t* ptr, int bytes, uint32_t media, const uint16_t* lost, int num);
+int rtcp_pli_pack(struct rtp_context *ctx, uint8_t* ptr, int bytes, uint32_t media);
+int rtcp_fir_pack(struct rtp_context *ctx, uint8_t* ptr, int bytes, uint32_t media, uint8_t seq);
 void rtcp_rr_unpack(struct rtp_context *ctx, rtcp_header_t *header, const uint8_t* data);
 void rtcp_sr_unpack(struct rtp_context *ctx, rtcp_header_t *header, const uint8_t* data);
 void rtcp_sdes_unpack(struct rtp_context *ctx, rtcp_header_t *header, const uint8_t* data);
 void rtcp_bye_unpack(struct rtp_context *ctx, rtcp_header_t *header, const uint8_t* data);
 void rtcp_app_unpack(struct rtp_context *ctx, rtcp_header_t *header, const uint8_t* data);
+void rtcp_rtpfb_unpack(struct rtp_context *ctx, rtcp_header_t *header, const uint8_t* data);
+void rtcp_psfb_unpack(struct rtp_context *ctx, rtcp_header_t *header, const uint8_t* data);
 
 int rtcp_report_block(struct rtp_member* sender, uint8_t* ptr, int bytes);
 
@@ -14,4 +14,12 @@ struct rtp_member* rtp_member_list_find(void* members, uint32_t ssrc);
 int rtp_member_list_add(void* members, struct rtp_member* source);
 int rtp_member_list_delete(void* members, uint32_t ssrc);
 
+/// Timeout inactive members(timer wheel, only members due on elapsed ticks are checked)
+/// @param[in] clock current clock(rtpclock)
+/// @param[in] timeout inactive timeout, same unit as clock
+/// @param[in] sender 1-RTP packet clock only, 0-RTP/RTCP packet clock
+/// @param[in] onexpire return 0-delete member, other-keep it, NULL-delete
+/// @return expired member count
+int rtp_member_list_expire(void* members, uint64_t clock, uint64_t timeout, int sender, int (*onexpire)(void* param, struct rtp_member* member), void* param);
+
 #endif /* !_rtp_member_list_h_ */
@@ -22,4 +22,37 @@ int rtp_packet_deserialize(struct rtp_packet_t *pkt, const void* data, int bytes
 ///@return <0-error, >0-rtp packet size, =0-impossible
 int rtp_packet_serialize(const struct rtp_packet_t *pkt, void* data, int bytes);
 
+/// Build RTP fixed header template for packers(no padding, no CSRC, no extension)
+/// V/P/X/CC/PT/SSRC are written once, M/sequence number/timestamp are patched per packet
+static inline void rtp_packet_header_template(uint8_t header[RTP_FIXED_HEADER], uint8_t pt, uint32_t ssrc)
+{
+	header[0] = (uint8_t)(RTP_VERSION << 6);
+	header[1] = (uint8_t)(pt & 0x7F);
+	header[2] = header[3] = 0; // sequence number
+	header[4] = header[5] = header[6] = header[7] = 0; // timestamp
+	header[8] = (uint8_t)(ssrc >> 24);
+	header[9] = (uint8_t)(ssrc >> 16);
+	header[10] = (uint8_t)(ssrc >> 8);
+	header[11] = (uint8_t)ssrc;
+}
+
+/// Write RTP fixed header from template, take marker/sequence number/timestamp from rtp
+/// @return RTP_FIXED_HEADER
+static inline int rtp_packet_header_write(uint8_t* ptr, const uint8_t header[RTP_FIXED_HEADER], const rtp_header_t* rtp)
+{
+	ptr[0] = header[0];
+	ptr[1] = (uint8_t)(header[1] | (rtp->m << 7));
+	ptr[2] = (uint8_t)(rtp->seq >> 8);
+	ptr[3] = (uint8_t)rtp->seq;
+	ptr[4] = (uint8_t)(rtp->timestamp >> 24);
+	ptr[5] = (uint8_t)(rtp->timestamp >> 16);
+	ptr[6] = (uint8_t)(rtp->timestamp >> 8);
+	ptr[7] = (uint8_t)rtp->timestamp;
+	ptr[8] = header[8];
+	ptr[9] = header[9];
+	ptr[10] = header[10];
+	ptr[11] = header[11];
+	return RTP_FIXED_HEADER;
+}
+
 #endif /* !_rtp_packet_h_ */
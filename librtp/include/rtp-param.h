@@ -9,6 +9,7 @@
 
 #define RTCP_REPORT_INTERVAL			5000 /* milliseconds RFC3550 p25 */
 #define RTCP_REPORT_INTERVAL_MIN		2500 /* milliseconds RFC3550 p25 */
+#define RTCP_MEMBER_TIMEOUT				5 /* report intervals, RFC3550 6.3.5 */
 
 #define RTP_PAYLOAD_MAX_SIZE			(10 * 1024 * 1024)
 
@@ -12,6 +12,46 @@ extern "C" {
 /// RTP packet lost(miss packet before this frame)
 #define RTP_PAYLOAD_FLAG_PACKET_LOST	0x0100 // some packets lost before the packet
 #define RTP_PAYLOAD_FLAG_PACKET_CORRUPT 0x0200 // the packet data is corrupt
+#define RTP_PAYLOAD_FLAG_KEYFRAME		0x0001 // access unit mode only: IDR(H.264)/IRAP(H.265) frame
+
+/// rtp_payload_decode_setflags
+#define RTP_PAYLOAD_DECODE_FLAG_ACCESS_UNIT 0x01 // one packet callback per access unit(H.264/H.265 only)
+
+/// RTP packet in the batch arena, e.g. iovec for sendmmsg
+struct rtp_payload_packet_t
+{
+	uint8_t* ptr; // RTP packet, include rtp header
+	int bytes;
+	uint32_t timestamp;
+	int flags;
+};
+
+/// Caller provided arena, packets of one or more frames are stored back to back
+/// reset offset and count to reuse the arena after packets have been sent
+struct rtp_payload_batch_t
+{
+	uint8_t* arena;
+	int capacity; // arena size in bytes, e.g. frame bytes + packets * 32 (RTP header + payload header)
+	int offset; // arena used bytes
+
+	struct rtp_payload_packet_t* pkts;
+	int num; // pkts array size
+	int count; // packets in the arena
+};
+
+/// Caller provided access unit buffer(H.264/H.265 decoder only), see rtp_payload_decode_setframe
+struct rtp_payload_frame_t
+{
+	/// @param[in] param decoder cbparam
+	/// @param[in] bytes minimum buffer size
+	/// @param[in,out] capacity real buffer size(default: bytes), the decoder uses all of it
+	/// @return NULL-alloc failed(frame dropped), other-frame buffer
+	/// alloc/free NULL: use decoder internal buffer, valid in packet callback only
+	void* (*alloc)(void* param, int bytes, int* capacity);
+	void (*free)(void* param, void* frame);
+
+	int avcc; // NALU prefix(4-bytes): 0-start code(00 00 00 01), 1-NALU length(AVCC/HVCC)
+};
 
 struct rtp_payload_t
 {
@@ -27,7 +67,7 @@ struct rtp_payload_t
 /// @param[in] name RTP payload name
 /// @param[in] seq RTP header sequence number filed
 /// @param[in] ssrc RTP header SSRC filed
-/// @param[in] handler user-defined callback functions
+/// @param[in] handler user-defined callback functions, NULL if use rtp_payload_encode_batch only
 /// @param[in] cbparam user-defined parameter
 /// @return NULL-error, other-ok
 void* rtp_payload_encode_create(int payload, const char* name, uint16_t seq, uint32_t ssrc, struct rtp_payload_t *handler, void* cbparam);
@@ -47,6 +87,15 @@ void rtp_payload_encode_getinfo(void* encoder, uint16_t* seq, uint32_t* timestam
 /// @return 0-ok, ENOMEM-alloc failed, <0-failed
 int rtp_payload_encode_input(void* encoder, const void* data, int bytes, uint32_t timestamp);
 
+/// Encode RTP packets into the batch arena, don't call rtp_payload_t alloc/packet/free
+/// @param[in] encoder RTP packet encoder(create by rtp_payload_encode_create)
+/// @param[in,out] batch packets arena, new packets are appended
+/// @param[in] data stream data
+/// @param[in] bytes stream length in bytes
+/// @param[in] timestamp RTP header timestamp
+/// @return >=0-new packet count, -E2BIG-arena or pkts array too small(frame partially encoded), <0-failed
+int rtp_payload_encode_batch(void* encoder, struct rtp_payload_batch_t* batch, const void* data, int bytes, uint32_t timestamp);
+
 
 /// Create RTP packet decoder
 /// @param[in] payload RTP payload type, value: [0, 127] (see more about rtp-profile.h)
@@ -64,6 +113,21 @@ void rtp_payload_decode_destroy(void* decoder);
 /// @return 1-packet handled, 0-packet discard, <0-failed
 int rtp_payload_decode_input(void* decoder, const void* packet, int bytes);
 
+/// Deliver one access unit per handler packet callback instead of one NALU per callback(H.264/H.265 only)
+/// NALUs(with 4-bytes prefix) are written to the frame buffer directly, FU payload included,
+/// the frame ends on RTP marker bit or timestamp change, and it's released by frame free after packet callback
+/// @param[in] decoder RTP packet decoder(create by rtp_payload_decode_create)
+/// @param[in] frame frame buffer callbacks, NULL-restore one NALU per callback
+/// @return 0-ok, -ENOSYS-unsupported payload
+int rtp_payload_decode_setframe(void* decoder, const struct rtp_payload_frame_t* frame);
+
+/// Set decoder flags, RTP_PAYLOAD_DECODE_FLAG_ACCESS_UNIT: access unit mode with the decoder internal buffer,
+/// NALUs with start code(00 00 00 01), RTP_PAYLOAD_FLAG_KEYFRAME set on the packet callback flags
+/// @param[in] decoder RTP packet decoder(create by rtp_payload_decode_create)
+/// @param[in] flags RTP_PAYLOAD_DECODE_FLAG_XXX, 0-one callback per NALU
+/// @return 0-ok, -ENOSYS-unsupported payload
+int rtp_payload_decode_setflags(void* decoder, int flags);
+
 /// Set/Get rtp encode packet size(include rtp header)
 void rtp_packet_setsize(int bytes);
 int rtp_packet_getsize(void);
@@ -16,6 +16,12 @@ int rtp_queue_destroy(rtp_queue_t* queue);
 int rtp_queue_write(rtp_queue_t* queue, struct rtp_packet_t* pkt);
 struct rtp_packet_t* rtp_queue_read(rtp_queue_t* queue);
 
+/// Get lost packets(jitter buffer holes) for RTCP NACK
+/// @param[out] lost lost packet sequence numbers, in ascending order
+/// @param[in] num lost array size
+/// @return lost packet count
+int rtp_queue_lost(rtp_queue_t* queue, uint16_t* lost, int num);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -12,6 +12,9 @@ enum {
 	RTCP_MSG_EXPIRED,	/// member leave(re-calculate RTCP Transmission Interval)
 	RTCP_MSG_BYE,		/// member leave(re-calculate RTCP Transmission Interval)
 	RTCP_MSG_APP, 
+	RTCP_MSG_NACK,		/// RFC4585 Generic NACK(retransmit lost packets)
+	RTCP_MSG_PLI,		/// RFC4585 Picture Loss Indication(request key frame)
+	RTCP_MSG_FIR,		/// RFC5104 Full Intra Request(request key frame)
 };
 
 struct rtcp_msg_t
@@ -47,6 +50,30 @@ struct rtcp_msg_t
 			void* data;
 			int bytes; // data length
 		} app;
+
+		// RTCP_MSG_NACK, one message per FCI entry
+		struct rtcp_nack_t
+		{
+			unsigned int ssrc; // packet sender
+			unsigned int media; // media source
+			uint16_t pid; // lost packet sequence number
+			uint16_t blp; // bitmask of following lost packets, bit i: pid + i + 1
+		} nack;
+
+		// RTCP_MSG_PLI
+		struct rtcp_pli_t
+		{
+			unsigned int ssrc; // packet sender
+			unsigned int media; // media source
+		} pli;
+
+		// RTCP_MSG_FIR, one message per FCI entry
+		struct rtcp_fir_t
+		{
+			unsigned int ssrc; // packet sender
+			unsigned int media; // media source(FCI SSRC)
+			int seq; // command sequence number
+		} fir;
 	} u;
 };
 
@@ -98,6 +125,33 @@ int rtp_rtcp_report(void* rtp, void* rtcp, int bytes);
 /// @return 0-error, >0-rtcp package size(maybe need call more times)
 int rtp_rtcp_bye(void* rtp, void* rtcp, int bytes);
 
+/// create RTCP Generic NACK packet(RFC4585 6.2.1)
+/// @param[in] rtp RTP object
+/// @param[in] ssrc media source SSRC
+/// @param[in] lost lost packet sequence numbers, in ascending order
+/// @param[in] num lost packet count
+/// @param[out] rtcp RTCP packet(include RTCP Header)
+/// @param[in] bytes RTCP packet size in byte
+/// @return 0-error, >0-rtcp package size(maybe need call more times)
+int rtp_rtcp_nack(void* rtp, uint32_t ssrc, const uint16_t* lost, int num, void* rtcp, int bytes);
+
+/// create RTCP Picture Loss Indication packet(RFC4585 6.3.1)
+/// @param[in] rtp RTP object
+/// @param[in] ssrc media source SSRC
+/// @param[out] rtcp RTCP packet(include RTCP Header)
+/// @param[in] bytes RTCP packet size in byte
+/// @return 0-error, >0-rtcp package size
+int rtp_rtcp_pli(void* rtp, uint32_t ssrc, void* rtcp, int bytes);
+
+/// create RTCP Full Intra Request packet(RFC5104 4.3.1)
+/// @param[in] rtp RTP object
+/// @param[in] ssrc media source SSRC
+/// @param[in] seq command sequence number, increase by 1 for each new request
+/// @param[out] rtcp RTCP packet(include RTCP Header)
+/// @param[in] bytes RTCP packet size in byte
+/// @return 0-error, >0-rtcp package size
+int rtp_rtcp_fir(void* rtp, uint32_t ssrc, uint8_t seq, void* rtcp, int bytes);
+
 /// get RTCP interval
 /// @param[in] rtp RTP object
 /// 0-ok, <0-error
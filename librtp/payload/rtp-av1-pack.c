@@ -31,6 +31,7 @@
 struct rtp_encode_av1_t
 {
 	struct rtp_packet_t pkt;
+	uint8_t header[RTP_FIXED_HEADER]; // fixed header template
 	struct rtp_payload_t handler;
 	void* cbparam;
 	int size;
@@ -81,6 +82,7 @@ static void* rtp_av1_pack_create(int size, uint8_t pt, uint16_t seq, uint32_t ss
 	packer->pkt.rtp.pt = pt;
 	packer->pkt.rtp.seq = seq;
 	packer->pkt.rtp.ssrc = ssrc;
+	rtp_packet_header_template(packer->header, pt, ssrc);
 	return packer;
 }
 
@@ -109,12 +111,7 @@ static int rtp_av1_pack_flush(struct rtp_encode_av1_t *packer)
 		return 0; // nothing to send
 
 	packer->pkt.payloadlen = packer->offset - RTP_FIXED_HEADER;
-	n = rtp_packet_serialize_header(&packer->pkt, packer->ptr, packer->size);
-	if (n != RTP_FIXED_HEADER)
-	{
-		assert(0);
-		return -1;
-	}
+	n = rtp_packet_header_write(packer->ptr, packer->header, &packer->pkt.rtp);
 
 	++packer->pkt.rtp.seq;
 	packer->aggregation &= ~AV1_AGGREGATION_HEADER_N;
@@ -238,7 +235,7 @@ static int rtp_av1_pack_input(void* pack, const void* data, int bytes, uint32_t
 			// 5. Packetization rules
 			// The temporal delimiter OBU, if present, SHOULD be removed 
 			// when transmitting, and MUST be ignored by receivers.
-			if (OBU_TEMPORAL_DELIMITER != obu_type)
+			if (OBU_TEMPORAL_DELIMITER == obu_type)
 				continue;
 
 			if (0 != rtp_av1_pack_append(packer, ptr, obu_size))
@@ -21,6 +21,7 @@
 
 #include "rtp-packet.h"
 #include "rtp-payload-internal.h"
+#include "mpeg4-annexb.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -35,6 +36,7 @@
 struct rtp_encode_h264_t
 {
 	struct rtp_packet_t pkt;
+	uint8_t header[RTP_FIXED_HEADER]; // fixed header template
 	struct rtp_payload_t handler;
 	void* cbparam;
 	int size;
@@ -54,6 +56,7 @@ static void* rtp_h264_pack_create(int size, uint8_t pt, uint16_t seq, uint32_t s
 	packer->pkt.rtp.pt = pt;
 	packer->pkt.rtp.seq = seq;
 	packer->pkt.rtp.ssrc = ssrc;
+	rtp_packet_header_template(packer->header, pt, ssrc);
 	return packer;
 }
 
@@ -77,12 +80,8 @@ static void rtp_h264_pack_get_info(void* pack, uint16_t* seq, uint32_t* timestam
 
 static const uint8_t* h264_nalu_find(const uint8_t* p, const uint8_t* end)
 {
-	for(p += 2; p + 1 < end; p++)
-	{
-		if (0x01 == *p && 0x00 == *(p - 1) && 0x00 == *(p - 2))
-			return p + 1;
-	}
-	return end;
+	p = mpeg4_annexb_nalu_find(p, end);
+	return p ? p : end;
 }
 
 static int rtp_h264_pack_nalu(struct rtp_encode_h264_t *packer, const uint8_t* nalu, int bytes, int mark)
@@ -98,12 +97,9 @@ static int rtp_h264_pack_nalu(struct rtp_encode_h264_t *packer, const uint8_t* n
 
 	//packer->pkt.rtp.m = 1; // set marker flag
 	packer->pkt.rtp.m = (*nalu & 0x1f) <= 5 ? mark : 0; // VCL only
-	n = rtp_packet_serialize(&packer->pkt, rtp, n);
-	if (n != RTP_FIXED_HEADER + packer->pkt.payloadlen)
-	{
-		assert(0);
-		return -1;
-	}
+	n = rtp_packet_header_write(rtp, packer->header, &packer->pkt.rtp);
+	memcpy(rtp + n, packer->pkt.payload, packer->pkt.payloadlen);
+	n += packer->pkt.payloadlen;
 
 	++packer->pkt.rtp.seq;
 	r = packer->handler.packet(packer->cbparam, rtp, n, packer->pkt.rtp.timestamp, 0);
@@ -146,12 +142,7 @@ static int rtp_h264_pack_fu_a(struct rtp_encode_h264_t *packer, const uint8_t* n
 		if (!rtp) return -ENOMEM;
 
 		packer->pkt.rtp.m = (FU_END & fu_header) ? mark : 0; // set marker flag
-		n = rtp_packet_serialize_header(&packer->pkt, rtp, n);
-		if (n != RTP_FIXED_HEADER)
-		{
-			assert(0);
-			return -1;
-		}
+		n = rtp_packet_header_write(rtp, packer->header, &packer->pkt.rtp);
 
 		/*fu_indicator + fu_header*/
 		rtp[n + 0] = fu_indicator;
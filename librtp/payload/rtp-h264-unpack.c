@@ -2,6 +2,7 @@
 
 #include "rtp-packet.h"
 #include "rtp-payload-internal.h"
+#include "rtp-payload-frame.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -11,6 +12,7 @@
 #define FU_START(v) (v & 0x80)
 #define FU_END(v)	(v & 0x40)
 #define FU_NAL(v)	(v & 0x1F)
+#define H264_IDR(v)	(5 == H264_NAL(v) ? RTP_PAYLOAD_FLAG_KEYFRAME : 0)
 
 struct rtp_decode_h264_t
 {
@@ -24,6 +26,8 @@ struct rtp_decode_h264_t
 	int size, capacity;
 
 	int flags;
+
+	struct rtp_payload_frame_helper_t au; // access unit mode
 };
 
 static void* rtp_h264_unpack_create(struct rtp_payload_t *handler, void* param)
@@ -36,6 +40,7 @@ static void* rtp_h264_unpack_create(struct rtp_payload_t *handler, void* param)
 	memcpy(&unpacker->handler, handler, sizeof(unpacker->handler));
 	unpacker->cbparam = param;
 	unpacker->flags = -1;
+	rtp_payload_frame_init(&unpacker->au, &unpacker->handler, param);
 	return unpacker;
 }
 
@@ -46,12 +51,33 @@ static void rtp_h264_unpack_destroy(void* p)
 
 	if(unpacker->ptr)
 		free(unpacker->ptr);
+	rtp_payload_frame_destroy(&unpacker->au);
 #if defined(_DEBUG) || defined(DEBUG)
 	memset(unpacker, 0xCC, sizeof(*unpacker));
 #endif
 	free(unpacker);
 }
 
+static int rtp_h264_unpack_setframe(void* p, const struct rtp_payload_frame_t* frame)
+{
+	struct rtp_decode_h264_t *unpacker;
+	unpacker = (struct rtp_decode_h264_t *)p;
+	unpacker->size = 0; // discard incomplete FU
+	return rtp_payload_frame_set(&unpacker->au, frame);
+}
+
+static int rtp_h264_unpack_nalu(struct rtp_decode_h264_t *unpacker, const uint8_t* nalu, int bytes, uint32_t timestamp)
+{
+	int r;
+	if (unpacker->au.enable)
+		r = rtp_payload_frame_write(&unpacker->au, timestamp, unpacker->flags | H264_IDR(nalu[0]), nalu, bytes);
+	else
+		r = unpacker->handler.packet(unpacker->cbparam, nalu, bytes, timestamp, unpacker->flags);
+	unpacker->flags = 0;
+	unpacker->size = 0;
+	return r;
+}
+
 // 5.7.1. Single-Time Aggregation Packet (STAP) (p23)
 /*
  0               1               2               3
@@ -101,9 +127,7 @@ static int rtp_h264_unpack_stap(struct rtp_decode_h264_t *unpacker, const uint8_
 		}
 
 		assert(H264_NAL(ptr[2]) > 0 && H264_NAL(ptr[2]) < 24);
-		r = unpacker->handler.packet(unpacker->cbparam, ptr + 2, len, timestamp, unpacker->flags);
-		unpacker->flags = 0;
-		unpacker->size = 0;
+		r = rtp_h264_unpack_nalu(unpacker, ptr + 2, len, timestamp);
 
 		ptr += len + 2; // next NALU
 		don = (don + 1) % 65536;
@@ -176,9 +200,7 @@ static int rtp_h264_unpack_mtap(struct rtp_decode_h264_t *unpacker, const uint8_
 		ts += timestamp; // wrap 1 << 32
 
 		assert(H264_NAL(ptr[n + 3]) > 0 && H264_NAL(ptr[n + 3]) < 24);
-		r = unpacker->handler.packet(unpacker->cbparam, ptr + 1 + n, len - 1 - n, ts, unpacker->flags);
-		unpacker->flags = 0;
-		unpacker->size = 0;
+		r = rtp_h264_unpack_nalu(unpacker, ptr + 1 + n, len - 1 - n, ts);
 
 		ptr += len + 2; // next NALU
 	}
@@ -200,6 +222,38 @@ static int rtp_h264_unpack_mtap(struct rtp_decode_h264_t *unpacker, const uint8_
 |                               :   ...OPTIONAL RTP padding     |
 +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 */
+// FU payload to the caller frame buffer, no reassembly buffer
+static int rtp_h264_unpack_fu_frame(struct rtp_decode_h264_t *unpacker, const uint8_t* ptr, int bytes, uint32_t timestamp, int n)
+{
+	int r;
+	uint8_t nalu;
+	uint8_t fuheader;
+
+	r = 0;
+	fuheader = ptr[1];
+	if (FU_START(fuheader))
+	{
+		nalu = (ptr[0]/*indicator*/ & 0xE0) | (fuheader & 0x1F);
+		assert(H264_NAL(nalu) > 0 && H264_NAL(nalu) < 24);
+		r = rtp_payload_frame_begin(&unpacker->au, timestamp, unpacker->flags | H264_IDR(nalu), &nalu, 1);
+		unpacker->flags = 0;
+	}
+	else if (unpacker->au.nalu < 0)
+	{
+		unpacker->flags = RTP_PAYLOAD_FLAG_PACKET_LOST;
+		return 0; // packet discard
+	}
+
+	if (unpacker->au.nalu < 0)
+		return r; // alloc failed
+	if (bytes > n && 0 != rtp_payload_frame_append(&unpacker->au, ptr + n, bytes - n))
+		return -ENOMEM;
+	if (FU_END(fuheader))
+		rtp_payload_frame_end(&unpacker->au);
+
+	return 0 == r ? 1 : r; // packet handled
+}
+
 static int rtp_h264_unpack_fu(struct rtp_decode_h264_t *unpacker, const uint8_t* ptr, int bytes, uint32_t timestamp, int fu_b)
 {
 	int r, n;
@@ -214,6 +268,9 @@ static int rtp_h264_unpack_fu(struct rtp_decode_h264_t *unpacker, const uint8_t*
 		return -EINVAL; // error
 	}
 
+	if (unpacker->au.enable)
+		return rtp_h264_unpack_fu_frame(unpacker, ptr, bytes, timestamp, n);
+
 	if (unpacker->size + bytes - n + 1 /*NALU*/ > unpacker->capacity)
 	{
 		void* p = NULL;
@@ -280,7 +337,7 @@ static int rtp_h264_unpack_fu(struct rtp_decode_h264_t *unpacker, const uint8_t*
 
 static int rtp_h264_unpack_input(void* p, const void* packet, int bytes)
 {
-	int r;
+	int r, n;
 	uint8_t nalt;
 	struct rtp_packet_t pkt;
 	struct rtp_decode_h264_t *unpacker;
@@ -299,6 +356,8 @@ static int rtp_h264_unpack_input(void* p, const void* packet, int bytes)
 	{
 		unpacker->flags = RTP_PAYLOAD_FLAG_PACKET_LOST;
 		unpacker->size = 0; // discard previous packets
+		if (unpacker->au.nalu >= 0)
+			rtp_payload_frame_abort(&unpacker->au);
 	}
 	unpacker->seq = (uint16_t)pkt.rtp.seq;
 
@@ -311,24 +370,40 @@ static int rtp_h264_unpack_input(void* p, const void* packet, int bytes)
 		return 0; // packet discard
 
 	case 24: // STAP-A
-		return rtp_h264_unpack_stap(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 0);
+		r = rtp_h264_unpack_stap(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 0);
+		break;
 	case 25: // STAP-B
-		return rtp_h264_unpack_stap(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 1);
+		r = rtp_h264_unpack_stap(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 1);
+		break;
 	case 26: // MTAP16
-		return rtp_h264_unpack_mtap(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 2);
+		r = rtp_h264_unpack_mtap(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 2);
+		break;
 	case 27: // MTAP24
-		return rtp_h264_unpack_mtap(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 3);
+		r = rtp_h264_unpack_mtap(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 3);
+		break;
 	case 28: // FU-A
-		return rtp_h264_unpack_fu(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 0);
+		r = rtp_h264_unpack_fu(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 0);
+		break;
 	case 29: // FU-B
-		return rtp_h264_unpack_fu(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 1);
+		r = rtp_h264_unpack_fu(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, 1);
+		break;
 
 	default: // 1-23 NAL unit
-		r = unpacker->handler.packet(unpacker->cbparam, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp, unpacker->flags);
+		r = rtp_h264_unpack_nalu(unpacker, (const uint8_t*)pkt.payload, pkt.payloadlen, pkt.rtp.timestamp);
+		r = 0 == r ? 1 : r; // packet handled
+		break;
+	}
+
+	// marker bit: the last packet of the access unit
+	if (unpacker->au.enable && pkt.rtp.m && unpacker->au.nalu < 0 && r >= 0)
+	{
+		// packets discarded after a hole(e.g. FU tail) belong to this frame, not the next one
+		unpacker->au.flags |= unpacker->flags;
 		unpacker->flags = 0;
-		unpacker->size = 0;
-		return 0 == r ? 1 : r; // packet handled
+		n = rtp_payload_frame_flush(&unpacker->au);
+		r = 0 == n ? r : n;
 	}
+	return r;
 }
 
 struct rtp_payload_decode_t *rtp_h264_decode()
@@ -337,6 +412,7 @@ struct rtp_payload_decode_t *rtp_h264_decode()
 		rtp_h264_unpack_create,
 		rtp_h264_unpack_destroy,
 		rtp_h264_unpack_input,
+		rtp_h264_unpack_setframe,
 	};
 
 	return &unpacker;
@@ -5,6 +5,7 @@
 
 #include "rtp-packet.h"
 #include "rtp-payload-internal.h"
+#include "mpeg4-annexb.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -19,6 +20,7 @@
 struct rtp_encode_h265_t
 {
 	struct rtp_packet_t pkt;
+	uint8_t header[RTP_FIXED_HEADER]; // fixed header template
 	struct rtp_payload_t handler;
 	void* cbparam;
 	int size;
@@ -38,6 +40,7 @@ static void* rtp_h265_pack_create(int size, uint8_t pt, uint16_t seq, uint32_t s
 	packer->pkt.rtp.pt = pt;
 	packer->pkt.rtp.seq = seq;
 	packer->pkt.rtp.ssrc = ssrc;
+	rtp_packet_header_template(packer->header, pt, ssrc);
 	return packer;
 }
 
@@ -53,12 +56,8 @@ static void rtp_h265_pack_destroy(void* pack)
 
 static const uint8_t* h265_nalu_find(const uint8_t* p, const uint8_t* end)
 {
-	for (p += 2; p + 1 < end; p++)
-	{
-		if (0x01 == *p && 0x00 == *(p - 1) && 0x00 == *(p - 2))
-			return p + 1;
-	}
-	return end;
+	p = mpeg4_annexb_nalu_find(p, end);
+	return p ? p : end;
 }
 
 static void rtp_h265_pack_get_info(void* pack, uint16_t* seq, uint32_t* timestamp)
@@ -82,12 +81,9 @@ static int rtp_h265_pack_nalu(struct rtp_encode_h265_t *packer, const uint8_t* n
 
 	//packer->pkt.rtp.m = 1; // set marker flag
 	packer->pkt.rtp.m = ((*nalu >> 1) & 0x3f) < 32 ? mark : 0; // VCL only
-	n = rtp_packet_serialize(&packer->pkt, rtp, n);
-	if (n != RTP_FIXED_HEADER + packer->pkt.payloadlen)
-	{
-		assert(0);
-		return -1;
-	}
+	n = rtp_packet_header_write(rtp, packer->header, &packer->pkt.rtp);
+	memcpy(rtp + n, packer->pkt.payload, packer->pkt.payloadlen);
+	n += packer->pkt.payloadlen;
 
 	++packer->pkt.rtp.seq;
 	r = packer->handler.packet(packer->cbparam, rtp, n, packer->pkt.rtp.timestamp, 0);
@@ -127,12 +123,7 @@ static int rtp_h265_pack_fu(struct rtp_encode_h265_t *packer, const uint8_t* ptr
 		if (!rtp) return ENOMEM;
 
 		packer->pkt.rtp.m = (FU_END & fu_header) ? mark : 0; // set marker flag
-		n = rtp_packet_serialize_header(&packer->pkt, rtp, n);
-		if (n != RTP_FIXED_HEADER)
-		{
-			assert(0);
-			return -1;
-		}
+		n = rtp_packet_header_write(rtp, packer->header, &packer->pkt.rtp);
 
 		/*header + fu_header*/
 		rtp[n + 0] = 49 << 1;
@@ -2,6 +2,7 @@
 
 #include "rtp-packet.h"
 #include "rtp-payload-internal.h"
+#include "rtp-payload-frame.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -21,6 +22,7 @@ NUH temporal ID plus 1 (TID) : 3 bits
 */
 
 #define H265_TYPE(v) ((v >> 1) & 0x3f)
+#define H265_IRAP(v) (H265_TYPE(v) >= 16 && H265_TYPE(v) <= 23 ? RTP_PAYLOAD_FLAG_KEYFRAME : 0) // BLA/IDR/CRA
 
 #define FU_START(v) (v & 0x80)
 #define FU_END(v)	(v & 0x40)
@@ -39,6 +41,8 @@ struct rtp_decode_h265_t
 
 	int flags;
 	int using_donl_field;
+
+	struct rtp_payload_frame_helper_t au; // access unit mode
 };
 
 static void* rtp_h265_unpack_create(struct rtp_payload_t *handler, void* param)
@@ -51,6 +55,7 @@ static void* rtp_h265_unpack_create(struct rtp_payload_t *handler, void* param)
 	memcpy(&unpacker->handler, handler, sizeof(unpacker->handler));
 	unpacker->cbparam = param;
 	unpacker->flags = -1;
+	rtp_payload_frame_init(&unpacker->au, &unpacker->handler, param);
 	return unpacker;
 }
 
@@ -61,12 +66,33 @@ static void rtp_h265_unpack_destroy(void* p)
 
 	if (unpacker->ptr)
 		free(unpacker->ptr);
+	rtp_payload_frame_destroy(&unpacker->au);
 #if defined(_DEBUG) || defined(DEBUG)
 	memset(unpacker, 0xCC, sizeof(*unpacker));
 #endif
 	free(unpacker);
 }
 
+static int rtp_h265_unpack_setframe(void* p, const struct rtp_payload_frame_t* frame)
+{
+	struct rtp_decode_h265_t *unpacker;
+	unpacker = (struct rtp_decode_h265_t *)p;
+	unpacker->size = 0; // discard incomplete FU
+	return rtp_payload_frame_set(&unpacker->au, frame);
+}
+
+static int rtp_h265_unpack_nalu(struct rtp_decode_h265_t *unpacker, const uint8_t* nalu, int bytes, uint32_t timestamp)
+{
+	int r;
+	if (unpacker->au.enable)
+		r = rtp_payload_frame_write(&unpacker->au, timestamp, unpacker->flags | H265_IRAP(nalu[0]), nalu, bytes);
+	else
+		r = unpacker->handler.packet(unpacker->cbparam, nalu, bytes, timestamp, unpacker->flags);
+	unpacker->flags = 0;
+	unpacker->size = 0;
+	return r;
+}
+
 // 4.4.2. Aggregation Packets (APs) (p25)
 /*
  0               1               2               3
@@ -118,9 +144,7 @@ static int rtp_h265_unpack_ap(struct rtp_decode_h265_t *unpacker, const uint8_t*
 		}
 
 		assert(H265_TYPE(ptr[2]) >= 0 && H265_TYPE(ptr[2]) < 48);
-		r = unpacker->handler.packet(unpacker->cbparam, ptr + 2, len, timestamp, unpacker->flags);
-		unpacker->flags = 0;
-		unpacker->size = 0;
+		r = rtp_h265_unpack_nalu(unpacker, ptr + 2, len, timestamp);
 
 		ptr += len + 2; // next NALU
 		n = 2 /*LEN*/ + (unpacker->using_donl_field ? 1 : 0);
@@ -150,6 +174,38 @@ static int rtp_h265_unpack_ap(struct rtp_decode_h265_t *unpacker, const uint8_t*
 |S|E|   FuType  |
 +---------------+
 */
+// FU payload to the caller frame buffer, no reassembly buffer
+static int rtp_h265_unpack_fu_frame(struct rtp_decode_h265_t *unpacker, const uint8_t* ptr, int bytes, uint32_t timestamp, int n)
+{
+	int r;
+	uint8_t nalu[2];
+	uint8_t fuheader;
+
+	r = 0;
+	fuheader = ptr[2];
+	if (FU_START(fuheader))
+	{
+		nalu[0] = (FU_NAL(fuheader) << 1) | (ptr[0] & 0x81); // replace NAL Unit Type Bits
+		nalu[1] = ptr[1];
+		r = rtp_payload_frame_begin(&unpacker->au, timestamp, unpacker->flags | H265_IRAP(nalu[0]), nalu, 2);
+		unpacker->flags = 0;
+	}
+	else if (unpacker->au.nalu < 0)
+	{
+		unpacker->flags = RTP_PAYLOAD_FLAG_PACKET_LOST;
+		return 0; // packet discard
+	}
+
+	if (unpacker->au.nalu < 0)
+		return r; // alloc failed
+	if (bytes > n && 0 != rtp_payload_frame_append(&unpacker->au, ptr + n, bytes - n))
+		return -ENOMEM;
+	if (FU_END(fuheader))
+		rtp_payload_frame_end(&unpacker->au);
+
+	return 0 == r ? 1 : r; // packet handled
+}
+
 static int rtp_h265_unpack_fu(struct rtp_decode_h265_t *unpacker, const uint8_t* ptr, int bytes, uint32_t timestamp)
 {
 	int r, n;
@@ -163,6 +219,9 @@ static int rtp_h265_unpack_fu(struct rtp_decode_h265_t *unpacker, const uint8_t*
 		return -EINVAL;
 	}
 
+	if (unpacker->au.enable)
+		return rtp_h265_unpack_fu_frame(unpacker, ptr, bytes, timestamp, n);
+
 	if (unpacker->size + bytes - n + 2 /*NALU*/ > unpacker->capacity)
 	{
 		void* p = NULL;
@@ -248,6 +307,8 @@ static int rtp_h265_unpack_input(void* p, const void* packet, int bytes)
 	{
 		unpacker->flags = RTP_PAYLOAD_FLAG_PACKET_LOST;
 		unpacker->size = 0; // discard previous packets
+		if (unpacker->au.nalu >= 0)
+			rtp_payload_frame_abort(&unpacker->au);
 	}
 	unpacker->seq = (uint16_t)pkt.rtp.seq;
 
@@ -261,10 +322,12 @@ static int rtp_h265_unpack_input(void* p, const void* packet, int bytes)
 	switch (nal)
 	{
 	case 48: // aggregated packet (AP) - with two or more NAL units
-		return rtp_h265_unpack_ap(unpacker, ptr, pkt.payloadlen, pkt.rtp.timestamp);
+		r = rtp_h265_unpack_ap(unpacker, ptr, pkt.payloadlen, pkt.rtp.timestamp);
+		break;
 
 	case 49: // fragmentation unit (FU)
-		return rtp_h265_unpack_fu(unpacker, ptr, pkt.payloadlen, pkt.rtp.timestamp);
+		r = rtp_h265_unpack_fu(unpacker, ptr, pkt.payloadlen, pkt.rtp.timestamp);
+		break;
 
 	case 50: // TODO: 4.4.4. PACI Packets (p32)
 		assert(0);
@@ -275,11 +338,21 @@ static int rtp_h265_unpack_input(void* p, const void* packet, int bytes)
 	case 34: // picture parameter set (PPS)
 	case 39: // supplemental enhancement information (SEI)
 	default: // 4.4.1. Single NAL Unit Packets (p24)
-		r = unpacker->handler.packet(unpacker->cbparam, ptr, pkt.payloadlen, pkt.rtp.timestamp, unpacker->flags);
+		r = rtp_h265_unpack_nalu(unpacker, ptr, pkt.payloadlen, pkt.rtp.timestamp);
+		r = 0 == r ? 1 : r; // packet handled
+		break;
+	}
+
+	// marker bit: the last packet of the access unit
+	if (unpacker->au.enable && pkt.rtp.m && unpacker->au.nalu < 0 && r >= 0)
+	{
+		// packets discarded after a hole(e.g. FU tail) belong to this frame, not the next one
+		unpacker->au.flags |= unpacker->flags;
 		unpacker->flags = 0;
-		unpacker->size = 0;
-		return 0 == r ? 1 : r; // packet handled
+		nal = rtp_payload_frame_flush(&unpacker->au);
+		r = 0 == nal ? r : nal;
 	}
+	return r;
 }
 
 struct rtp_payload_decode_t *rtp_h265_decode()
@@ -288,6 +361,7 @@ struct rtp_payload_decode_t *rtp_h265_decode()
 		rtp_h265_unpack_create,
 		rtp_h265_unpack_destroy,
 		rtp_h265_unpack_input,
+		rtp_h265_unpack_setframe,
 	};
 
 	return &unpacker;
@@ -16,6 +16,7 @@
 struct rtp_encode_mp4a_latm_t
 {
 	struct rtp_packet_t pkt;
+	uint8_t header[RTP_FIXED_HEADER]; // fixed header template
 	struct rtp_payload_t handler;
 	void* cbparam;
 	int size;
@@ -35,6 +36,7 @@ static void* rtp_mp4a_latm_pack_create(int size, uint8_t pt, uint16_t seq, uint3
 	packer->pkt.rtp.pt = pt;
 	packer->pkt.rtp.seq = seq;
 	packer->pkt.rtp.ssrc = ssrc;
+	rtp_packet_header_template(packer->header, pt, ssrc);
 	return packer;
 }
 
@@ -104,12 +106,7 @@ static int rtp_mp4a_latm_pack_input(void* pack, const void* data, int bytes, uin
 		// It is set to 1 to indicate that the RTP packet contains a complete
 		// audioMuxElement or the last fragment of an audioMuxElement.
 		packer->pkt.rtp.m = (0 == bytes) ? 1 : 0;
-		n = rtp_packet_serialize_header(&packer->pkt, rtp, n);
-		if (n != RTP_FIXED_HEADER)
-		{
-			assert(0);
-			return -1;
-		}
+		n = rtp_packet_header_write(rtp, packer->header, &packer->pkt.rtp);
 
 		if (len > 0) memcpy(rtp + n, hd, len);
 		memcpy(rtp + n + len, packer->pkt.payload, packer->pkt.payloadlen);
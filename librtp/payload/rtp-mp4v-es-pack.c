@@ -31,6 +31,7 @@
 struct rtp_encode_mp4v_es_t
 {
 	struct rtp_packet_t pkt;
+	uint8_t header[RTP_FIXED_HEADER]; // fixed header template
 	struct rtp_payload_t handler;
 	void* cbparam;
 	int size;
@@ -50,6 +51,7 @@ static void* rtp_mp4v_es_encode_create(int size, uint8_t pt, uint16_t seq, uint3
 	packer->pkt.rtp.pt = pt;
 	packer->pkt.rtp.seq = seq;
 	packer->pkt.rtp.ssrc = ssrc;
+	rtp_packet_header_template(packer->header, pt, ssrc);
 	return packer;
 }
 
@@ -94,12 +96,9 @@ static int rtp_mp4v_es_encode_input(void* pack, const void* data, int bytes, uin
 		if (!rtp) return ENOMEM;
 
 		packer->pkt.rtp.m = (0 == bytes) ? 1 : 0;
-		n = rtp_packet_serialize(&packer->pkt, rtp, n);
-		if (n != RTP_FIXED_HEADER + packer->pkt.payloadlen)
-		{
-			assert(0);
-			return -1;
-		}
+		n = rtp_packet_header_write(rtp, packer->header, &packer->pkt.rtp);
+		memcpy(rtp + n, packer->pkt.payload, packer->pkt.payloadlen);
+		n += packer->pkt.payloadlen;
 
 		r = packer->handler.packet(packer->cbparam, rtp, n, packer->pkt.rtp.timestamp, 0);
 		packer->handler.free(packer->cbparam, rtp);
@@ -24,6 +24,7 @@
 struct rtp_encode_mpeg4_generic_t
 {
 	struct rtp_packet_t pkt;
+	uint8_t header[RTP_FIXED_HEADER]; // fixed header template
 	struct rtp_payload_t handler;
 	void* cbparam;
 	int size;
@@ -43,6 +44,7 @@ static void* rtp_mpeg4_generic_pack_create(int size, uint8_t pt, uint16_t seq, u
 	packer->pkt.rtp.pt = pt;
 	packer->pkt.rtp.seq = seq;
 	packer->pkt.rtp.ssrc = ssrc;
+	rtp_packet_header_template(packer->header, pt, ssrc);
 	return packer;
 }
 
@@ -107,12 +109,7 @@ static int rtp_mpeg4_generic_pack_input(void* pack, const void* data, int bytes,
 		// payload contains either the final fragment of a fragmented Access
 		// Unit or one or more complete Access Units
 		packer->pkt.rtp.m = (0 == bytes) ? 1 : 0;
-		n = rtp_packet_serialize_header(&packer->pkt, rtp, n);
-		if (n != RTP_FIXED_HEADER)
-		{
-			assert(0);
-			return -1;
-		}
+		n = rtp_packet_header_write(rtp, packer->header, &packer->pkt.rtp);
 
 		memcpy(rtp + n, header, N_AU_HEADER);
 		memcpy(rtp + n + N_AU_HEADER, packer->pkt.payload, packer->pkt.payloadlen);
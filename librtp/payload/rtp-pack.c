@@ -13,6 +13,7 @@ struct rtp_packer_t
 	void* cbparam;
 
 	struct rtp_packet_t pkt;
+	uint8_t header[RTP_FIXED_HEADER]; // fixed header template
 	int size;
 };
 
@@ -30,6 +31,7 @@ static void* rtp_pack_create(int size, uint8_t pt, uint16_t seq, uint32_t ssrc,
 	packer->pkt.rtp.pt = pt;
 	packer->pkt.rtp.seq = seq;
 	packer->pkt.rtp.ssrc = ssrc;
+	rtp_packet_header_template(packer->header, pt, ssrc);
 	return packer;
 }
 
@@ -75,12 +77,9 @@ int rtp_pack_input(void* p, const void* data, int bytes, uint32_t timestamp)
 		rtp = (uint8_t*)packer->handler.alloc(packer->cbparam, n);
 		if (!rtp) return ENOMEM;
 
-		n = rtp_packet_serialize(&packer->pkt, rtp, n);
-		if (n != RTP_FIXED_HEADER + packer->pkt.payloadlen)
-		{
-			assert(0);
-			return -1;
-		}
+		n = rtp_packet_header_write(rtp, packer->header, &packer->pkt.rtp);
+		memcpy(rtp + n, packer->pkt.payload, packer->pkt.payloadlen);
+		n += packer->pkt.payloadlen;
 
 		r = packer->handler.packet(packer->cbparam, rtp, n, packer->pkt.rtp.timestamp, 0);
 		packer->handler.free(packer->cbparam, rtp);
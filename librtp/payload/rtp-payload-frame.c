@@ -0,0 +1,169 @@
+#include "rtp-payload-frame.h"
+#include "rtp-param.h"
+#include "rtp-util.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define RTP_FRAME_PREFIX 4 // start code or NALU length
+
+void rtp_payload_frame_init(struct rtp_payload_frame_helper_t* helper, struct rtp_payload_t* handler, void* cbparam)
+{
+	memset(helper, 0, sizeof(*helper));
+	helper->handler = handler;
+	helper->cbparam = cbparam;
+	helper->nalu = -1;
+}
+
+static void rtp_payload_frame_release(struct rtp_payload_frame_helper_t* helper)
+{
+	if (helper->ptr && helper->frame.free)
+		helper->frame.free(helper->cbparam, helper->ptr);
+	else if (helper->ptr)
+		free(helper->ptr);
+	helper->ptr = NULL;
+	helper->capacity = 0;
+}
+
+void rtp_payload_frame_destroy(struct rtp_payload_frame_helper_t* helper)
+{
+	rtp_payload_frame_release(helper);
+	helper->enable = 0;
+	helper->size = 0;
+	helper->nalu = -1;
+}
+
+int rtp_payload_frame_set(struct rtp_payload_frame_helper_t* helper, const struct rtp_payload_frame_t* frame)
+{
+	if (frame && !frame->alloc != !frame->free)
+		return -EINVAL;
+
+	rtp_payload_frame_destroy(helper);
+	if (frame)
+		memcpy(&helper->frame, frame, sizeof(helper->frame));
+	else
+		memset(&helper->frame, 0, sizeof(helper->frame));
+	helper->enable = frame ? 1 : 0;
+	return 0;
+}
+
+void rtp_payload_frame_reset(struct rtp_payload_frame_helper_t* helper)
+{
+	// internal buffer is reused by the next frame
+	if (helper->frame.free)
+		rtp_payload_frame_release(helper);
+	helper->size = 0;
+	helper->nalu = -1;
+}
+
+static int rtp_payload_frame_alloc(struct rtp_payload_frame_helper_t* helper, int bytes)
+{
+	void* p;
+	int size, capacity;
+
+	size = helper->size + bytes;
+	if (size > RTP_PAYLOAD_MAX_SIZE)
+	{
+		assert(0);
+		rtp_payload_frame_reset(helper);
+		helper->flags |= RTP_PAYLOAD_FLAG_PACKET_LOST;
+		return -EINVAL;
+	}
+
+	if (size > helper->hint)
+		size += size / 4 > 128000 ? size / 4 : 128000;
+	else
+		size = helper->hint; // most frames fit in one alloc
+
+	capacity = size;
+	p = helper->frame.alloc ? helper->frame.alloc(helper->cbparam, size, &capacity) : realloc(helper->ptr, size);
+	if (!p)
+	{
+		rtp_payload_frame_reset(helper);
+		helper->flags |= RTP_PAYLOAD_FLAG_PACKET_LOST;
+		return -ENOMEM;
+	}
+	assert(capacity >= size);
+
+	if (helper->ptr && helper->frame.alloc)
+	{
+		memcpy(p, helper->ptr, helper->size);
+		helper->frame.free(helper->cbparam, helper->ptr);
+	}
+	helper->ptr = (uint8_t*)p;
+	helper->capacity = capacity > size ? capacity : size;
+	return 0;
+}
+
+int rtp_payload_frame_begin(struct rtp_payload_frame_helper_t* helper, uint32_t timestamp, int flags, const uint8_t* header, int bytes)
+{
+	int r, e;
+
+	r = 0;
+	if (helper->nalu >= 0)
+		rtp_payload_frame_abort(helper);
+	if (helper->size > 0 && helper->timestamp != timestamp)
+		r = rtp_payload_frame_flush(helper);
+
+	if (helper->size + RTP_FRAME_PREFIX + bytes > helper->capacity && 0 != (e = rtp_payload_frame_alloc(helper, RTP_FRAME_PREFIX + bytes)))
+		return e;
+
+	helper->nalu = helper->size;
+	helper->ptr[helper->size++] = 0;
+	helper->ptr[helper->size++] = 0;
+	helper->ptr[helper->size++] = 0;
+	helper->ptr[helper->size++] = 1;
+	memcpy(helper->ptr + helper->size, header, bytes);
+	helper->size += bytes;
+	helper->timestamp = timestamp;
+	helper->flags |= flags;
+	return r;
+}
+
+int rtp_payload_frame_append(struct rtp_payload_frame_helper_t* helper, const uint8_t* data, int bytes)
+{
+	int r;
+	assert(helper->nalu >= 0);
+	if (helper->size + bytes > helper->capacity && 0 != (r = rtp_payload_frame_alloc(helper, bytes)))
+		return r;
+
+	memcpy(helper->ptr + helper->size, data, bytes);
+	helper->size += bytes;
+	return 0;
+}
+
+void rtp_payload_frame_end(struct rtp_payload_frame_helper_t* helper)
+{
+	assert(helper->nalu >= 0 && helper->nalu + RTP_FRAME_PREFIX <= helper->size);
+	if (helper->frame.avcc)
+		nbo_w32(helper->ptr + helper->nalu, (uint32_t)(helper->size - helper->nalu - RTP_FRAME_PREFIX));
+	helper->nalu = -1;
+}
+
+void rtp_payload_frame_abort(struct rtp_payload_frame_helper_t* helper)
+{
+	if (helper->nalu >= 0)
+	{
+		helper->size = helper->nalu;
+		helper->nalu = -1;
+	}
+	helper->flags |= RTP_PAYLOAD_FLAG_PACKET_LOST;
+}
+
+int rtp_payload_frame_flush(struct rtp_payload_frame_helper_t* helper)
+{
+	int r;
+
+	r = 0;
+	assert(helper->nalu < 0);
+	if (helper->size > 0)
+	{
+		r = helper->handler->packet(helper->cbparam, helper->ptr, helper->size, helper->timestamp, helper->flags);
+		helper->hint = helper->size > helper->hint ? helper->size : helper->hint;
+		helper->flags = 0;
+	}
+
+	rtp_payload_frame_reset(helper);
+	return r;
+}
@@ -0,0 +1,63 @@
+#ifndef _rtp_payload_frame_h_
+#define _rtp_payload_frame_h_
+
+#include "rtp-payload.h"
+
+/// H.264/H.265 access unit writer(rtp_payload_decode_setframe)
+/// NALU layout: 4-bytes prefix(start code or length) + NALU header + NALU payload
+struct rtp_payload_frame_helper_t
+{
+	struct rtp_payload_frame_t frame; // frame.alloc == NULL: internal buffer
+	int enable;
+	struct rtp_payload_t* handler;
+	void* cbparam;
+
+	uint8_t* ptr; // caller or internal frame buffer
+	int size, capacity;
+	int hint; // largest frame size, alloc size of next frame
+
+	int nalu; // current NALU prefix offset, -1 if none
+	uint32_t timestamp;
+	int flags;
+};
+
+void rtp_payload_frame_init(struct rtp_payload_frame_helper_t* helper, struct rtp_payload_t* handler, void* cbparam);
+
+void rtp_payload_frame_destroy(struct rtp_payload_frame_helper_t* helper);
+
+/// @param[in] frame NULL-disable access unit mode, alloc/free NULL-internal buffer
+int rtp_payload_frame_set(struct rtp_payload_frame_helper_t* helper, const struct rtp_payload_frame_t* frame);
+
+/// drop pending frame(don't call handler packet)
+void rtp_payload_frame_reset(struct rtp_payload_frame_helper_t* helper);
+
+/// start a new NALU, deliver previous frame if timestamp changed
+/// @param[in] header NALU header(H.264: 1-byte, H.265: 2-bytes) or whole NALU
+/// @return 0-ok, <0-error(frame dropped)
+int rtp_payload_frame_begin(struct rtp_payload_frame_helper_t* helper, uint32_t timestamp, int flags, const uint8_t* header, int bytes);
+
+/// append NALU payload, must between rtp_payload_frame_begin and rtp_payload_frame_end
+/// @return 0-ok, <0-error(frame dropped)
+int rtp_payload_frame_append(struct rtp_payload_frame_helper_t* helper, const uint8_t* data, int bytes);
+
+/// complete current NALU(write NALU length prefix)
+void rtp_payload_frame_end(struct rtp_payload_frame_helper_t* helper);
+
+/// discard incomplete NALU, e.g. FU packet lost
+void rtp_payload_frame_abort(struct rtp_payload_frame_helper_t* helper);
+
+/// deliver completed NALUs as one frame
+/// @return 0-ok, other-handler packet return value
+int rtp_payload_frame_flush(struct rtp_payload_frame_helper_t* helper);
+
+/// write a whole NALU(single NAL unit/aggregation packet)
+static inline int rtp_payload_frame_write(struct rtp_payload_frame_helper_t* helper, uint32_t timestamp, int flags, const uint8_t* nalu, int bytes)
+{
+	int r;
+	r = rtp_payload_frame_begin(helper, timestamp, flags, nalu, bytes);
+	if (0 == r)
+		rtp_payload_frame_end(helper);
+	return r;
+}
+
+#endif /* !_rtp_payload_frame_h_ */
@@ -43,6 +43,9 @@ struct rtp_payload_decode_t
 	/// @param[in] time stream UTC time
 	/// @return 1-packet handled, 0-packet discard, <0-failed
 	int (*input)(void* decoder, const void* packet, int bytes);
+
+	/// optional, access unit mode(see rtp_payload_decode_setframe)
+	int (*setframe)(void* decoder, const struct rtp_payload_frame_t* frame);
 };
 
 struct rtp_payload_encode_t *rtp_ts_encode(void);
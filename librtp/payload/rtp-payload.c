@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <errno.h>
 
 #define TS_PACKET_SIZE 188
 
@@ -17,11 +18,65 @@ struct rtp_payload_delegate_t
 	struct rtp_payload_encode_t* encoder;
 	struct rtp_payload_decode_t* decoder;
 	void* packer;
+
+	// encoder only, forward packets to user handler or batch arena
+	struct rtp_payload_t handler;
+	void* cbparam;
+	struct rtp_payload_batch_t* batch;
 };
 
+static void* rtp_payload_encode_alloc(void* param, int bytes)
+{
+	struct rtp_payload_batch_t* batch;
+	struct rtp_payload_delegate_t* ctx;
+	ctx = (struct rtp_payload_delegate_t*)param;
+	batch = ctx->batch;
+	if (!batch)
+		return ctx->handler.alloc(ctx->cbparam, bytes);
+
+	// packer alloc-packet-free one by one, the arena moves on packet
+	if (batch->count >= batch->num || batch->offset + bytes > batch->capacity)
+		return NULL;
+	return batch->arena + batch->offset;
+}
+
+static void rtp_payload_encode_free(void* param, void *packet)
+{
+	struct rtp_payload_delegate_t* ctx;
+	ctx = (struct rtp_payload_delegate_t*)param;
+	if (!ctx->batch)
+		ctx->handler.free(ctx->cbparam, packet);
+}
+
+static int rtp_payload_encode_packet(void* param, const void *packet, int bytes, uint32_t timestamp, int flags)
+{
+	struct rtp_payload_batch_t* batch;
+	struct rtp_payload_packet_t* pkt;
+	struct rtp_payload_delegate_t* ctx;
+	ctx = (struct rtp_payload_delegate_t*)param;
+	batch = ctx->batch;
+	if (!batch)
+		return ctx->handler.packet(ctx->cbparam, packet, bytes, timestamp, flags);
+
+	assert(packet == batch->arena + batch->offset && batch->offset + bytes <= batch->capacity);
+	pkt = &batch->pkts[batch->count++];
+	pkt->ptr = batch->arena + batch->offset;
+	pkt->bytes = bytes;
+	pkt->timestamp = timestamp;
+	pkt->flags = flags;
+	batch->offset += bytes;
+	return 0;
+}
+
 /// @return 0-ok, <0-error
 static int rtp_payload_find(int payload, const char* encoding, struct rtp_payload_delegate_t* codec);
 
+static struct rtp_payload_t s_encode_handler = {
+	rtp_payload_encode_alloc,
+	rtp_payload_encode_free,
+	rtp_payload_encode_packet,
+};
+
 void* rtp_payload_encode_create(int payload, const char* name, uint16_t seq, uint32_t ssrc, struct rtp_payload_t *handler, void* cbparam)
 {
 	int size;
@@ -30,9 +85,13 @@ void* rtp_payload_encode_create(int payload, const char* name, uint16_t seq, uin
 	ctx = calloc(1, sizeof(*ctx));
 	if (ctx)
 	{
+		if (handler)
+			memcpy(&ctx->handler, handler, sizeof(ctx->handler));
+		ctx->cbparam = cbparam;
+
 		size = rtp_packet_getsize();
 		if (rtp_payload_find(payload, name, ctx) < 0
-			|| NULL == (ctx->packer = ctx->encoder->create(size, (uint8_t)payload, seq, ssrc, handler, cbparam)))
+			|| NULL == (ctx->packer = ctx->encoder->create(size, (uint8_t)payload, seq, ssrc, &s_encode_handler, ctx)))
 		{
 			free(ctx);
 			return NULL;
@@ -63,6 +122,22 @@ int rtp_payload_encode_input(void* encoder, const void* data, int bytes, uint32_
 	return ctx->encoder->input(ctx->packer, data, bytes, timestamp);
 }
 
+int rtp_payload_encode_batch(void* encoder, struct rtp_payload_batch_t* batch, const void* data, int bytes, uint32_t timestamp)
+{
+	int r, count;
+	struct rtp_payload_delegate_t* ctx;
+	ctx = (struct rtp_payload_delegate_t*)encoder;
+
+	count = batch->count;
+	ctx->batch = batch;
+	r = ctx->encoder->input(ctx->packer, data, bytes, timestamp);
+	ctx->batch = NULL;
+
+	if (0 != r)
+		return r < 0 && -ENOMEM != r ? r : -E2BIG; // arena or packet descriptors run out
+	return batch->count - count;
+}
+
 void* rtp_payload_decode_create(int payload, const char* name, struct rtp_payload_t *handler, void* cbparam)
 {
 	struct rtp_payload_delegate_t* ctx;
@@ -94,6 +169,22 @@ int rtp_payload_decode_input(void* decoder, const void* packet, int bytes)
 	return ctx->decoder->input(ctx->packer, packet, bytes);
 }
 
+int rtp_payload_decode_setframe(void* decoder, const struct rtp_payload_frame_t* frame)
+{
+	struct rtp_payload_delegate_t* ctx;
+	ctx = (struct rtp_payload_delegate_t*)decoder;
+	if (!ctx->decoder->setframe)
+		return -ENOSYS;
+	return ctx->decoder->setframe(ctx->packer, frame);
+}
+
+int rtp_payload_decode_setflags(void* decoder, int flags)
+{
+	struct rtp_payload_frame_t frame;
+	memset(&frame, 0, sizeof(frame)); // internal buffer, start code
+	return rtp_payload_decode_setframe(decoder, (flags & RTP_PAYLOAD_DECODE_FLAG_ACCESS_UNIT) ? &frame : NULL);
+}
+
 // Default max packet size (1500, minus allowance for IP, UDP, UMTP headers)
 // (Also, make it a multiple of 4 bytes, just in case that matters.)
 //static int s_max_packet_size = 1456; // from Live555 MultiFrameRTPSink.cpp RTP_PAYLOAD_MAX_SIZE
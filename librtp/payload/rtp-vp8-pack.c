@@ -17,6 +17,7 @@
 struct rtp_encode_vp8_t
 {
 	struct rtp_packet_t pkt;
+	uint8_t header[RTP_FIXED_HEADER]; // fixed header template
 	struct rtp_payload_t handler;
 	void* cbparam;
 	int size;
@@ -36,6 +37,7 @@ static void* rtp_vp8_pack_create(int size, uint8_t pt, uint16_t seq, uint32_t ss
 	packer->pkt.rtp.pt = pt;
 	packer->pkt.rtp.seq = seq;
 	packer->pkt.rtp.ssrc = ssrc;
+	rtp_packet_header_template(packer->header, pt, ssrc);
 	return packer;
 }
 
@@ -83,12 +85,7 @@ static int rtp_vp8_pack_input(void* pack, const void* data, int bytes, uint32_t
 		// Marker bit (M): MUST be set for the very last packet of each encoded
 		// frame in line with the normal use of the M bit in video formats.
 		packer->pkt.rtp.m = (0 == bytes) ? 1 : 0;
-		n = rtp_packet_serialize_header(&packer->pkt, rtp, n);
-		if (n != RTP_FIXED_HEADER)
-		{
-			assert(0);
-			return -1;
-		}
+		n = rtp_packet_header_write(rtp, packer->header, &packer->pkt.rtp);
 
 		memcpy(rtp + n, vp8_payload_descriptor, N_VP8_HEADER);
 		memcpy(rtp + n + N_VP8_HEADER, packer->pkt.payload, packer->pkt.payloadlen);
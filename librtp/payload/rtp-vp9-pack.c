@@ -16,6 +16,7 @@
 struct rtp_encode_vp9_t
 {
 	struct rtp_packet_t pkt;
+	uint8_t header[RTP_FIXED_HEADER]; // fixed header template
 	struct rtp_payload_t handler;
 	void* cbparam;
 	int size;
@@ -35,6 +36,7 @@ static void* rtp_vp9_pack_create(int size, uint8_t pt, uint16_t seq, uint32_t ss
 	packer->pkt.rtp.pt = pt;
 	packer->pkt.rtp.seq = seq;
 	packer->pkt.rtp.ssrc = ssrc;
+	rtp_packet_header_template(packer->header, pt, ssrc);
 	return packer;
 }
 
@@ -88,12 +90,7 @@ static int rtp_vp9_pack_input(void* pack, const void* data, int bytes, uint32_t
 		// if a stream is being rewritten to remove higher spatial layers.
 		packer->pkt.rtp.m = (0 == bytes) ? 1 : 0;
 		vp9_payload_descriptor[0] |= (0 == bytes) ? 0x04 : 0; // End of a layer frame.
-		n = rtp_packet_serialize_header(&packer->pkt, rtp, n);
-		if (n != RTP_FIXED_HEADER)
-		{
-			assert(0);
-			return -1;
-		}
+		n = rtp_packet_header_write(rtp, packer->header, &packer->pkt.rtp);
 
 		memcpy(rtp + n, vp9_payload_descriptor, N_VP9_HEADER);
 		memcpy(rtp + n + N_VP9_HEADER, packer->pkt.payload, packer->pkt.payloadlen);
@@ -0,0 +1,88 @@
+// RFC4585 6.3 Payload-Specific Feedback Messages
+// RFC5104 4.3 Payload-Specific Feedback Messages
+
+#include "rtp-internal.h"
+#include "rtp-util.h"
+
+void rtcp_psfb_unpack(struct rtp_context *ctx, rtcp_header_t *header, const uint8_t* ptr)
+{
+	uint32_t i;
+	struct rtcp_msg_t msg;
+	struct rtp_member *member;
+
+	if (header->length * 4 < 8) // packet sender SSRC + media source SSRC
+	{
+		assert(0);
+		return;
+	}
+
+	member = rtp_member_fetch(ctx, nbo_r32(ptr));
+	if (!member) return; // error
+
+	switch (header->rc)
+	{
+	case RTCP_PSFB_PLI:
+		// 6.3.1 Picture Loss Indication, no FCI
+		msg.type = RTCP_MSG_PLI;
+		msg.u.pli.ssrc = nbo_r32(ptr);
+		msg.u.pli.media = nbo_r32(ptr + 4);
+		ctx->handler.on_rtcp(ctx->cbparam, &msg);
+		break;
+
+	case RTCP_PSFB_FIR:
+		// RFC5104 4.3.1 Full Intra Request: SSRC(32bits) + Seq nr.(8bits) + Reserved(24bits)
+		// the "SSRC of media source" is not used and SHALL be set to 0
+		msg.type = RTCP_MSG_FIR;
+		msg.u.fir.ssrc = nbo_r32(ptr);
+		for (i = 8; i + 8 <= header->length * 4; i += 8)
+		{
+			msg.u.fir.media = nbo_r32(ptr + i);
+			msg.u.fir.seq = ptr[i + 4];
+			ctx->handler.on_rtcp(ctx->cbparam, &msg);
+		}
+		break;
+
+	default:
+		break; // SLI/RPSI/AFB, ignore
+	}
+}
+
+int rtcp_pli_pack(struct rtp_context *ctx, uint8_t* ptr, int bytes, uint32_t media)
+{
+	rtcp_header_t header;
+
+	if (bytes < 12)
+		return 12;
+
+	header.v = 2;
+	header.p = 0;
+	header.pt = RTCP_PSFB;
+	header.rc = RTCP_PSFB_PLI;
+	header.length = 2;
+	nbo_write_rtcp_header(ptr, &header);
+
+	nbo_w32(ptr + 4, ctx->self->ssrc);
+	nbo_w32(ptr + 8, media);
+	return 12;
+}
+
+int rtcp_fir_pack(struct rtp_context *ctx, uint8_t* ptr, int bytes, uint32_t media, uint8_t seq)
+{
+	rtcp_header_t header;
+
+	if (bytes < 20)
+		return 20;
+
+	header.v = 2;
+	header.p = 0;
+	header.pt = RTCP_PSFB;
+	header.rc = RTCP_PSFB_FIR;
+	header.length = 4;
+	nbo_write_rtcp_header(ptr, &header);
+
+	nbo_w32(ptr + 4, ctx->self->ssrc);
+	nbo_w32(ptr + 8, 0);
+	nbo_w32(ptr + 12, media);
+	nbo_w32(ptr + 16, (uint32_t)seq << 24);
+	return 20;
+}
@@ -0,0 +1,90 @@
+// RFC4585 6.2 Transport Layer Feedback Messages
+
+#include "rtp-internal.h"
+#include "rtp-util.h"
+
+/// @param[out] blp bitmask of following lost packets
+/// @return lost packet count in this FCI entry
+static int rtcp_nack_fci(const uint16_t* lost, int num, uint16_t* blp)
+{
+	int i;
+	uint16_t delta;
+
+	*blp = 0;
+	for (i = 1; i < num; i++)
+	{
+		delta = (uint16_t)(lost[i] - lost[0] - 1);
+		if (delta >= 16)
+			break;
+		*blp |= (uint16_t)(1 << delta);
+	}
+	return i;
+}
+
+void rtcp_rtpfb_unpack(struct rtp_context *ctx, rtcp_header_t *header, const uint8_t* ptr)
+{
+	uint32_t i;
+	struct rtcp_msg_t msg;
+	struct rtp_member *member;
+
+	if (header->length * 4 < 8) // packet sender SSRC + media source SSRC
+	{
+		assert(0);
+		return;
+	}
+
+	member = rtp_member_fetch(ctx, nbo_r32(ptr));
+	if (!member) return; // error
+
+	switch (header->rc)
+	{
+	case RTCP_RTPFB_NACK:
+		// 6.2.1 Generic NACK: PID(16bits) + BLP(16bits)
+		msg.type = RTCP_MSG_NACK;
+		msg.u.nack.ssrc = nbo_r32(ptr);
+		msg.u.nack.media = nbo_r32(ptr + 4);
+		for (i = 8; i + 4 <= header->length * 4; i += 4)
+		{
+			msg.u.nack.pid = nbo_r16(ptr + i);
+			msg.u.nack.blp = nbo_r16(ptr + i + 2);
+			ctx->handler.on_rtcp(ctx->cbparam, &msg);
+		}
+		break;
+
+	default:
+		break; // TMMBR/TMMBN, ignore
+	}
+}
+
+int rtcp_nack_pack(struct rtp_context *ctx, uint8_t* ptr, int bytes, uint32_t media, const uint16_t* lost, int num)
+{
+	int i, n;
+	uint16_t blp;
+	rtcp_header_t header;
+
+	for (n = 0, i = 0; i < num; n++)
+		i += rtcp_nack_fci(lost + i, num - i, &blp);
+
+	if (n < 1 || bytes < 12 + n * 4)
+		return 12 + n * 4;
+
+	header.v = 2;
+	header.p = 0;
+	header.pt = RTCP_RTPFB;
+	header.rc = RTCP_RTPFB_NACK;
+	header.length = (uint16_t)(2 + n);
+	nbo_write_rtcp_header(ptr, &header);
+
+	nbo_w32(ptr + 4, ctx->self->ssrc);
+	nbo_w32(ptr + 8, media);
+
+	for (ptr += 12, i = 0; i < num; ptr += 4)
+	{
+		n = rtcp_nack_fci(lost + i, num - i, &blp);
+		nbo_w16(ptr, lost[i]);
+		nbo_w16(ptr + 2, blp);
+		i += n;
+	}
+
+	return (header.length + 1) * 4;
+}
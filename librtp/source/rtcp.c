@@ -169,6 +169,14 @@ static int rtcp_parse(struct rtp_context *ctx, const unsigned char* data, size_t
 		rtcp_app_unpack(ctx, &header, data+4);
 		break;
 
+	case RTCP_RTPFB:
+		rtcp_rtpfb_unpack(ctx, &header, data+4);
+		break;
+
+	case RTCP_PSFB:
+		rtcp_psfb_unpack(ctx, &header, data+4);
+		break;
+
 	default:
 		assert(0);
 	}
@@ -12,11 +12,25 @@
 #include <stdio.h>
 #include <errno.h>
 
+#define RTP_NACK_MAX        64 // max lost packets per NACK
+#define RTP_NACK_HISTORY    256 // NACKed sequence numbers, power of 2
+#define RTP_PLI_INTERVAL    1000 // ms, min interval between two PLI
+
 struct rtp_demuxer_t
 {
     uint32_t ssrc;
     uint64_t clock; // rtcp clock
     
+    uint32_t source; // media source ssrc
+    struct
+    {
+        uint16_t seq;
+        uint64_t clock; // last NACK clock
+    } nack[RTP_NACK_HISTORY]; // nack[seq % RTP_NACK_HISTORY]
+    int nack_interval; // NACK retry interval(ms)
+    uint64_t pli_clock; // last PLI clock
+    int pli; // 1-frame lost, request key frame
+    
     uint8_t* ptr;
     int cap, max;
 
@@ -35,6 +49,11 @@ static int rtp_onpacket(void* param, const void *packet, int bytes, uint32_t tim
     
     // TODO: rtp timestamp -> pts/dts
     
+    if (flags & (RTP_PAYLOAD_FLAG_PACKET_LOST | RTP_PAYLOAD_FLAG_PACKET_CORRUPT))
+        rtp->pli = 1; // unrecoverable frame
+    else if (flags & RTP_PAYLOAD_FLAG_KEYFRAME)
+        rtp->pli = 0; // decoder recovered, access unit mode only
+    
     return rtp->onpkt ? rtp->onpkt(rtp->param, packet, bytes, timestamp, flags) : -1;
 }
 
@@ -122,6 +141,7 @@ static int rtp_demuxer_init(struct rtp_demuxer_t* rtp, int jitter, int frequency
     rtp->rtp = rtp_create(&evthandler, rtp, rtp->ssrc, timestamp, frequency ? frequency : 90000, 2 * 1024 * 1024, 0);
     
     rtp->queue = rtp_queue_create(jitter, frequency, rtp_demuxer_freepkt, rtp);
+    rtp->nack_interval = jitter / 2 > 10 ? jitter / 2 : 10; // at least one retry before the queue skip the hole
     
     return rtp->payload && rtp->rtp && rtp->queue? 0 : -1;
 }
@@ -170,6 +190,11 @@ int rtp_demuxer_destroy(struct rtp_demuxer_t** pprtp)
     return 0;
 }
 
+int rtp_demuxer_setflags(struct rtp_demuxer_t* rtp, int flags)
+{
+    return rtp_payload_decode_setflags(rtp->payload, flags);
+}
+
 int rtp_demuxer_input(struct rtp_demuxer_t* rtp, const void* data, int bytes)
 {
     int r;
@@ -186,11 +211,13 @@ int rtp_demuxer_input(struct rtp_demuxer_t* rtp, const void* data, int bytes)
         if (!pkt)
             return -1;
 
+        rtp->source = pkt->rtp.ssrc;
         r = rtp_queue_write(rtp->queue, pkt);
-        if(r < 0)
+        if(r <= 0)
         {
+            // 0-duplicate or too late packet, discard it
             rtp_demuxer_freepkt(rtp, pkt);
-            return r > 0 ? -r : r;
+            return r;
         }
         
         // re-order packet
@@ -217,6 +244,49 @@ int rtp_demuxer_input(struct rtp_demuxer_t* rtp, const void* data, int bytes)
     return r;
 }
 
+static int rtp_demuxer_feedback(struct rtp_demuxer_t* rtp, uint8_t* ptr, int len, uint64_t clock)
+{
+    int i, j, n, r;
+    uint16_t lost[RTP_NACK_MAX];
+    
+    r = 0;
+    
+    // RFC4585 6.2.1 Generic NACK
+    // new holes are NACKed at once, each hole is retried every nack_interval
+    n = rtp_queue_lost(rtp->queue, lost, sizeof(lost) / sizeof(lost[0]));
+    for (i = j = 0; i < n; i++)
+    {
+        if (rtp->nack[lost[i] % RTP_NACK_HISTORY].seq == lost[i] && rtp->nack[lost[i] % RTP_NACK_HISTORY].clock
+            && rtp->nack[lost[i] % RTP_NACK_HISTORY].clock + (uint64_t)rtp->nack_interval * 1000 >= clock)
+            continue; // NACKed recently
+        lost[j++] = lost[i];
+    }
+    
+    if (j > 0)
+    {
+        r = rtp_rtcp_nack(rtp->rtp, rtp->source, lost, j, ptr, len);
+        for (i = 0; i < j && r > 0; i++)
+        {
+            rtp->nack[lost[i] % RTP_NACK_HISTORY].seq = lost[i];
+            rtp->nack[lost[i] % RTP_NACK_HISTORY].clock = clock;
+        }
+    }
+    
+    // RFC4585 6.3.1 Picture Loss Indication
+    if (rtp->pli && rtp->pli_clock + RTP_PLI_INTERVAL * 1000 < clock && r < len)
+    {
+        n = rtp_rtcp_pli(rtp->rtp, rtp->source, ptr + r, len - r);
+        if (n > 0)
+        {
+            r += n;
+            rtp->pli = 0;
+            rtp->pli_clock = clock;
+        }
+    }
+    
+    return r;
+}
+
 int rtp_demuxer_rtcp(struct rtp_demuxer_t* rtp, void* buf, int len)
 {
     int r;
@@ -233,5 +303,9 @@ int rtp_demuxer_rtcp(struct rtp_demuxer_t* rtp, void* buf, int len)
         rtp->clock = clock;
     }
     
+    // feedback, append to the compound RTCP packet
+    if (r >= 0 && r < len)
+        r += rtp_demuxer_feedback(rtp, (uint8_t*)buf + r, len - r, clock);
+    
     return r;
 }
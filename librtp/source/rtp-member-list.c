@@ -4,14 +4,37 @@
 #include <assert.h>
 #include <errno.h>
 
-#define N_SOURCE 2 // unicast(1S + 1R)
+#define N_SOURCE 4 // unicast(1S + 1R), power of 2
+#define N_WHEEL 64 // timer wheel slots
+#define WHEEL_TICK 500000 // 500ms(rtpclock in microseconds)
+
+#define SSRC_HASH(ssrc, bits) ((uint32_t)((ssrc) * 2654435761u) >> (32 - (bits)))
+
+struct rtp_member_entry
+{
+	struct rtp_member *member;
+	uint64_t tick; // timer wheel tick
+	uint64_t clock; // first check clock, for members without RTP/RTCP clock
+};
+
+struct rtp_member_wheel
+{
+	uint32_t *ssrc; // lazy, stale ssrc skipped
+	int count;
+	int capacity;
+};
 
 struct rtp_member_list
 {
-	struct rtp_member *members[N_SOURCE];
-	struct rtp_member **ptr;
+	struct rtp_member_entry *ptr; // unordered
 	int count;
 	int capacity;
+
+	int *index; // ssrc -> ptr index, open addressing, -1-empty
+	int bits; // index size: 1 << bits, 2 * capacity
+
+	struct rtp_member_wheel wheel[N_WHEEL];
+	uint64_t tick; // last expired tick
 };
 
 void* rtp_member_list_create()
@@ -27,7 +50,13 @@ void rtp_member_list_destroy(void* members)
 
 	for(i = 0; i < p->count; i++)
 	{
-		rtp_member_release(i >= N_SOURCE ? p->ptr[i-N_SOURCE] : p->members[i]);
+		rtp_member_release(p->ptr[i].member);
+	}
+
+	for(i = 0; i < N_WHEEL; i++)
+	{
+		if(p->wheel[i].ssrc)
+			free(p->wheel[i].ssrc);
 	}
 
 	if(p->ptr)
@@ -36,6 +65,9 @@ void rtp_member_list_destroy(void* members)
 		free(p->ptr);
 	}
 
+	if(p->index)
+		free(p->index);
+
 	free(p);
 }
 
@@ -53,48 +85,106 @@ struct rtp_member* rtp_member_list_get(void* members, int index)
 	if(index >= p->count || index < 0)
 		return NULL;
 
-	return index >= N_SOURCE ? p->ptr[index-N_SOURCE] : p->members[index];
+	return p->ptr[index].member;
+}
+
+/// @return ssrc slot or empty slot
+static int rtp_member_list_slot(struct rtp_member_list *p, uint32_t ssrc)
+{
+	int i, mask;
+	mask = (1 << p->bits) - 1;
+	for(i = SSRC_HASH(ssrc, p->bits); p->index[i] >= 0; i = (i + 1) & mask)
+	{
+		if(p->ptr[p->index[i]].member->ssrc == ssrc)
+			break;
+	}
+	return i;
 }
 
 struct rtp_member* rtp_member_list_find(void* members, uint32_t ssrc)
 {
 	int i;
-	struct rtp_member *s;
 	struct rtp_member_list *p;
 	p = (struct rtp_member_list *)members;
+	if(0 == p->count)
+		return NULL;
+
+	i = p->index[rtp_member_list_slot(p, ssrc)];
+	return i >= 0 ? p->ptr[i].member : NULL;
+}
+
+static int rtp_member_list_grow(struct rtp_member_list *p)
+{
+	int i, n, bits;
+	void *ptr, *index;
 
+	n = p->capacity > 0 ? p->capacity * 2 : N_SOURCE;
+	for(bits = 1; (1 << bits) < n * 2; )
+		bits++;
+
+	index = malloc((1 << bits) * sizeof(int));
+	if(!index)
+		return ENOMEM;
+
+	ptr = realloc(p->ptr, n * sizeof(struct rtp_member_entry));
+	if(!ptr)
+	{
+		free(index);
+		return ENOMEM; // keep old ptr/index
+	}
+
+	// commit capacity after both allocations succeed
+	p->ptr = (struct rtp_member_entry *)ptr;
+	p->capacity = n;
+	if(p->index)
+		free(p->index);
+	p->index = (int *)index;
+	p->bits = bits;
+
+	// rehash
+	memset(p->index, -1, (1 << bits) * sizeof(int));
 	for(i = 0; i < p->count; i++)
+		p->index[rtp_member_list_slot(p, p->ptr[i].member->ssrc)] = i;
+	return 0;
+}
+
+static void rtp_member_list_schedule(struct rtp_member_list *p, int i, uint64_t tick)
+{
+	void* ptr;
+	struct rtp_member_wheel *w;
+	w = &p->wheel[tick % N_WHEEL];
+	if(w->count >= w->capacity)
 	{
-		s = i < N_SOURCE ? p->members[i] : p->ptr[i-N_SOURCE];
-		if(s->ssrc == ssrc)
-			return s;
+		ptr = realloc(w->ssrc, (w->capacity + 8) * 2 * sizeof(uint32_t));
+		if(!ptr)
+			return; // don't expire the member
+		w->ssrc = (uint32_t *)ptr;
+		w->capacity = (w->capacity + 8) * 2;
 	}
-	return NULL;
+
+	w->ssrc[w->count++] = p->ptr[i].member->ssrc;
+	p->ptr[i].tick = tick;
 }
 
 int rtp_member_list_add(void* members, struct rtp_member* s)
 {
+	int r;
 	struct rtp_member_list *p;
 	p = (struct rtp_member_list *)members;
 
-	if(p->count >= N_SOURCE)
+	if(p->count >= p->capacity)
 	{
-		if(p->count - N_SOURCE >= p->capacity)
-		{
-			void* ptr;
-			ptr = (struct rtp_member **)realloc(p->ptr, (p->capacity+8)*sizeof(struct rtp_member*));
-			if(!ptr)
-				return ENOMEM;
-			p->ptr = ptr;
-			p->capacity += 8;
-		}
-		p->ptr[p->count - N_SOURCE] = s;
-	}
-	else
-	{
-		p->members[p->count] = s;
+		r = rtp_member_list_grow(p);
+		if(0 != r)
+			return r;
 	}
 
+	assert(p->index[rtp_member_list_slot(p, s->ssrc)] < 0);
+	p->index[rtp_member_list_slot(p, s->ssrc)] = p->count;
+	p->ptr[p->count].member = s;
+	p->ptr[p->count].clock = 0;
+	rtp_member_list_schedule(p, p->count, p->tick + 1); // check on next tick
+
 	rtp_member_addref(s);
 	p->count++;
 	return 0;
@@ -102,42 +192,90 @@ int rtp_member_list_add(void* members, struct rtp_member* s)
 
 int rtp_member_list_delete(void* members, uint32_t ssrc)
 {
-	int i;
+	int i, j, k, h, mask;
 	struct rtp_member *s;
 	struct rtp_member_list *p;
 	p = (struct rtp_member_list *)members;
+	if(0 == p->count)
+		return -1; // NOT_FOUND
 
-	for(i = 0; i < p->count; i++)
+	i = rtp_member_list_slot(p, ssrc);
+	j = p->index[i];
+	if(j < 0)
+		return -1; // NOT_FOUND
+	s = p->ptr[j].member;
+
+	// backward shift deletion, keep probe sequence unbroken
+	mask = (1 << p->bits) - 1;
+	for(k = (i + 1) & mask; p->index[k] >= 0; k = (k + 1) & mask)
+	{
+		h = SSRC_HASH(p->ptr[p->index[k]].member->ssrc, p->bits);
+		if(((k - h) & mask) >= ((k - i) & mask))
+		{
+			p->index[i] = p->index[k];
+			i = k;
+		}
+	}
+	p->index[i] = -1;
+
+	// move the last one to the hole
+	if(j + 1 < p->count)
 	{
-		s = i < N_SOURCE ? p->members[i] : p->ptr[i-N_SOURCE];
-		if(s->ssrc != ssrc)
-			continue;
+		p->ptr[j] = p->ptr[p->count - 1];
+		p->index[rtp_member_list_slot(p, p->ptr[j].member->ssrc)] = j;
+	}
 
-		if(i < N_SOURCE)
+	rtp_member_release(s);
+	p->count--;
+	return 0;
+}
+
+int rtp_member_list_expire(void* members, uint64_t clock, uint64_t timeout, int sender, int (*onexpire)(void* param, struct rtp_member* member), void* param)
+{
+	int i, j, n;
+	uint64_t now, tick, last;
+	struct rtp_member *s;
+	struct rtp_member_wheel *w;
+	struct rtp_member_list *p;
+	p = (struct rtp_member_list *)members;
+
+	n = 0;
+	now = clock / WHEEL_TICK;
+	if(p->tick + N_WHEEL <= now)
+		p->tick = now - N_WHEEL; // catch up, visit every slot once
+
+	while(p->tick < now)
+	{
+		tick = ++p->tick;
+		w = &p->wheel[tick % N_WHEEL];
+		for(j = 0; j < w->count; j++)
 		{
-			if(i+1 < N_SOURCE)
-			{
-				memmove(p->members + i, p->members+i+1, (N_SOURCE-i-1) * sizeof(struct rtp_member*));
-			}
+			i = p->count > 0 ? p->index[rtp_member_list_slot(p, w->ssrc[j])] : -1;
+			if(i < 0 || p->ptr[i].tick > tick)
+				continue; // deleted or rescheduled
 
-			if(p->count > N_SOURCE)
+			s = p->ptr[i].member;
+			last = sender ? s->rtp_clock : (s->rtp_clock > s->rtcp_clock ? s->rtp_clock : s->rtcp_clock);
+			if(0 == last)
 			{
-				p->members[N_SOURCE-1] = p->ptr[0];
-				memmove(p->ptr, p->ptr + 1, (p->count-N_SOURCE-1) * sizeof(struct rtp_member*));
+				if(0 == p->ptr[i].clock)
+					p->ptr[i].clock = clock;
+				last = p->ptr[i].clock;
 			}
-		}
-		else
-		{
-			if(i + 1 < p->count)
+
+			if(last + timeout <= clock && (!onexpire || 0 == onexpire(param, s)))
 			{
-				memmove(p->ptr + i - N_SOURCE, p->ptr + i + 1 - N_SOURCE, (p->count-i-1) * sizeof(struct rtp_member*));
+				rtp_member_list_delete(p, s->ssrc);
+				n++;
+				continue;
 			}
-		}
 
-		rtp_member_release(s);
-		p->count--;
-		return 0;
+			// reschedule, far deadline check again in next round
+			last = last + timeout > clock ? (last + timeout) / WHEEL_TICK + 1 : tick + 1;
+			rtp_member_list_schedule(p, i, last < tick + 1 ? tick + 1 : (last > tick + N_WHEEL - 1 ? tick + N_WHEEL - 1 : last));
+		}
+		w->count = 0;
 	}
 
-	return -1; // NOT_FOUND
+	return n;
 }
@@ -6,7 +6,8 @@
 #include <assert.h>
 #include <errno.h>
 
-#define MAX_PACKET 3000
+#define MIN_PACKET 256
+#define MAX_PACKET 4096 // power of 2, max sequence window
 
 #define RTP_MISORDER 300
 #define RTP_DROPOUT  1000
@@ -21,15 +22,15 @@ struct rtp_item_t
 
 struct rtp_queue_t
 {
-	struct rtp_item_t* items;
-	int capacity;
+	struct rtp_item_t* items; // items[seq & (capacity - 1)], NULL-lost packet
+	int capacity; // power of 2
 	int size;
-	int pos; // ring buffer read position
 
 	int probation;
 	int cycles;
-	uint16_t last_seq;
-	uint16_t first_seq;
+	uint16_t last_seq; // max received sequence, the tail item
+	uint16_t first_seq; // next read sequence
+	uint16_t head_seq; // min queued sequence, valid if size > 0
 
 	int bad_count;
 	uint16_t bad_seq;
@@ -42,8 +43,7 @@ struct rtp_queue_t
 };
 
 static void rtp_queue_reset(struct rtp_queue_t* q);
-static int rtp_queue_find(struct rtp_queue_t* q, uint16_t seq);
-static int rtp_queue_insert(struct rtp_queue_t* q, int position, struct rtp_packet_t* pkt);
+static int rtp_queue_insert(struct rtp_queue_t* q, struct rtp_packet_t* pkt);
 
 struct rtp_queue_t* rtp_queue_create(int threshold, int frequency, void(*freepkt)(void*, struct rtp_packet_t*), void* param)
 {
@@ -74,6 +74,11 @@ int rtp_queue_destroy(struct rtp_queue_t* q)
 	return 0;
 }
 
+static inline struct rtp_item_t* rtp_queue_item(struct rtp_queue_t* q, uint16_t seq)
+{
+	return &q->items[seq & (q->capacity - 1)];
+}
+
 static inline void rtp_queue_reset_bad_items(struct rtp_queue_t* q)
 {
 	int i;
@@ -89,91 +94,96 @@ static inline void rtp_queue_reset_bad_items(struct rtp_queue_t* q)
 	q->bad_count = 0;
 }
 
-static void rtp_queue_reset(struct rtp_queue_t* q)
+static void rtp_queue_reset_items(struct rtp_queue_t* q)
 {
-	int i;
-	struct rtp_packet_t* pkt;
-
-	rtp_queue_reset_bad_items(q);
+	uint16_t seq;
+	struct rtp_item_t* item;
 
-	for (i = 0; i < q->size; i++)
+	for (seq = q->head_seq; q->size > 0; seq++)
 	{
-		pkt = q->items[(q->pos + i) % q->capacity].pkt;
-		q->free(q->param, pkt);
-	}
-
-	q->pos = 0;
-	q->size = 0;
-	q->probation = RTP_SEQUENTIAL;
-}
-
-static int rtp_queue_find(struct rtp_queue_t* q, uint16_t seq)
-{
-	uint16_t v;
-	uint16_t vi;
-	int l, r, i;
-
-	l = q->pos;
-	r = q->pos + q->size;
-	v = q->last_seq - seq;
-	while (l < r)
-	{
-		i = (l + r) / 2;
-		vi = (uint16_t)q->last_seq - (uint16_t)q->items[i % q->capacity].pkt->rtp.seq;
-		if (vi == v)
-		{
-			return -1; // duplicate
-		}
-		else if (vi < v)
-		{
-			r = i;
-		}
-		else
+		item = rtp_queue_item(q, seq);
+		if (item->pkt)
 		{
-			assert(vi > v);
-			l = i + 1;
+			q->free(q->param, item->pkt);
+			item->pkt = NULL;
+			q->size--;
 		}
 	}
+}
 
-	return l; // insert position
+static void rtp_queue_reset(struct rtp_queue_t* q)
+{
+	rtp_queue_reset_bad_items(q);
+	rtp_queue_reset_items(q);
+	q->probation = RTP_SEQUENTIAL;
 }
 
-static int rtp_queue_insert(struct rtp_queue_t* q, int position, struct rtp_packet_t* pkt)
+/// @param[in] window sequence count from head to tail(include both)
+static int rtp_queue_reserve(struct rtp_queue_t* q, int window)
 {
 	void* p;
 	int i, capacity;
+	uint16_t seq;
 
-	assert(position >= q->pos && position <= q->pos + q->size);
+	if (window <= q->capacity)
+		return 0;
+	if (window > MAX_PACKET)
+		return -E2BIG;
 
-	if (q->size >= q->capacity)
-	{
-		if (q->size + 1 > MAX_PACKET)
-			return -E2BIG;
+	capacity = q->capacity > 0 ? q->capacity : MIN_PACKET;
+	while (capacity < window)
+		capacity *= 2;
 
-		capacity = q->capacity + 250;
-		p = realloc(q->items, capacity * sizeof(struct rtp_item_t));
-		if (NULL == p)
-			return -ENOMEM;
+	p = calloc(capacity, sizeof(struct rtp_item_t));
+	if (NULL == p)
+		return -ENOMEM;
 
-		q->items = (struct rtp_item_t*)p;
-		if (q->pos + q->size > q->capacity)
+	// re-index queued items
+	for (i = 0, seq = q->head_seq; i < q->size; seq++)
+	{
+		if (rtp_queue_item(q, seq)->pkt)
 		{
-			// move to tail
-			assert(q->pos < q->capacity);
-			memmove(&q->items[q->pos + capacity - q->capacity], &q->items[q->pos], (q->capacity - q->pos) * sizeof(struct rtp_item_t));
-			q->pos += capacity - q->capacity;
-            position += capacity - q->capacity;
+			((struct rtp_item_t*)p)[seq & (capacity - 1)] = *rtp_queue_item(q, seq);
+			i++;
 		}
+	}
 
-		q->capacity = capacity;
+	free(q->items);
+	q->items = (struct rtp_item_t*)p;
+	q->capacity = capacity;
+	return 0;
+}
+
+/// @return 1-ok, 0-duplicate, <0-error
+static int rtp_queue_insert(struct rtp_queue_t* q, struct rtp_packet_t* pkt)
+{
+	int r;
+	uint16_t seq, head, tail;
+	struct rtp_item_t* item;
+
+	seq = (uint16_t)pkt->rtp.seq;
+	head = seq;
+	tail = seq;
+	if (q->size > 0)
+	{
+		head = (int16_t)(seq - q->head_seq) < 0 ? seq : q->head_seq;
+		tail = (int16_t)(seq - q->last_seq) > 0 ? seq : q->last_seq;
 	}
 
-	// move items
-	for (i = q->pos + q->size; i > position; i--)
-		memcpy(&q->items[i % q->capacity], &q->items[(i - 1) % q->capacity], sizeof(struct rtp_item_t));
+	r = rtp_queue_reserve(q, (uint16_t)(tail - head) + 1);
+	if (0 != r)
+		return r;
 
-	q->items[position % q->capacity].pkt = pkt;
-//	q->items[position % q->capacity].clock = 0;
+	item = rtp_queue_item(q, seq);
+	if (item->pkt)
+	{
+		assert(item->pkt->rtp.seq == seq);
+		return 0; // duplicate
+	}
+
+	item->pkt = pkt;
+//	item->clock = 0;
+	q->head_seq = head;
 	q->size++;
 	return 1;
 }
@@ -186,24 +196,27 @@ static int rtp_queue_insert(struct rtp_queue_t* q, int position, struct rtp_pack
 */
 int rtp_queue_write(struct rtp_queue_t* q, struct rtp_packet_t* pkt)
 {
-	int i, idx;
+	int i, r;
 	uint16_t delta;
 
 	if (q->probation)
 	{
-		if (q->size > 0 && (uint16_t)pkt->rtp.seq == q->last_seq + 1)
+		if (q->size > 0 && (uint16_t)pkt->rtp.seq == (uint16_t)(q->last_seq + 1))
 		{
 			q->probation--;
-			if (0 == q->probation)
-				q->first_seq = (uint16_t)q->items[q->pos].pkt->rtp.seq;
 		}
 		else
 		{
 			rtp_queue_reset(q);
 		}
 
+		r = rtp_queue_insert(q, pkt);
+		if (r < 1)
+			return r;
+
 		q->last_seq = (uint16_t)pkt->rtp.seq;
-		rtp_queue_insert(q, q->pos + q->size, pkt);
+		if (0 == q->probation)
+			q->first_seq = q->head_seq;
 		return 1;
 	}
 	else
@@ -211,24 +224,28 @@ int rtp_queue_write(struct rtp_queue_t* q, struct rtp_packet_t* pkt)
 		delta = (uint16_t)(pkt->rtp.seq - q->last_seq);
 		if (delta > 0 && delta < RTP_DROPOUT)
 		{
+			r = rtp_queue_insert(q, pkt);
+			if (r < 1)
+				return r;
+
 			if (pkt->rtp.seq < q->last_seq)
 				q->cycles += RTP_SEQMOD;
 
 			rtp_queue_reset_bad_items(q);
 			q->last_seq = (uint16_t)pkt->rtp.seq;
-			return rtp_queue_insert(q, q->pos + q->size, pkt);
+			return 1;
 		}
 		else if ( (int16_t)delta <= 0 && (int16_t)delta >= (int16_t)(q->first_seq - q->last_seq) )
 		{
 			// pkt->rtp.seq - q->first_seq < q->last_seq - q->first_seq
 
 			// duplicate or reordered packet
-			idx = rtp_queue_find(q, (uint16_t)pkt->rtp.seq);
-			if (-1 == idx)
-				return 0;
-			
+			r = rtp_queue_insert(q, pkt);
+			if (r < 1)
+				return r;
+
 			rtp_queue_reset_bad_items(q);
-			return rtp_queue_insert(q, idx, pkt);
+			return 1;
 		}
 		else if ((uint16_t)(q->first_seq - pkt->rtp.seq) < RTP_MISORDER)
 		{
@@ -244,16 +261,18 @@ int rtp_queue_write(struct rtp_queue_t* q, struct rtp_packet_t* pkt)
 					// Two sequential packets -- assume that the other side
 					// restarted without telling us so just re-sync
 					// (i.e., pretend this was the first packet).
-					
-					//rtp_queue_reset(q);
+					// The queued packets belong to the old sequence space
+					// and can't share the slots with the new one.
+					rtp_queue_reset_items(q);
 
 					// copy saved items
 					for (i = 0; i < q->bad_count; i++)
-						rtp_queue_insert(q, q->pos + q->size, q->bad_items[i].pkt);
+						rtp_queue_insert(q, q->bad_items[i].pkt);
 
 					q->bad_count = 0;
+					q->first_seq = q->head_seq;
 					q->last_seq = (uint16_t)pkt->rtp.seq;
-					return rtp_queue_insert(q, q->pos + q->size, pkt);
+					return rtp_queue_insert(q, pkt);
 				}
 			}
 			else
@@ -261,7 +280,7 @@ int rtp_queue_write(struct rtp_queue_t* q, struct rtp_packet_t* pkt)
 				rtp_queue_reset_bad_items(q);
 			}
 
-			q->bad_seq = (pkt->rtp.seq + 1) % (RTP_SEQMOD-1);
+			q->bad_seq = (uint16_t)(pkt->rtp.seq + 1);
 			q->bad_items[q->bad_count++].pkt = pkt;
 			return 1;
 		}
@@ -271,30 +290,50 @@ int rtp_queue_write(struct rtp_queue_t* q, struct rtp_packet_t* pkt)
 struct rtp_packet_t* rtp_queue_read(struct rtp_queue_t* q)
 {
 	uint32_t threshold;
+	struct rtp_item_t* item;
 	struct rtp_packet_t* pkt;
 	if (q->size < 1 || q->probation)
 		return NULL;
 
-	assert(q->pos < q->capacity);
-	pkt = q->items[q->pos].pkt;
-	if (q->first_seq == pkt->rtp.seq)
-	{
-		q->first_seq++;
-		q->size--;
-		q->pos = (q->pos + 1) % q->capacity;
-		return pkt;
-	}
-	else
+	item = rtp_queue_item(q, q->head_seq);
+	pkt = item->pkt;
+	assert(pkt && pkt->rtp.seq == q->head_seq);
+	if (q->first_seq != q->head_seq)
 	{
-		threshold = (q->items[(q->pos + q->size - 1) % q->capacity].pkt->rtp.timestamp - pkt->rtp.timestamp) / ((uint32_t)q->frequency / 1000);
+		// lost packet(s), wait for jitter buffer threshold
+		threshold = (rtp_queue_item(q, q->last_seq)->pkt->rtp.timestamp - pkt->rtp.timestamp) / ((uint32_t)q->frequency / 1000);
 		if (threshold < (uint32_t)q->threshold)
 			return NULL;
+	}
+
+	item->pkt = NULL;
+	q->first_seq = (uint16_t)(q->head_seq + 1);
+	q->size--;
 
-		q->first_seq = (uint16_t)(pkt->rtp.seq + 1);
-		q->size--;
-		q->pos = (q->pos + 1) % q->capacity;
-		return pkt;
+	// skip lost packets, each slot is visited once
+	q->head_seq = q->first_seq;
+	while (q->size > 0 && NULL == rtp_queue_item(q, q->head_seq)->pkt)
+		q->head_seq++;
+	return pkt;
+}
+
+int rtp_queue_lost(struct rtp_queue_t* q, uint16_t* lost, int num)
+{
+	int n;
+	uint16_t seq;
+	struct rtp_item_t* item;
+
+	if (q->size < 1 || q->probation)
+		return 0;
+
+	// holes between the next read sequence and the tail item
+	for (n = 0, seq = q->first_seq; seq != q->last_seq && n < num; seq++)
+	{
+		item = rtp_queue_item(q, seq);
+		if (NULL == item->pkt || (uint16_t)item->pkt->rtp.seq != seq)
+			lost[n++] = seq;
 	}
+	return n;
 }
 
 #if defined(_DEBUG) || defined(DEBUG)
@@ -302,10 +341,14 @@ struct rtp_packet_t* rtp_queue_read(struct rtp_queue_t* q)
 static void rtp_queue_dump(struct rtp_queue_t* q)
 {
 	int i;
-	printf("[%02d/%02d]: ", q->pos, q->size);
-	for (i = 0; i < q->size; i++)
+	uint16_t seq;
+	printf("[%05u/%02d]: ", (unsigned int)q->first_seq, q->size);
+	for (i = 0, seq = q->head_seq; i < q->size; seq++)
 	{
-		printf("%u\t", (unsigned int)q->items[(i + q->pos) % q->capacity].pkt->rtp.seq);
+		if (NULL == rtp_queue_item(q, seq)->pkt)
+			continue;
+		printf("%u\t", (unsigned int)seq);
+		i++;
 	}
 	printf("\n");
 }
@@ -122,17 +122,63 @@ int rtp_rtcp_bye(void* rtp, void* data, int bytes)
 	return rtcp_bye_pack(ctx, (uint8_t*)data, bytes);
 }
 
+int rtp_rtcp_nack(void* rtp, uint32_t ssrc, const uint16_t* lost, int num, void* data, int bytes)
+{
+	int n;
+	struct rtp_context *ctx = (struct rtp_context *)rtp;
+	n = rtcp_nack_pack(ctx, (uint8_t*)data, bytes, ssrc, lost, num);
+	return num > 0 && n <= bytes ? n : 0;
+}
+
+int rtp_rtcp_pli(void* rtp, uint32_t ssrc, void* data, int bytes)
+{
+	int n;
+	struct rtp_context *ctx = (struct rtp_context *)rtp;
+	n = rtcp_pli_pack(ctx, (uint8_t*)data, bytes, ssrc);
+	return n <= bytes ? n : 0;
+}
+
+int rtp_rtcp_fir(void* rtp, uint32_t ssrc, uint8_t seq, void* data, int bytes)
+{
+	int n;
+	struct rtp_context *ctx = (struct rtp_context *)rtp;
+	n = rtcp_fir_pack(ctx, (uint8_t*)data, bytes, ssrc, seq);
+	return n <= bytes ? n : 0;
+}
+
+static int rtp_member_onexpire(void* param, struct rtp_member* member)
+{
+	struct rtcp_msg_t msg;
+	struct rtp_context *ctx = (struct rtp_context *)param;
+	if(member == ctx->self)
+		return 1; // keep
+
+	rtp_member_list_delete(ctx->senders, member->ssrc);
+
+	msg.type = RTCP_MSG_EXPIRED;
+	msg.u.expired.ssrc = member->ssrc;
+	ctx->handler.on_rtcp(ctx->cbparam, &msg);
+	return 0;
+}
+
 int rtp_rtcp_interval(void* rtp)
 {
 	double interval;
+	uint64_t clock, td;
 	struct rtp_context *ctx = (struct rtp_context *)rtp;
+	clock = rtpclock();
 	interval = rtcp_interval(rtp_member_list_count(ctx->members),
 		rtp_member_list_count(ctx->senders) + ((RTP_SENDER==ctx->role) ? 1 : 0),
 		ctx->rtcp_bw, 
-		(ctx->self->rtp_clock + 2*RTCP_REPORT_INTERVAL*1000 > rtpclock()) ? 1 : 0,
+		(ctx->self->rtp_clock + 2*RTCP_REPORT_INTERVAL*1000 > clock) ? 1 : 0,
 		ctx->avg_rtcp_size,
 		ctx->init);
 
+	// RFC3550 6.3.5 Timing Out an SSRC, timer wheel check due members only
+	td = (uint64_t)(MAX(interval * 1000, RTCP_REPORT_INTERVAL) * 1000);
+	rtp_member_list_expire(ctx->senders, clock, 2 * td, 1, NULL, NULL);
+	rtp_member_list_expire(ctx->members, clock, RTCP_MEMBER_TIMEOUT * td, 0, rtp_member_onexpire, ctx);
+
 	return (int)(interval * 1000);
 }
 
@@ -0,0 +1,136 @@
+#include "rtp-demuxer.h"
+#include "rtp-payload.h"
+#include "rtp-profile.h"
+#include "../../librtsp/source/utils/rtp-sender.h"
+#include "sys/system.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#define N 2000 // frame count
+#define RTP_LOST 10 // drop every 10th packet
+#define JITTER 200 // ms, demuxer NACK retry every JITTER/2
+
+struct rtp_feedback_test_t
+{
+	struct rtp_demuxer_t* demuxer;
+	int forever; // 1-dropped packet is never retransmitted
+
+	uint8_t dropped[65536]; // times sent by seq
+	int sent;
+	int drops;
+	int resent;
+	int maxresent; // max retransmission of one seq
+
+	int frames;
+	int lost; // frames with lost flag
+	int keyframes; // PLI/FIR
+	uint64_t duration; // ms
+};
+
+static inline uint16_t rtp_feedback_seq(const void* packet)
+{
+	return (uint16_t)((((const uint8_t*)packet)[2] << 8) | ((const uint8_t*)packet)[3]);
+}
+
+static int rtp_feedback_onpacket(void* param, const void* packet, int bytes, uint32_t /*timestamp*/, int /*flags*/)
+{
+	uint16_t seq;
+	struct rtp_feedback_test_t* ctx = (struct rtp_feedback_test_t*)param;
+
+	seq = rtp_feedback_seq(packet);
+	if (0 == ctx->dropped[seq] && 0 == ++ctx->sent % RTP_LOST)
+	{
+		ctx->dropped[seq] = 1;
+		ctx->drops++;
+		return bytes; // lost
+	}
+
+	if (ctx->dropped[seq])
+	{
+		ctx->resent++;
+		ctx->dropped[seq]++;
+		ctx->maxresent = ctx->maxresent > ctx->dropped[seq] - 1 ? ctx->maxresent : ctx->dropped[seq] - 1;
+		if (ctx->forever)
+			return bytes; // lost again
+	}
+
+	rtp_demuxer_input(ctx->demuxer, packet, bytes);
+	return bytes;
+}
+
+static int rtp_feedback_ondemux(void* param, const void* /*packet*/, int /*bytes*/, uint32_t /*timestamp*/, int flags)
+{
+	struct rtp_feedback_test_t* ctx = (struct rtp_feedback_test_t*)param;
+	ctx->frames++;
+	if (flags & (RTP_PAYLOAD_FLAG_PACKET_LOST | RTP_PAYLOAD_FLAG_PACKET_CORRUPT))
+		ctx->lost++;
+	return 0;
+}
+
+static void rtp_feedback_onkeyframe(void* param)
+{
+	struct rtp_feedback_test_t* ctx = (struct rtp_feedback_test_t*)param;
+	ctx->keyframes++;
+}
+
+// sender -> demuxer loopback, demuxer RTCP(NACK/PLI) -> sender
+static void rtp_feedback_test2(struct rtp_feedback_test_t* ctx)
+{
+	int i, r;
+	uint64_t clock;
+	uint8_t nalu[4000];
+	uint8_t rtcp[1500];
+	struct rtp_sender_t s;
+
+	memset(&s, 0, sizeof(s));
+	s.onpacket = rtp_feedback_onpacket;
+	s.param = ctx;
+	r = rtp_sender_init_video(&s, 0, RTP_PAYLOAD_H264, "H264", 90000, NULL, 0);
+	assert(r >= 0);
+	s.onkeyframe = rtp_feedback_onkeyframe;
+	ctx->demuxer = rtp_demuxer_create(JITTER, 90000, RTP_PAYLOAD_H264, "H264", rtp_feedback_ondemux, ctx);
+	assert(ctx->demuxer);
+
+	// non-IDR slice, 3 FU-A packets
+	memset(nalu, 0x55, sizeof(nalu));
+	nalu[0] = 0x00; nalu[1] = 0x00; nalu[2] = 0x00; nalu[3] = 0x01; nalu[4] = 0x41;
+	clock = system_clock();
+	for (i = 0; i < N; i++)
+	{
+		r = rtp_sender_input(&s, nalu, sizeof(nalu), i * 3600);
+		assert(0 == r);
+
+		r = rtp_demuxer_rtcp(ctx->demuxer, rtcp, sizeof(rtcp));
+		if (r > 0)
+			rtp_sender_input_rtcp(&s, rtcp, r);
+	}
+
+	ctx->duration = system_clock() - clock;
+	rtp_demuxer_destroy(&ctx->demuxer);
+
+	// init again: free previous encoder/rtp/history
+	r = rtp_sender_init_video(&s, 0, RTP_PAYLOAD_H264, "H264", 90000, NULL, 0);
+	assert(r >= 0);
+	rtp_sender_destroy(&s);
+}
+
+void rtp_feedback_test(void)
+{
+	static struct rtp_feedback_test_t ctx;
+
+	// all lost packets are retransmitted once, no lost frame
+	memset(&ctx, 0, sizeof(ctx));
+	rtp_feedback_test2(&ctx);
+	assert(ctx.drops > 0 && ctx.drops <= ctx.resent + 1 /*last packet*/ && 1 == ctx.maxresent);
+	assert(N - 1 <= ctx.frames && 0 == ctx.lost && 0 == ctx.keyframes);
+
+	// lost forever: NACK retry is throttled per seq, lost frame request key frame
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.forever = 1;
+	rtp_feedback_test2(&ctx);
+	assert(ctx.drops > 0 && ctx.drops <= ctx.resent + 1 && ctx.maxresent <= 1 + (int)(ctx.duration / (JITTER / 2)));
+	assert(ctx.lost > 0 && ctx.keyframes > 0);
+	printf("rtp_feedback_test drops: %d, resent: %d, frames: %d, lost: %d, keyframe: %d\n", ctx.drops, ctx.resent, ctx.frames, ctx.lost, ctx.keyframes);
+}
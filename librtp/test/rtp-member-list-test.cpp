@@ -0,0 +1,303 @@
+#include "sys/system.h"
+extern "C" {
+#include "rtp-internal.h"
+#include "rtp-member-list.h"
+}
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <map>
+#include <vector>
+
+#define N 600 // colliding members
+#define TICK 500000 // rtp-member-list.c WHEEL_TICK, 500ms
+#define TIMEOUT 10000000 // 10s
+
+// SSRC_HASH(ssrc, bits) == 0 for all bits <= 12, same probe chain
+static uint32_t rtp_member_list_collide(uint32_t ssrc)
+{
+	while ((uint32_t)(++ssrc * 2654435761u) >> 20)
+		;
+	return ssrc;
+}
+
+static void rtp_member_list_check(void* members, std::map<uint32_t, int>& ref)
+{
+	int i, n;
+	struct rtp_member* m;
+	std::map<uint32_t, int>::iterator it;
+
+	for (n = 0, it = ref.begin(); it != ref.end(); ++it)
+	{
+		m = rtp_member_list_find(members, it->first);
+		assert(it->second ? m && m->ssrc == it->first : NULL == m);
+		n += it->second;
+	}
+	assert(n == rtp_member_list_count(members));
+
+	for (i = 0; i < rtp_member_list_count(members); i++)
+	{
+		m = rtp_member_list_get(members, i);
+		assert(m && ref.end() != ref.find(m->ssrc) && 1 == ref[m->ssrc]);
+	}
+}
+
+// all members in one probe chain, delete from the middle of the chain
+static void rtp_member_list_collision_test(void)
+{
+	int i;
+	uint32_t ssrc;
+	void* members;
+	struct rtp_member* m;
+	std::vector<uint32_t> ssrcs;
+	std::map<uint32_t, int> ref; // 1-member, 0-deleted
+
+	members = rtp_member_list_create();
+	for (ssrc = 0, i = 0; i < N; i++)
+	{
+		ssrc = rtp_member_list_collide(ssrc);
+		ssrcs.push_back(ssrc);
+		m = rtp_member_create(ssrc);
+		assert(0 == rtp_member_list_add(members, m));
+		rtp_member_release(m);
+		ref[ssrc] = 1;
+	}
+	rtp_member_list_check(members, ref);
+
+	for (i = 0; i < N; i += 3)
+	{
+		assert(0 == rtp_member_list_delete(members, ssrcs[i]));
+		assert(-1 == rtp_member_list_delete(members, ssrcs[i]));
+		ref[ssrcs[i]] = 0;
+	}
+	rtp_member_list_check(members, ref);
+
+	// add back, reuse deleted slots
+	for (i = 0; i < N; i += 3)
+	{
+		m = rtp_member_create(ssrcs[i]);
+		assert(0 == rtp_member_list_add(members, m));
+		rtp_member_release(m);
+		ref[ssrcs[i]] = 1;
+	}
+	rtp_member_list_check(members, ref);
+
+	// delete all
+	for (i = N - 1; i >= 0; i--)
+	{
+		assert(0 == rtp_member_list_delete(members, ssrcs[i]));
+		ref[ssrcs[i]] = 0;
+	}
+	assert(0 == rtp_member_list_count(members) && NULL == rtp_member_list_find(members, ssrcs[0]));
+	rtp_member_list_destroy(members);
+}
+
+struct rtp_member_list_expire_test_t
+{
+	uint64_t clock;
+	std::map<uint32_t, uint64_t> expired; // ssrc -> clock
+};
+
+static int rtp_member_list_onexpire(void* param, struct rtp_member* member)
+{
+	struct rtp_member_list_expire_test_t* ctx = (struct rtp_member_list_expire_test_t*)param;
+	if (0 == member->ssrc)
+		return 1; // keep
+	assert(ctx->expired.end() == ctx->expired.find(member->ssrc));
+	ctx->expired[member->ssrc] = ctx->clock;
+	return 0;
+}
+
+// member i: last active at i * 100ms, expire on [deadline, deadline + 2 ticks)
+static void rtp_member_list_expire_test(int sender)
+{
+	int i;
+	uint64_t start, deadline;
+	void* members;
+	struct rtp_member* m;
+	struct rtp_member* active;
+	struct rtp_member_list_expire_test_t ctx;
+
+	start = 1000 * 1000000ull; // 1000s
+	members = rtp_member_list_create();
+	for (i = 0; i < 100; i++)
+	{
+		m = rtp_member_create((uint32_t)i);
+		m->rtp_clock = i < 80 ? start + i * 100000 : 0; // 0-no RTP packet
+		m->rtcp_clock = sender || i >= 80 ? 0 : start + 60 * 1000000ull; // RTCP only keep member, not sender
+		assert(0 == rtp_member_list_add(members, m));
+		rtp_member_release(m);
+	}
+	active = rtp_member_list_find(members, 1);
+
+	for (ctx.clock = start; ctx.clock < start + 120 * 1000000ull; ctx.clock += 100000)
+	{
+		active->rtp_clock = ctx.clock;
+		rtp_member_list_expire(members, ctx.clock, TIMEOUT, sender, rtp_member_list_onexpire, &ctx);
+	}
+
+	assert(NULL != rtp_member_list_find(members, 0)); // onexpire keep
+	assert(NULL != rtp_member_list_find(members, 1)); // active
+	for (i = 2; i < 100; i++)
+	{
+		assert(ctx.expired.end() != ctx.expired.find((uint32_t)i));
+		if (i < 80)
+			deadline = (sender ? start + i * 100000 : start + 60 * 1000000ull) + TIMEOUT;
+		else
+			deadline = start + TIMEOUT; // first check clock
+		assert(ctx.expired[i] >= deadline && ctx.expired[i] < deadline + 2 * TICK);
+		assert(NULL == rtp_member_list_find(members, (uint32_t)i));
+	}
+	assert(2 == rtp_member_list_count(members));
+	rtp_member_list_destroy(members);
+}
+
+struct rtp_member_list_rtcp_test_t
+{
+	int expired;
+	int bye;
+};
+
+static void rtp_member_list_onrtcp(void* param, const struct rtcp_msg_t* msg)
+{
+	struct rtp_member_list_rtcp_test_t* ctx = (struct rtp_member_list_rtcp_test_t*)param;
+	if (RTCP_MSG_EXPIRED == msg->type)
+		ctx->expired++;
+	else if (RTCP_MSG_BYE == msg->type)
+		ctx->bye++;
+}
+
+static void rtp_member_list_rtp(struct rtp_context* ctx, uint32_t ssrc, uint16_t seq)
+{
+	uint8_t rtp[12 + 4];
+	memset(rtp, 0, sizeof(rtp));
+	rtp[0] = 0x80;
+	rtp[1] = 96;
+	rtp[2] = (uint8_t)(seq >> 8);
+	rtp[3] = (uint8_t)seq;
+	rtp[8] = (uint8_t)(ssrc >> 24);
+	rtp[9] = (uint8_t)(ssrc >> 16);
+	rtp[10] = (uint8_t)(ssrc >> 8);
+	rtp[11] = (uint8_t)ssrc;
+	rtp_onreceived(ctx, rtp, sizeof(rtp));
+}
+
+// rtp_rtcp_interval: sender timeout 2*Td, member timeout 5*Td, BYE
+static void rtp_member_list_rtcp_test(void)
+{
+	int i, n;
+	uint64_t clock;
+	uint8_t rtcp[64];
+	void* peer;
+	struct rtp_context* ctx;
+	struct rtp_event_t handler;
+	struct rtp_member_list_rtcp_test_t test;
+
+	memset(&test, 0, sizeof(test));
+	handler.on_rtcp = rtp_member_list_onrtcp;
+	ctx = (struct rtp_context*)rtp_create(&handler, &test, 1, 0, 90000, 2 * 1024 * 1024, 0);
+	peer = rtp_create(&handler, &test, 4, 0, 90000, 2 * 1024 * 1024, 1);
+	for (i = 0; i < 4; i++)
+	{
+		rtp_member_list_rtp(ctx, 2, (uint16_t)i);
+		rtp_member_list_rtp(ctx, 3, (uint16_t)i);
+		rtp_member_list_rtp(ctx, 4, (uint16_t)i);
+	}
+	assert(4 == rtp_member_list_count(ctx->members) && 3 == rtp_member_list_count(ctx->senders));
+
+	// 2: RTP timeout, RTCP active, 3: RTP/RTCP timeout
+	clock = rtpclock();
+	rtp_member_list_find(ctx->members, 2)->rtp_clock = clock - 60 * 1000000ull;
+	rtp_member_list_find(ctx->members, 2)->rtcp_clock = clock;
+	rtp_member_list_find(ctx->members, 3)->rtp_clock = clock - 60 * 1000000ull;
+	rtp_member_list_find(ctx->members, 3)->rtcp_clock = clock - 60 * 1000000ull;
+	rtp_rtcp_interval(ctx);
+	assert(NULL == rtp_member_list_find(ctx->senders, 2) && NULL != rtp_member_list_find(ctx->members, 2));
+	assert(NULL == rtp_member_list_find(ctx->senders, 3) && NULL == rtp_member_list_find(ctx->members, 3));
+	assert(NULL != rtp_member_list_find(ctx->senders, 4) && NULL != rtp_member_list_find(ctx->members, 1));
+	assert(1 == test.expired);
+
+	// 4: BYE
+	n = rtp_rtcp_bye(peer, rtcp, sizeof(rtcp));
+	assert(n > 0 && n <= (int)sizeof(rtcp));
+	rtp_onreceived_rtcp(ctx, rtcp, n);
+	assert(NULL == rtp_member_list_find(ctx->senders, 4) && NULL == rtp_member_list_find(ctx->members, 4));
+	assert(1 == test.bye && 2 == rtp_member_list_count(ctx->members) && 0 == rtp_member_list_count(ctx->senders));
+
+	rtp_destroy(peer);
+	rtp_destroy(ctx);
+}
+
+void rtp_member_list_test(void)
+{
+	rtp_member_list_collision_test();
+	rtp_member_list_expire_test(1);
+	rtp_member_list_expire_test(0);
+	rtp_member_list_rtcp_test();
+}
+
+void rtp_member_list_benchmark_test(void)
+{
+	int i, j, n;
+	uint32_t ssrc;
+	uint64_t clock, t;
+	void* members;
+	struct rtp_member* m;
+	std::vector<uint32_t> ssrcs;
+	static const int s_counts[] = { 4, 64, 512, 4096 };
+
+	for (i = 0; i < (int)(sizeof(s_counts) / sizeof(s_counts[0])); i++)
+	{
+		// random ssrc
+		ssrcs.clear();
+		members = rtp_member_list_create();
+		for (j = 0; j < s_counts[i]; j++)
+		{
+			m = rtp_member_create((uint32_t)rand() * 65536u + (uint32_t)rand());
+			if (rtp_member_list_find(members, m->ssrc) || 0 != rtp_member_list_add(members, m))
+			{
+				rtp_member_release(m);
+				continue;
+			}
+			ssrcs.push_back(m->ssrc);
+			m->rtp_clock = 1;
+			rtp_member_release(m);
+		}
+
+		n = 10000000;
+		clock = system_clock();
+		for (j = 0; j < n; j++)
+		{
+			if (!rtp_member_list_find(members, ssrcs[j % ssrcs.size()]))
+				assert(0);
+		}
+		clock = system_clock() - clock;
+
+		// idle session, member checked on its deadline tick only
+		t = system_clock();
+		for (j = 0; j < 100000; j++)
+			rtp_member_list_expire(members, 2 * TICK * (uint64_t)j, (uint64_t)1 << 62, 1, NULL, NULL);
+		t = system_clock() - t;
+
+		printf("rtp member list %4d members, find: %.1f ns, expire: %.1f ns/call\n", s_counts[i], (double)clock * 1000000 / n, (double)t * 1000000 / 100000);
+		rtp_member_list_destroy(members);
+	}
+
+	// worst case: all members in one probe chain
+	members = rtp_member_list_create();
+	clock = system_clock();
+	for (ssrc = 0, j = 0; j < N; j++)
+	{
+		ssrc = rtp_member_list_collide(ssrc);
+		m = rtp_member_create(ssrc);
+		rtp_member_list_add(members, m);
+		rtp_member_release(m);
+	}
+	for (j = 0; j < 100000; j++)
+		rtp_member_list_find(members, ssrc);
+	clock = system_clock() - clock;
+	printf("rtp member list %4d colliding members, add + 100000 find: %u ms\n", N, (unsigned int)clock);
+	rtp_member_list_destroy(members);
+}
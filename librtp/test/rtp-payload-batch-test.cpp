@@ -0,0 +1,164 @@
+#include "rtp-payload.h"
+#include "rtp-profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <vector>
+
+#define N 100 // frame count
+#define RTP_SSRC 0x12345678
+
+struct rtp_payload_batch_test_t
+{
+	uint8_t buffer[2 * 1024];
+	std::vector<std::vector<uint8_t> > packets;
+	std::vector<uint32_t> timestamps;
+	std::vector<int> flags;
+};
+
+static void* rtp_alloc(void* param, int bytes)
+{
+	struct rtp_payload_batch_test_t* ctx = (struct rtp_payload_batch_test_t*)param;
+	assert(bytes <= (int)sizeof(ctx->buffer));
+	return ctx->buffer;
+}
+
+static void rtp_free(void* /*param*/, void* /*packet*/)
+{
+}
+
+static int rtp_encode_packet(void* param, const void* packet, int bytes, uint32_t timestamp, int flags)
+{
+	struct rtp_payload_batch_test_t* ctx = (struct rtp_payload_batch_test_t*)param;
+	ctx->packets.push_back(std::vector<uint8_t>((const uint8_t*)packet, (const uint8_t*)packet + bytes));
+	ctx->timestamps.push_back(timestamp);
+	ctx->flags.push_back(flags);
+	return 0;
+}
+
+/// H.264/H.265: NALUs with start code, small NALUs(single packet) and large NALUs(FU), other: random payload
+static void rtp_payload_batch_frame(std::vector<uint8_t>& frame, const char* encoding, int key)
+{
+	int i, j, n, bytes;
+
+	frame.clear();
+	if (0 == strcmp("H264", encoding) || 0 == strcmp("H265", encoding))
+	{
+		n = 1 + rand() % 8;
+		for (i = 0; i < n; i++)
+		{
+			frame.push_back(0x00);
+			frame.push_back(0x00);
+			frame.push_back(0x00);
+			frame.push_back(0x01);
+			if (0 == strcmp("H264", encoding))
+			{
+				frame.push_back(key ? 0x65 : 0x41);
+			}
+			else
+			{
+				frame.push_back(key ? 19 << 1 : 1 << 1);
+				frame.push_back(0x01);
+			}
+
+			// payload without zero byte(no start code emulation)
+			bytes = rand() % 2 ? rand() % 200 : rand() % (key ? 50000 : 5000);
+			for (j = 0; j < bytes; j++)
+				frame.push_back((uint8_t)(rand() | 0x01));
+		}
+	}
+	else
+	{
+		bytes = 1 + rand() % (key ? 20000 : 3000);
+		for (i = 0; i < bytes; i++)
+			frame.push_back((uint8_t)rand());
+	}
+}
+
+static void rtp_payload_batch_test2(int payload, const char* encoding)
+{
+	int i, j, r, total;
+	uint16_t seq[2];
+	uint32_t timestamp[2];
+	void* encoder[2];
+	std::vector<uint8_t> frame;
+	std::vector<uint8_t> arena;
+	std::vector<struct rtp_payload_packet_t> pkts;
+	struct rtp_payload_batch_t batch;
+	struct rtp_payload_batch_test_t ctx;
+	struct rtp_payload_t handler;
+
+	handler.alloc = rtp_alloc;
+	handler.free = rtp_free;
+	handler.packet = rtp_encode_packet;
+	encoder[0] = rtp_payload_encode_create(payload, encoding, 1000, RTP_SSRC, &handler, &ctx);
+	encoder[1] = rtp_payload_encode_create(payload, encoding, 1000, RTP_SSRC, NULL, NULL); // batch only
+	assert(encoder[0] && encoder[1]);
+
+	arena.resize(4 * 1024 * 1024);
+	pkts.resize(4096);
+	memset(&batch, 0, sizeof(batch));
+	batch.arena = arena.data();
+	batch.capacity = (int)arena.size();
+	batch.pkts = pkts.data();
+	batch.num = (int)pkts.size();
+
+	srand(1);
+	for (total = i = 0; i < N; i++)
+	{
+		rtp_payload_batch_frame(frame, encoding, 0 == i % 25);
+
+		ctx.packets.clear();
+		ctx.timestamps.clear();
+		ctx.flags.clear();
+		r = rtp_payload_encode_input(encoder[0], frame.data(), (int)frame.size(), i * 3600);
+		assert(0 == r && ctx.packets.size() > 0);
+
+		// two frames per arena, new packets are appended
+		if (0 == i % 2)
+			batch.offset = batch.count = total = 0;
+		r = rtp_payload_encode_batch(encoder[1], &batch, frame.data(), (int)frame.size(), i * 3600);
+		assert(r == (int)ctx.packets.size());
+
+		for (j = 0; j < r; j++)
+		{
+			assert(batch.pkts[total + j].bytes == (int)ctx.packets[j].size());
+			assert(0 == memcmp(batch.pkts[total + j].ptr, ctx.packets[j].data(), ctx.packets[j].size()));
+			assert(batch.pkts[total + j].timestamp == ctx.timestamps[j]);
+			assert(batch.pkts[total + j].flags == ctx.flags[j]);
+		}
+		total += r;
+		assert(total == batch.count);
+		assert(batch.pkts[total - 1].ptr + batch.pkts[total - 1].bytes == batch.arena + batch.offset);
+
+		rtp_payload_encode_getinfo(encoder[0], &seq[0], &timestamp[0]);
+		rtp_payload_encode_getinfo(encoder[1], &seq[1], &timestamp[1]);
+		assert(seq[0] == seq[1] && timestamp[0] == timestamp[1]);
+	}
+
+	// arena too small: partially encoded, packets are valid
+	rtp_payload_batch_frame(frame, encoding, 1);
+	batch.offset = batch.count = 0;
+	batch.capacity = 1000;
+	r = rtp_payload_encode_batch(encoder[1], &batch, frame.data(), (int)frame.size(), N * 3600);
+	assert(-E2BIG == r && batch.offset <= batch.capacity);
+
+	rtp_payload_encode_destroy(encoder[0]);
+	rtp_payload_encode_destroy(encoder[1]);
+}
+
+// rtp_payload_encode_batch packets same as rtp_payload_encode_input
+void rtp_payload_batch_test(void)
+{
+	rtp_payload_batch_test2(96, "H264");
+	rtp_payload_batch_test2(96, "H265");
+	rtp_payload_batch_test2(96, "MP4V-ES");
+	rtp_payload_batch_test2(96, "MP4A-LATM");
+	rtp_payload_batch_test2(96, "mpeg4-generic");
+	rtp_payload_batch_test2(96, "VP8");
+	rtp_payload_batch_test2(96, "VP9");
+	rtp_payload_batch_test2(RTP_PAYLOAD_MP2T, "MP2T");
+}
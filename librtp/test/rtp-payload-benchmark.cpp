@@ -0,0 +1,121 @@
+#include "rtp-payload.h"
+#include "rtp-profile.h"
+#include "sys/system.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define N_FRAME_BYTES (200 * 1024) // 1080p IDR frame
+#define N_BYTES (1024 * 1024 * 1024) // total bytes per encoding
+
+struct rtp_payload_benchmark_t
+{
+	int packets;
+	uint8_t packet[64 * 1024];
+};
+
+static void* rtp_payload_benchmark_alloc(void* param, int bytes)
+{
+	struct rtp_payload_benchmark_t* ctx = (struct rtp_payload_benchmark_t*)param;
+	assert(bytes <= (int)sizeof(ctx->packet));
+	return ctx->packet;
+}
+
+static void rtp_payload_benchmark_free(void* /*param*/, void* /*packet*/)
+{
+}
+
+static int rtp_payload_benchmark_packet(void* param, const void* /*packet*/, int /*bytes*/, uint32_t /*timestamp*/, int /*flags*/)
+{
+	struct rtp_payload_benchmark_t* ctx = (struct rtp_payload_benchmark_t*)param;
+	ctx->packets++;
+	return 0;
+}
+
+static uint8_t* leb128_write(uint8_t* p, size_t v)
+{
+	do
+	{
+		*p = (uint8_t)(v & 0x7F);
+		v >>= 7;
+		*p++ |= v ? 0x80 : 0;
+	} while (v);
+	return p;
+}
+
+// H.264/H.265 Annex B: one NALU, VP8/VP9: raw frame, AV1: Annex B temporal unit with one OBU
+static int rtp_payload_benchmark_frame(const char* encoding, uint8_t* frame, int bytes)
+{
+	int i;
+	uint8_t* p;
+	uint8_t tmp[8];
+
+	for (i = 0; i < bytes; i++)
+		frame[i] = (uint8_t)(rand() | 0x01); // no start code
+	
+	if (0 == strcmp("H264", encoding))
+	{
+		memcpy(frame, "\x00\x00\x00\x01\x65", 5); // IDR
+	}
+	else if (0 == strcmp("H265", encoding))
+	{
+		memcpy(frame, "\x00\x00\x00\x01\x26\x01", 6); // IDR_W_RADL
+	}
+	else if (0 == strcmp("AV1", encoding))
+	{
+		// frame_unit_size + obu_length + OBU_FRAME(no obu_size field)
+		i = bytes - 8;
+		p = leb128_write(tmp, (size_t)i);
+		p = leb128_write(frame, (size_t)(i + (p - tmp)));
+		p = leb128_write(p, (size_t)i);
+		*p++ = 0x30; // obu_type: 6-OBU_FRAME
+		bytes = (int)(p - frame) + i - 1;
+	}
+	return bytes;
+}
+
+void rtp_payload_benchmark_test(void)
+{
+	static const char* s_encodings[] = { "H264", "H265", "AV1", "VP8", "VP9", "MP4V-ES" };
+	struct rtp_payload_benchmark_t ctx;
+	struct rtp_payload_t handler;
+	uint64_t clock;
+	uint8_t* frame;
+	void* encoder;
+	int i, j, n, r, bytes;
+
+	handler.alloc = rtp_payload_benchmark_alloc;
+	handler.free = rtp_payload_benchmark_free;
+	handler.packet = rtp_payload_benchmark_packet;
+
+	frame = (uint8_t*)malloc(N_FRAME_BYTES);
+	for (i = 0; i < (int)(sizeof(s_encodings) / sizeof(s_encodings[0])); i++)
+	{
+		bytes = rtp_payload_benchmark_frame(s_encodings[i], frame, N_FRAME_BYTES);
+		encoder = rtp_payload_encode_create(96, s_encodings[i], 0, 0x12345678, &handler, &ctx);
+		if (!encoder)
+			continue;
+
+		ctx.packets = 0;
+		n = N_BYTES / bytes;
+		clock = system_clock();
+		for (j = 0; j < n; j++)
+		{
+			r = rtp_payload_encode_input(encoder, frame, bytes, (uint32_t)j * 3000);
+			if (0 != r)
+			{
+				printf("rtp packer %s frame %d encode error: %d\n", s_encodings[i], j, r);
+				rtp_payload_encode_destroy(encoder);
+				free(frame);
+				return;
+			}
+		}
+		clock = system_clock() - clock;
+		rtp_payload_encode_destroy(encoder);
+
+		printf("rtp packer %-8s %d frames, %d packets, %u ms, %.0f packets/s, %.1f MB/s\n", s_encodings[i], n, ctx.packets, (unsigned int)clock,
+			clock ? (double)ctx.packets * 1000 / clock : 0.0, clock ? (double)bytes * n / 1024 / 1024 * 1000 / clock : 0.0);
+	}
+	free(frame);
+}
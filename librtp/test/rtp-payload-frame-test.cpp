@@ -0,0 +1,383 @@
+#include "rtp-payload.h"
+#include "rtp-packet.h"
+#include "rtp-demuxer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <vector>
+
+#define N 300 // frame count
+#define GOP 10 // key frame interval
+#define MTU 1400 // max RTP payload
+#define RTP_LOST 10 // 10% frames lost one packet
+
+#define RTP_PAYLOAD_TYPE 96
+#define RTP_SSRC 0x12345678
+
+struct rtp_payload_frame_test_t
+{
+	int h265;
+	int avcc;
+	int setflags; // 1-rtp_payload_decode_setflags(start code, decoder internal buffer)
+	uint16_t seq;
+
+	// one frame
+	std::vector<std::vector<uint8_t> > nalus;
+	std::vector<std::vector<uint8_t> > packets;
+	std::vector<int> owners; // packet -> nalu index, STAP-A/AP: -count(nalus [0, count))
+	std::vector<int> lost; // lost nalus
+	int dropped; // lost packet index, -1 if none
+
+	// access unit callback
+	std::vector<uint8_t> frame;
+	uint32_t timestamp;
+	int flags;
+	int count;
+	int buffers;
+
+	int count_lost;
+};
+
+static int rtp_payload_frame_onpacket(void* param, const void* packet, int bytes, uint32_t timestamp, int flags)
+{
+	struct rtp_payload_frame_test_t* test = (struct rtp_payload_frame_test_t*)param;
+	test->frame.assign((const uint8_t*)packet, (const uint8_t*)packet + bytes);
+	test->timestamp = timestamp;
+	test->flags = flags;
+	test->count++;
+	return 0;
+}
+
+static void* rtp_payload_frame_alloc(void* param, int bytes, int* capacity)
+{
+	struct rtp_payload_frame_test_t* test = (struct rtp_payload_frame_test_t*)param;
+	test->buffers++;
+	*capacity = bytes * 2; // decoder uses all of it
+	return malloc(*capacity);
+}
+
+static void rtp_payload_frame_free(void* param, void* frame)
+{
+	struct rtp_payload_frame_test_t* test = (struct rtp_payload_frame_test_t*)param;
+	test->buffers--;
+	free(frame);
+}
+
+static void rtp_payload_frame_packet(struct rtp_payload_frame_test_t* test, const std::vector<uint8_t>& payload, uint32_t timestamp, int marker, int owner)
+{
+	rtp_header_t rtp;
+	uint8_t header[RTP_FIXED_HEADER];
+	std::vector<uint8_t> packet(RTP_FIXED_HEADER);
+
+	memset(&rtp, 0, sizeof(rtp));
+	rtp.m = marker ? 1 : 0;
+	rtp.seq = test->seq++;
+	rtp.timestamp = timestamp;
+	rtp_packet_header_template(header, RTP_PAYLOAD_TYPE, RTP_SSRC);
+	rtp_packet_header_write(&packet[0], header, &rtp);
+	packet.insert(packet.end(), payload.begin(), payload.end());
+
+	test->packets.push_back(packet);
+	test->owners.push_back(owner);
+}
+
+/// H.264: F|NRI|Type, H.265: F|Type|LayerId|TID
+static void rtp_payload_frame_nalu(struct rtp_payload_frame_test_t* test, int type, int bytes)
+{
+	std::vector<uint8_t> nalu;
+	if (test->h265)
+	{
+		nalu.push_back((uint8_t)(type << 1));
+		nalu.push_back(0x01);
+	}
+	else
+	{
+		nalu.push_back((uint8_t)(0x60 | type));
+	}
+
+	while ((int)nalu.size() < bytes)
+		nalu.push_back((uint8_t)rand());
+	test->nalus.push_back(nalu);
+}
+
+/// single NAL unit or FU-A(H.264)/FU(H.265)
+static void rtp_payload_frame_slice(struct rtp_payload_frame_test_t* test, int i, uint32_t timestamp, int marker)
+{
+	int n, type;
+	size_t offset, bytes;
+	std::vector<uint8_t> payload;
+	const std::vector<uint8_t>& nalu = test->nalus[i];
+
+	if (nalu.size() <= MTU)
+	{
+		rtp_payload_frame_packet(test, nalu, timestamp, marker, i);
+		return;
+	}
+
+	n = test->h265 ? 2 : 1; // NAL unit header
+	type = test->h265 ? ((nalu[0] >> 1) & 0x3F) : (nalu[0] & 0x1F);
+	for (offset = n; offset < nalu.size(); offset += bytes)
+	{
+		bytes = nalu.size() - offset > MTU - 3 ? MTU - 3 : nalu.size() - offset;
+
+		payload.clear();
+		if (test->h265)
+		{
+			payload.push_back((uint8_t)((49 << 1) | (nalu[0] & 0x81)));
+			payload.push_back(nalu[1]);
+		}
+		else
+		{
+			payload.push_back((uint8_t)((nalu[0] & 0xE0) | 28));
+		}
+		payload.push_back((uint8_t)((offset == (size_t)n ? 0x80 : 0) | (offset + bytes == nalu.size() ? 0x40 : 0) | type));
+		payload.insert(payload.end(), nalu.begin() + offset, nalu.begin() + offset + bytes);
+		rtp_payload_frame_packet(test, payload, timestamp, marker && offset + bytes == nalu.size(), i);
+	}
+}
+
+/// STAP-A(H.264)/AP(H.265) with parameter sets
+static void rtp_payload_frame_stap(struct rtp_payload_frame_test_t* test, int count, uint32_t timestamp)
+{
+	int i;
+	std::vector<uint8_t> payload;
+	if (test->h265)
+	{
+		payload.push_back(48 << 1);
+		payload.push_back(0x01);
+	}
+	else
+	{
+		payload.push_back(0x60 | 24);
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		payload.push_back((uint8_t)(test->nalus[i].size() >> 8));
+		payload.push_back((uint8_t)test->nalus[i].size());
+		payload.insert(payload.end(), test->nalus[i].begin(), test->nalus[i].end());
+	}
+	rtp_payload_frame_packet(test, payload, timestamp, 0, -count);
+}
+
+static void rtp_payload_frame_build(struct rtp_payload_frame_test_t* test, int key, uint32_t timestamp)
+{
+	int i, ps, type, slices;
+	// H.265: IDR_W_RADL/IDR_N_LP/CRA/BLA_W_LP, TRAIL_R/TRAIL_N/RASL_R
+	static const int s_irap[] = { 19, 20, 21, 16 };
+	static const int s_slice[] = { 1, 0, 9 };
+
+	test->nalus.clear();
+	test->packets.clear();
+	test->owners.clear();
+
+	ps = 0;
+	if (key)
+	{
+		if (test->h265)
+			rtp_payload_frame_nalu(test, 32, 24); // VPS
+		rtp_payload_frame_nalu(test, test->h265 ? 33 : 7, 10 + rand() % 30); // SPS
+		rtp_payload_frame_nalu(test, test->h265 ? 34 : 8, 4 + rand() % 4); // PPS
+		ps = (int)test->nalus.size();
+		rtp_payload_frame_stap(test, ps, timestamp);
+	}
+
+	type = test->h265 ? (key ? s_irap[rand() % 4] : s_slice[rand() % 3]) : (key ? 5 : 1);
+	slices = 1 + rand() % 4;
+	for (i = 0; i < slices; i++)
+		rtp_payload_frame_nalu(test, type, 3 + rand() % (key ? 20000 : 4000));
+	for (i = ps; i < ps + slices; i++)
+		rtp_payload_frame_slice(test, i, timestamp, i + 1 == ps + slices);
+}
+
+/// drop one packet(except the marker packet), the decoder discards the NALU of the packet
+/// @return RTP_PAYLOAD_FLAG_PACKET_LOST if dropped
+static int rtp_payload_frame_lost(struct rtp_payload_frame_test_t* test)
+{
+	int i, j;
+
+	test->lost.clear();
+	test->dropped = -1;
+	if (test->packets.size() < 2 || rand() % 100 >= RTP_LOST)
+		return 0;
+
+	i = rand() % (int)(test->packets.size() - 1);
+	if (test->owners[i] < 0)
+	{
+		for (j = 0; j < -test->owners[i]; j++)
+			test->lost.push_back(j);
+	}
+	else
+	{
+		test->lost.push_back(test->owners[i]);
+	}
+
+	test->packets.erase(test->packets.begin() + i);
+	test->dropped = i;
+	test->count_lost++;
+	return RTP_PAYLOAD_FLAG_PACKET_LOST;
+}
+
+/// 4-bytes start code or NALU length + NALU
+static std::vector<uint8_t> rtp_payload_frame_expect(const struct rtp_payload_frame_test_t* test)
+{
+	size_t i, j;
+	uint32_t n;
+	std::vector<uint8_t> au;
+	for (i = 0; i < test->nalus.size(); i++)
+	{
+		for (j = 0; j < test->lost.size() && (size_t)test->lost[j] != i; j++)
+		{
+		}
+		if (j < test->lost.size())
+			continue;
+
+		n = (uint32_t)test->nalus[i].size();
+		au.push_back(test->avcc ? (uint8_t)(n >> 24) : 0x00);
+		au.push_back(test->avcc ? (uint8_t)(n >> 16) : 0x00);
+		au.push_back(test->avcc ? (uint8_t)(n >> 8) : 0x00);
+		au.push_back(test->avcc ? (uint8_t)n : 0x01);
+		au.insert(au.end(), test->nalus[i].begin(), test->nalus[i].end());
+	}
+	return au;
+}
+
+/// IDR(H.264)/IRAP(H.265) NALU with the first packet received, include damaged slice
+static int rtp_payload_frame_keyframe(const struct rtp_payload_frame_test_t* test)
+{
+	int type;
+	size_t i, j;
+	for (i = 0; i < test->nalus.size(); i++)
+	{
+		type = test->h265 ? ((test->nalus[i][0] >> 1) & 0x3F) : (test->nalus[i][0] & 0x1F);
+		if (test->h265 ? (type < 16 || type > 23) : 5 != type)
+			continue;
+
+		for (j = 0; j < test->owners.size() && test->owners[j] != (int)i; j++)
+		{
+		}
+		if ((int)j != test->dropped)
+			return RTP_PAYLOAD_FLAG_KEYFRAME;
+	}
+	return 0;
+}
+
+static void rtp_payload_frame_test2(struct rtp_payload_frame_test_t* test)
+{
+	int i, r, lost, frames;
+	size_t j;
+	void* decoder;
+	uint32_t timestamp;
+	std::vector<uint8_t> expect;
+	struct rtp_payload_t handler;
+	struct rtp_payload_frame_t frame;
+
+	memset(&handler, 0, sizeof(handler));
+	handler.packet = rtp_payload_frame_onpacket;
+	decoder = rtp_payload_decode_create(RTP_PAYLOAD_TYPE, test->h265 ? "H265" : "H264", &handler, test);
+	assert(decoder);
+
+	if (test->setflags)
+	{
+		r = rtp_payload_decode_setflags(decoder, RTP_PAYLOAD_DECODE_FLAG_ACCESS_UNIT);
+	}
+	else
+	{
+		// avcc: caller frame buffer, start code: decoder internal buffer
+		memset(&frame, 0, sizeof(frame));
+		frame.alloc = test->avcc ? rtp_payload_frame_alloc : NULL;
+		frame.free = test->avcc ? rtp_payload_frame_free : NULL;
+		frame.avcc = test->avcc;
+		r = rtp_payload_decode_setframe(decoder, &frame);
+	}
+	assert(0 == r);
+
+	srand(1);
+	test->seq = 65000; // sequence number wrap
+	test->count = 0;
+	test->buffers = 0;
+	test->count_lost = 0;
+	for (frames = lost = i = 0; i < N; i++)
+	{
+		timestamp = 0xFFFF0000 + i * 3600; // timestamp wrap
+		rtp_payload_frame_build(test, 0 == i % GOP, timestamp);
+		lost |= rtp_payload_frame_lost(test);
+		expect = rtp_payload_frame_expect(test);
+		frames += expect.empty() ? 0 : 1; // all NALUs lost: no callback, lost flag on the next frame
+
+		for (j = 0; j < test->packets.size(); j++)
+		{
+			r = rtp_payload_decode_input(decoder, &test->packets[j][0], (int)test->packets[j].size());
+			assert(r >= 0);
+			assert(test->count == frames - (j + 1 == test->packets.size() || expect.empty() ? 0 : 1)); // one callback per access unit
+		}
+
+		if (expect.empty())
+			continue;
+		assert(timestamp == test->timestamp);
+		assert((lost | rtp_payload_frame_keyframe(test)) == test->flags);
+		assert(expect == test->frame);
+		assert(0 == test->buffers); // frame released after callback
+		lost = 0;
+	}
+
+	printf("rtp payload frame(%s, %s): frames: %d, lost: %d\n", test->h265 ? "H265" : "H264", test->setflags ? "setflags" : (test->avcc ? "avcc" : "annexb"), test->count, test->count_lost);
+	rtp_payload_decode_destroy(decoder);
+}
+
+static int rtp_payload_frame_ondemuxer(void* param, const void* packet, int bytes, uint32_t timestamp, int flags)
+{
+	return rtp_payload_frame_onpacket(param, packet, bytes, timestamp, flags);
+}
+
+/// rtp_demuxer_setflags: in-order packets, no loss
+static void rtp_payload_frame_demuxer_test(struct rtp_payload_frame_test_t* test)
+{
+	int i, r;
+	size_t j;
+	uint32_t timestamp;
+	struct rtp_demuxer_t* demuxer;
+
+	demuxer = rtp_demuxer_create(100, 90000, RTP_PAYLOAD_TYPE, test->h265 ? "H265" : "H264", rtp_payload_frame_ondemuxer, test);
+	assert(demuxer);
+	r = rtp_demuxer_setflags(demuxer, RTP_PAYLOAD_DECODE_FLAG_ACCESS_UNIT);
+	assert(0 == r);
+
+	test->avcc = 0;
+	test->seq = 100;
+	test->count = 0;
+	test->lost.clear();
+	test->dropped = -1;
+	for (i = 0; i < 2 * GOP; i++)
+	{
+		timestamp = i * 3600;
+		rtp_payload_frame_build(test, 0 == i % GOP, timestamp);
+		for (j = 0; j < test->packets.size(); j++)
+		{
+			r = rtp_demuxer_input(demuxer, &test->packets[j][0], (int)test->packets[j].size());
+			assert(r >= 0);
+		}
+		assert(i + 1 == test->count && timestamp == test->timestamp);
+		assert(rtp_payload_frame_keyframe(test) == test->flags && rtp_payload_frame_expect(test) == test->frame);
+	}
+
+	rtp_demuxer_destroy(&demuxer);
+}
+
+void rtp_payload_frame_test(void)
+{
+	struct rtp_payload_frame_test_t test;
+	for (test.h265 = 0; test.h265 < 2; test.h265++)
+	{
+		test.setflags = 0;
+		for (test.avcc = 0; test.avcc < 2; test.avcc++)
+			rtp_payload_frame_test2(&test);
+
+		test.avcc = 0;
+		test.setflags = 1;
+		rtp_payload_frame_test2(&test);
+		rtp_payload_frame_demuxer_test(&test);
+	}
+}
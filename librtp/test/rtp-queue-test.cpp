@@ -1,4 +1,5 @@
 #include "rtp-queue.h"
+#include "sys/system.h"
 #include <time.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -6,6 +7,7 @@
 #include <string.h>
 #include <assert.h>
 #include <vector>
+#include <algorithm>
 
 #define N 10000 // count
 #define Q 400	// timestamp queue length, Q > RTP_MISORDER
@@ -162,3 +164,75 @@ void rtp_queue_test2(void)
 
 	//assert(test.input_lost == test.output_lost);
 }
+
+static void rtp_packet_free_none(void* param, struct rtp_packet_t* pkt)
+{
+	++*(int*)param; (void)pkt; // packets are owned by the benchmark
+}
+
+/// jitter buffer stress, e.g. 20Mbps/1200 bytes ~ 2000 packets/s
+/// @param[in] lost packet lost rate, 1/1000
+/// @param[in] reorder packet reorder rate, 1/1000
+/// @param[in] duplicate packet duplicate rate, 1/1000
+/// @param[in] distance max reorder distance(packets)
+void rtp_queue_benchmark_test(int lost, int reorder, int duplicate, int distance)
+{
+	const int n = 2000000;
+	std::vector<std::pair<double, uint32_t> > order;
+	std::vector<uint32_t> seqs;
+	std::vector<struct rtp_packet_t> pkts;
+	struct rtp_packet_t* pkt;
+	int i, r, freed, output, discard;
+	uint16_t last;
+	uint64_t clock;
+
+	// arrival order: reordered/duplicated packets are delayed by 1~distance packets
+	srand(1);
+	for (i = 0; i < n; i++)
+	{
+		if (rand() % 1000 < lost)
+			continue;
+
+		if (rand() % 1000 < reorder)
+			order.push_back(std::make_pair(i + 1 + rand() % (distance > 0 ? distance : 1) + 0.5, (uint32_t)i));
+		else
+			order.push_back(std::make_pair((double)i, (uint32_t)i));
+
+		if (rand() % 1000 < duplicate)
+			order.push_back(std::make_pair(i + 1 + rand() % (distance > 0 ? distance : 1) + 0.5, (uint32_t)i));
+	}
+	std::stable_sort(order.begin(), order.end());
+	for (i = 0; i < (int)order.size(); i++)
+		seqs.push_back(order[i].second);
+
+	pkts.resize(seqs.size());
+	memset(&pkts[0], 0, sizeof(pkts[0]) * pkts.size());
+	for (i = 0; i < (int)seqs.size(); i++)
+	{
+		pkts[i].rtp.seq = (uint16_t)seqs[i];
+		pkts[i].rtp.timestamp = seqs[i] * 45; // 90kHz, 2000 packets/s
+	}
+
+	freed = output = discard = 0;
+	last = (uint16_t)(seqs[0] - 1);
+	rtp_queue_t* q = rtp_queue_create(100, 90000, rtp_packet_free_none, &freed);
+	clock = system_clock();
+	for (i = 0; i < (int)pkts.size(); i++)
+	{
+		r = rtp_queue_write(q, &pkts[i]);
+		if (r < 1)
+			discard++;
+
+		for (pkt = rtp_queue_read(q); pkt; pkt = rtp_queue_read(q))
+		{
+			assert((int16_t)(pkt->rtp.seq - last) > 0); // in order, no duplicate
+			last = (uint16_t)pkt->rtp.seq;
+			output++;
+		}
+	}
+	clock = system_clock() - clock;
+	rtp_queue_destroy(q);
+
+	printf("rtp_queue lost: %d, reorder: %d, duplicate: %d (1/1000), distance: %d, input: %d, output: %d, discard: %d, queued: %d, %u ms, %.1f ns/packet\n",
+		lost, reorder, duplicate, distance, (int)pkts.size(), output, discard, freed, (unsigned int)clock, (double)clock * 1000000 / pkts.size());
+}
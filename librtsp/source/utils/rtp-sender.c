@@ -3,8 +3,15 @@
 #include "rtp-payload.h"
 #include "rtp.h"
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <assert.h>
+#include <errno.h>
+
+static inline uint16_t rtp_read_seq(const void* packet)
+{
+    return (uint16_t)((((const uint8_t*)packet)[2] << 8) | ((const uint8_t*)packet)[3]);
+}
 
 #if defined(OS_WINDOWS)
     #if !defined(strcasecmp)
@@ -37,22 +44,132 @@ static void rtp_free(void* param, void *packet)
     assert(s->buffer == packet);
 }
 
-static int rtp_packet(void* param, const void *packet, int bytes, uint32_t timestamp, int flags)
+static void rtp_sender_history_save(struct rtp_sender_t* s, const void *packet, int bytes, uint32_t timestamp, int flags)
+{
+    void* ptr;
+    struct rtp_sender_history_t* h;
+
+    if (!s->history || bytes < 4)
+        return;
+
+    // slot buffers are reused, no allocation after warm-up
+    h = &s->history[rtp_read_seq(packet) % RTP_SENDER_HISTORY];
+    if (h->capacity < bytes)
+    {
+        ptr = realloc(h->ptr, bytes);
+        if (!ptr)
+        {
+            h->bytes = 0;
+            return;
+        }
+        h->ptr = (uint8_t*)ptr;
+        h->capacity = bytes;
+    }
+
+    memcpy(h->ptr, packet, bytes);
+    h->seq = rtp_read_seq(packet);
+    h->timestamp = timestamp;
+    h->flags = flags;
+    h->bytes = bytes;
+}
+
+static void rtp_sender_retransmit(struct rtp_sender_t* s, uint16_t seq)
+{
+    struct rtp_sender_history_t* h;
+
+    if (!s->history)
+        return;
+
+    h = &s->history[seq % RTP_SENDER_HISTORY];
+    if (h->bytes < 1 || h->seq != seq)
+        return; // too old, overwritten by newer packet
+
+    // same SSRC and sequence number, the receiver jitter buffer drop duplicate packet
+    s->onpacket(s->param, h->ptr, h->bytes, h->timestamp, h->flags);
+}
+
+static int rtp_sender_onpacket(struct rtp_sender_t* s, const void *packet, int bytes, uint32_t timestamp, int flags)
 {
-    struct rtp_sender_t* s = (struct rtp_sender_t*)param;
-    assert(s->buffer == packet);
-    
     int r = s->onpacket(s->param, packet, bytes, timestamp, flags);
     if(r == bytes)
+    {
         rtp_onsend(s->rtp, packet, bytes/*, time*/);
+        rtp_sender_history_save(s, packet, bytes, timestamp, flags);
+    }
     return r == bytes ? 0 : -1;
 }
 
+static int rtp_packet(void* param, const void *packet, int bytes, uint32_t timestamp, int flags)
+{
+    struct rtp_sender_t* s = (struct rtp_sender_t*)param;
+    assert(s->buffer == packet);
+    return rtp_sender_onpacket(s, packet, bytes, timestamp, flags);
+}
+
+static int rtp_sender_batch_reserve(struct rtp_sender_t* s, int bytes)
+{
+    int num, capacity;
+    void* ptr;
+
+    // fragments + one packet per NALU(e.g. H.264 slices), RTP header + payload header per packet
+    num = bytes / (rtp_packet_getsize() - 64) + 256;
+    capacity = bytes + bytes / 128 + num * 64;
+
+    if (s->batch.num < num)
+    {
+        ptr = realloc(s->batch.pkts, num * sizeof(s->batch.pkts[0]));
+        if (!ptr)
+            return -ENOMEM;
+        s->batch.pkts = (struct rtp_payload_packet_t*)ptr;
+        s->batch.num = num;
+    }
+
+    if (s->batch.capacity < capacity)
+    {
+        ptr = realloc(s->batch.arena, capacity);
+        if (!ptr)
+            return -ENOMEM;
+        s->batch.arena = (uint8_t*)ptr;
+        s->batch.capacity = capacity;
+    }
+
+    s->batch.offset = 0;
+    s->batch.count = 0;
+    return 0;
+}
+
 static void rtp_onrtcp(void* param, const struct rtcp_msg_t* msg)
 {
+    int i;
     struct rtp_sender_t* s = (struct rtp_sender_t*)param;
-    if(RTCP_MSG_BYE == msg->type && s->onbye)
-        s->onbye(param);
+    switch (msg->type)
+    {
+    case RTCP_MSG_BYE:
+        if (s->onbye)
+            s->onbye(param);
+        break;
+
+    case RTCP_MSG_NACK:
+        if (msg->u.nack.media != s->ssrc)
+            break;
+        rtp_sender_retransmit(s, msg->u.nack.pid);
+        for (i = 0; i < 16; i++)
+        {
+            if (msg->u.nack.blp & (1 << i))
+                rtp_sender_retransmit(s, (uint16_t)(msg->u.nack.pid + i + 1));
+        }
+        break;
+
+    case RTCP_MSG_PLI:
+        if (msg->u.pli.media == s->ssrc && s->onkeyframe)
+            s->onkeyframe(s->param);
+        break;
+
+    case RTCP_MSG_FIR:
+        if (msg->u.fir.media == s->ssrc && s->onkeyframe)
+            s->onkeyframe(s->param);
+        break;
+    }
 }
 
 int rtp_sender_init_video(struct rtp_sender_t* s, unsigned short port, int payload, const char* encoding, int frequence, const void* extra, size_t bytes)
@@ -66,7 +183,9 @@ int rtp_sender_init_video(struct rtp_sender_t* s, unsigned short port, int paylo
     };
     
     r = 0;
-    memset(s, 0, sizeof(s));
+    rtp_sender_destroy(s); // re-init, free previous encoder/rtp/history before clear
+    memset(s, 0, offsetof(struct rtp_sender_t, onpacket)); // keep onpacket/onbye/param set before init
+    s->onkeyframe = NULL; // optional, set after init
     s->seq = (uint16_t)rtp_ssrc();
     s->ssrc = rtp_ssrc();
     s->timestamp = rtp_ssrc();
@@ -114,11 +233,12 @@ int rtp_sender_init_video(struct rtp_sender_t* s, unsigned short port, int paylo
     }
     
     s->encoder = rtp_payload_encode_create(payload, s->encoding, s->seq, s->ssrc, &handler, s);
+    s->history = (struct rtp_sender_history_t*)calloc(RTP_SENDER_HISTORY, sizeof(struct rtp_sender_history_t));
     
     event.on_rtcp = rtp_onrtcp;
     s->rtp = rtp_create(&event, s, s->ssrc, s->timestamp, s->frequency, s->bandwidth, 1);
 
-    if (r < 0 || r >= sizeof(s->buffer) || !s->rtp || !s->encoder)
+    if (r < 0 || r >= sizeof(s->buffer) || !s->rtp || !s->encoder || !s->history)
     {
         rtp_sender_destroy(s);
         return -1;
@@ -137,7 +257,9 @@ int rtp_sender_init_audio(struct rtp_sender_t* s, unsigned short port, int paylo
     };
     
     r = 0;
-    memset(s, 0, sizeof(s));
+    rtp_sender_destroy(s); // re-init, free previous encoder/rtp/history before clear
+    memset(s, 0, offsetof(struct rtp_sender_t, onpacket)); // keep onpacket/onbye/param set before init
+    s->onkeyframe = NULL; // optional, set after init
     s->seq = (uint16_t)rtp_ssrc();
     s->ssrc = rtp_ssrc();
     s->timestamp = rtp_ssrc();
@@ -194,11 +316,12 @@ int rtp_sender_init_audio(struct rtp_sender_t* s, unsigned short port, int paylo
     }
 
     s->encoder = rtp_payload_encode_create(payload, s->encoding, s->seq, s->ssrc, &handler, s);
+    s->history = (struct rtp_sender_history_t*)calloc(RTP_SENDER_HISTORY, sizeof(struct rtp_sender_history_t));
 
     event.on_rtcp = rtp_onrtcp;
     s->rtp = rtp_create(&event, s, s->ssrc, s->timestamp, s->frequency, s->bandwidth, 1);
 
-    if (r < 0 || !s->rtp || !s->encoder)
+    if (r < 0 || !s->rtp || !s->encoder || !s->history)
     {
         rtp_sender_destroy(s);
         return -1;
@@ -206,8 +329,34 @@ int rtp_sender_init_audio(struct rtp_sender_t* s, unsigned short port, int paylo
     return r;
 }
 
+int rtp_sender_input(struct rtp_sender_t* s, const void* data, int bytes, uint32_t timestamp)
+{
+    int i, r;
+    struct rtp_payload_packet_t* pkt;
+
+    if (0 != rtp_sender_batch_reserve(s, bytes))
+        return ENOMEM;
+
+    // -E2BIG: frame partially encoded, send encoded packets as the packet callback does
+    r = rtp_payload_encode_batch(s->encoder, &s->batch, data, bytes, timestamp);
+    for (i = 0; i < s->batch.count; i++)
+    {
+        pkt = &s->batch.pkts[i];
+        if (0 != rtp_sender_onpacket(s, pkt->ptr, pkt->bytes, pkt->timestamp, pkt->flags))
+            return -1;
+    }
+    return r < 0 ? r : 0;
+}
+
+int rtp_sender_input_rtcp(struct rtp_sender_t* s, const void* rtcp, int bytes)
+{
+    return rtp_onreceived_rtcp(s->rtp, rtcp, bytes);
+}
+
 int rtp_sender_destroy(struct rtp_sender_t* s)
 {
+    int i;
+
     if (s->rtp)
     {
         rtp_destroy(s->rtp);
@@ -220,5 +369,22 @@ int rtp_sender_destroy(struct rtp_sender_t* s)
         s->encoder = NULL;
     }
 
+    if (s->history)
+    {
+        for (i = 0; i < RTP_SENDER_HISTORY; i++)
+        {
+            if (s->history[i].ptr)
+                free(s->history[i].ptr);
+        }
+        free(s->history);
+        s->history = NULL;
+    }
+
+    if (s->batch.arena)
+        free(s->batch.arena);
+    if (s->batch.pkts)
+        free(s->batch.pkts);
+    memset(&s->batch, 0, sizeof(s->batch));
+
     return 0;
 }
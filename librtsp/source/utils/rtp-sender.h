@@ -3,11 +3,25 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include "rtp-payload.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define RTP_SENDER_HISTORY 512 // packets, power of 2
+
+// sent packet, for RTCP NACK retransmission
+struct rtp_sender_history_t
+{
+    uint16_t seq;
+    uint32_t timestamp;
+    int flags;
+    int bytes;
+    int capacity;
+    uint8_t* ptr;
+};
+
 struct rtp_sender_t
 {
     void* encoder;
@@ -24,16 +38,30 @@ struct rtp_sender_t
     
     uint8_t buffer[2 * 1024]; // for sdp and rtp packet
     
+    struct rtp_sender_history_t* history; // [RTP_SENDER_HISTORY], history[seq % RTP_SENDER_HISTORY]
+    struct rtp_payload_batch_t batch; // rtp_sender_input frame packets
+    
     int (*onpacket)(void* param, const void *packet, int bytes, uint32_t timestamp, int flags);
     void (*onbye)(void* param); // rtcp bye msg
+    void (*onkeyframe)(void* param); // rtcp PLI/FIR msg, optional, set after rtp_sender_init_xxx
     void* param;
 };
 
+/// @param[in] s zero-filled before the first init, init again releases the previous state
 int rtp_sender_init_video(struct rtp_sender_t* s, unsigned short port, int payload, const char* encoding, int frequence, const void* extra, size_t bytes);
 int rtp_sender_init_audio(struct rtp_sender_t* s, unsigned short port, int payload, const char* encoding, int sample_rate, int channel_count, const void* extra, size_t bytes);
 
 int rtp_sender_destroy(struct rtp_sender_t* s);
 
+/// encode one frame into the batch arena(rtp_payload_encode_batch), then send the packets by onpacket
+/// @param[in] timestamp RTP header timestamp
+/// @return 0-ok, ENOMEM-alloc failed, <0-error
+int rtp_sender_input(struct rtp_sender_t* s, const void* data, int bytes, uint32_t timestamp);
+
+/// input RTCP packet from receiver, NACK lost packets are sent by onpacket again
+/// @return 0-ok, <0-error
+int rtp_sender_input_rtcp(struct rtp_sender_t* s, const void* rtcp, int bytes);
+
 #ifdef __cplusplus
 }
 #endif
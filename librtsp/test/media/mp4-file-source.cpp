@@ -5,6 +5,7 @@
 #include "rtp-payload.h"
 #include "sys/system.h"
 #include "sys/path.h"
+#include <string.h>
 #include <assert.h>
 
 extern "C" const struct mov_buffer_t* mov_file_buffer(void);
@@ -15,9 +16,18 @@ MP4FileSource::MP4FileSource(const char *file)
 	m_status = 0;
 	m_clock = 0;
 	m_count = 0;
+	for (int i = 0; i < (int)(sizeof(m_media) / sizeof(m_media[0])); i++)
+		memset(&m_media[i].rtp, 0, sizeof(m_media[i].rtp));
+
+	// map file, sample memory is passed to the rtp packer without copy
+	m_fp = NULL;
+	m_reader = mov_reader_create_mmap(file);
+	if (NULL == m_reader)
+	{
+		m_fp = fopen(file, "rb");
+		m_reader = m_fp ? mov_reader_create(mov_file_buffer(), m_fp) : NULL;
+	}
 
-	m_fp = fopen(file, "rb");
-	m_reader = mov_reader_create(mov_file_buffer(), m_fp);
 	if (m_reader)
 	{
 		struct mov_reader_trackinfo_t info = { MP4OnVideo, MP4OnAudio };
@@ -81,7 +91,7 @@ struct MP4FileSource::media_t* MP4FileSource::FetchNextPacket()
 		struct media_t* m = &m_media[i];
 		while (0 == avpacket_queue_count(m->pkts))
 		{
-			int r = mov_reader_read(m_reader, m_packet, sizeof(m_packet), MP4OnRead, this);
+			int r = m_fp ? mov_reader_read(m_reader, m_packet, sizeof(m_packet), MP4OnRead, this) : mov_reader_read_ref(m_reader, MP4OnRead, this);
 			if (r == 0)
 			{
 				// 0-EOF
@@ -127,6 +137,7 @@ int MP4FileSource::Play()
 
 	m_status = 1;
 	int bytes = 0;
+	const void* data = m_packet;
 	uint64_t clock = system_clock();
 	std::shared_ptr<struct avpacket_t> pkt(avpacket_queue_front(m->pkts), avpacket_release);
 	int64_t dts = pkt->dts < pkt->pts ? pkt->dts : pkt->pts;
@@ -139,6 +150,15 @@ int MP4FileSource::Play()
 
 	if (int64_t(clock - m_clock) + m_dts >= dts)
 	{
+		if (m->keyframe && 0 == (pkt->flags & AVPACKET_FLAG_KEY))
+		{
+			// receiver can't decode until next key frame
+			avpacket_queue_pop(m->pkts);
+			FetchNextPacket();
+			return 1;
+		}
+		m->keyframe = 0;
+
 		if (0 == strcmp("H264", m->rtp.encoding))
 		{
 			// AVC1 -> H.264 byte stream
@@ -154,7 +174,7 @@ int MP4FileSource::Play()
 		else if (0 == strcmp("MP4A-LATM", m->rtp.encoding) || 0 == strcmp("MPEG4-GENERIC", m->rtp.encoding))
 		{
 			// add ADTS header
-			memcpy(m_packet, pkt->data, pkt->size);
+			data = pkt->data;
 			bytes = pkt->size;
 			//printf("[A] pts: %lld, dts: %lld, clock: %llu\n", m_frame.pts, m_frame.dts, clock);
 		}
@@ -168,7 +188,7 @@ int MP4FileSource::Play()
 		m->dts_last = pkt->pts;
 		uint32_t timestamp = m->rtp.timestamp + (uint32_t)((m->dts_last - m->dts_first) * (m->rtp.frequency / 1000) /*kHz*/);
 		//printf("[%d] pts: %lld, dts: %lld, clock: %u\n", pkt->stream, pkt->pts, pkt->dts, timestamp);
-		rtp_payload_encode_input(m->rtp.encoder, m_packet, bytes, timestamp);
+		rtp_sender_input(&m->rtp, data, bytes, timestamp);
 
 		avpacket_queue_pop(m->pkts);
 		sendframe = 1;
@@ -256,6 +276,7 @@ void MP4FileSource::MP4OnVideo(void* param, uint32_t track, uint8_t object, int
 	m->pkts = avpacket_queue_create(100);
 	m->track = track;
 	m->rtcp_clock = 0;
+	m->keyframe = 0;
 	m->dts_first = -1;
 	m->dts_last = -1;
 	m->rtp.onpacket = OnRTPPacket;
@@ -280,6 +301,7 @@ void MP4FileSource::MP4OnVideo(void* param, uint32_t track, uint8_t object, int
 		assert(0);
 		return;
 	}
+	m->rtp.onkeyframe = OnKeyframe;
 
 	n = snprintf((char*)self->m_packet, sizeof(self->m_packet), "%.*sa=control:track%d\n", n, m->rtp.buffer, m->track);
 	self->m_sdp += (const char*)self->m_packet;
@@ -293,6 +315,7 @@ void MP4FileSource::MP4OnAudio(void* param, uint32_t track, uint8_t object, int
 	m->pkts = avpacket_queue_create(100);
 	m->track = track;
 	m->rtcp_clock = 0;
+	m->keyframe = 0;
 	m->dts_first = -1;
 	m->dts_last = -1;
 	m->rtp.onpacket = OnRTPPacket;
@@ -340,11 +363,21 @@ void MP4FileSource::MP4OnRead(void* param, uint32_t track, const void* buffer, s
 {
 	MP4FileSource *self = (MP4FileSource *)param;
 
-	std::shared_ptr<struct avpacket_t> pkt(avpacket_alloc(bytes), avpacket_release);
-	memcpy(pkt->data, buffer, bytes);
+	std::shared_ptr<struct avpacket_t> pkt(avpacket_alloc(self->m_fp ? bytes : 0), avpacket_release);
+	if (self->m_fp)
+	{
+		memcpy(pkt->data, buffer, bytes);
+	}
+	else
+	{
+		// mapped file memory, valid until mov_reader_destroy
+		pkt->data = (uint8_t*)buffer;
+		pkt->size = (int)bytes;
+	}
 	//pkt->codecid = track;
 	pkt->pts = pts;
 	pkt->dts = dts;
+	pkt->flags = (flags & MOV_AV_FLAG_KEYFREAME) ? AVPACKET_FLAG_KEY : 0;
 
 	for (int i = 0; i < self->m_count; i++)
 	{
@@ -359,6 +392,26 @@ void MP4FileSource::MP4OnRead(void* param, uint32_t track, const void* buffer, s
 	}
 }
 
+void MP4FileSource::OnKeyframe(void* param)
+{
+	struct media_t* m = (struct media_t*)param;
+	m->keyframe = 1;
+}
+
+int MP4FileSource::InputRTCP(const char* track, const void* rtcp, size_t bytes)
+{
+	int t = atoi(track + 5/*track*/);
+	for (int i = 0; i < m_count; i++)
+	{
+		struct media_t* m = &m_media[i];
+		if (t != m->track)
+			continue;
+
+		return rtp_sender_input_rtcp(&m->rtp, rtcp, (int)bytes);
+	}
+	return -1;
+}
+
 void MP4FileSource::OnRTCPEvent(const struct rtcp_msg_t* msg)
 {
 	msg;
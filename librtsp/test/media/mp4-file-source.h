@@ -29,6 +29,10 @@ public:
 
 	int SendRTCP(uint64_t clock);
 
+	/// RTCP from client(RR/NACK/PLI/FIR), NACK lost packets are sent again
+	/// @param[in] track SETUP track, e.g. track1
+	int InputRTCP(const char* track, const void* rtcp, size_t bytes);
+
 private:
 	struct media_t;
 	struct media_t* FetchNextPacket();
@@ -39,6 +43,7 @@ private:
 	int SendBye();
 
 	static int OnRTPPacket(void* param, const void *packet, int bytes, uint32_t timestamp, int flags);
+	static void OnKeyframe(void* param);
 
 	static void MP4OnVideo(void* param, uint32_t track, uint8_t object, int width, int height, const void* extra, size_t bytes);
 	static void MP4OnAudio(void* param, uint32_t track, uint8_t object, int channel_count, int bit_per_sample, int sample_rate, const void* extra, size_t bytes);
@@ -68,6 +73,7 @@ private:
 		int64_t dts_first; // first frame timestamp
 		int64_t dts_last; // last frame timestamp
 		uint64_t rtcp_clock;
+		int keyframe; // PLI/FIR, skip to next key frame
 
 		struct avpacket_queue_t* pkts;
 		std::shared_ptr<IRTPTransport> transport;
@@ -9,6 +9,7 @@ extern "C" void rtp_queue_test(void);
 extern "C" void mpeg4_aac_test(void);
 extern "C" void mpeg4_avc_test(void);
 extern "C" void mpeg4_hevc_test(void);
+extern "C" void mpeg_crc32_test(void);
 extern "C" void mp3_header_test(void);
 extern "C" void sdp_a_fmtp_test(void);
 extern "C" void sdp_a_rtpmap_test(void);
@@ -27,12 +28,25 @@ extern "C" void rtsp_push_server();
 extern "C" void rtsp_client_test(const char* host, const char* file);
 extern "C" void http_server_test(const char* ip, int port);
 void rtp_payload_test();
+void rtp_payload_benchmark_test(void);
+void rtp_payload_frame_test(void);
+void rtp_payload_batch_test(void);
+void rtp_feedback_test(void);
+void rtp_member_list_test(void);
+void rtp_member_list_benchmark_test(void);
+void rtp_queue_benchmark_test(int lost, int reorder, int duplicate, int distance);
 
 void mpeg_ts_dec_test(const char* file);
 void mpeg_ts_test(const char* input);
 void mpeg_ps_test(const char* input);
 void flv_2_mpeg_ps_test(const char* flv);
 void mpeg_ps_dec_test(const char* file);
+void mpeg_crc32_benchmark_test(void);
+void mpeg_ts_mpts_benchmark_test(void);
+void mpeg_ts_avcc_test(void);
+void mpeg_ts_pmt_test(void);
+void mpeg_ts_sync_test(void);
+void mpeg_fragment_test(void);
 
 void flv_read_write_test(const char* flv);
 void flv2ts_test(const char* inputFLV, const char* outputTS);
@@ -40,15 +54,19 @@ void ts2flv_test(const char* inputTS, const char* outputFLV);
 void avc2flv_test(const char* inputH264, const char* outputFLV);
 void hevc2flv_test(const char* inputH265, const char* outputFLV);
 void flv_reader_test(const char* file);
+void mpeg4_annexb_benchmark_test(const char* file);
+void flv_writer_iovec_test(void);
 
 void mov_2_flv_test(const char* mp4);
 void mov_reader_test(const char* mp4);
+void mov_reader_benchmark_test(void);
 void mov_writer_test(int w, int h, const char* inflv, const char* outmp4);
 void fmp4_writer_test(int w, int h, const char* inflv, const char* outmp4);
 void mov_writer_h264(const char* h264, int width, int height, const char* mp4);
 void mov_writer_h265(const char* h265, int width, int height, const char* mp4);
 void mov_writer_audio(const char* audio, int type, const char* mp4);
 
+void hls_media_test(void);
 void hls_segmenter_flv(const char* file);
 void hls_segmenter_fmp4_test(const char* file);
 void hls_server_test(const char* ip, int port);
@@ -64,6 +82,8 @@ void rtmp_server_publish_test(const char* flv);
 void rtmp_server_vod_aio_test(const char* flv);
 void rtmp_server_publish_aio_test(const char* flv);
 void rtmp_server_forward_aio_test(const char* ip, int port);
+void rtmp_handshake_benchmark_test(void);
+void rtmp_prepared_test(void);
 
 extern "C" void sip_header_test(void);
 extern "C" void sip_agent_test(void);
@@ -80,9 +100,21 @@ int main(int argc, char* argv[])
 {
 	amf0_test();
 	rtp_queue_test();
+	rtp_payload_frame_test();
+	rtp_payload_batch_test();
+	rtp_feedback_test();
+	rtp_member_list_test();
 	mpeg4_aac_test();
 	mpeg4_avc_test();
 	mpeg4_hevc_test();
+	mpeg_crc32_test();
+	mpeg_ts_avcc_test();
+	mpeg_ts_pmt_test();
+	mpeg_ts_sync_test();
+	mpeg_fragment_test();
+	flv_writer_iovec_test();
+	rtmp_prepared_test();
+	hls_media_test();
 	mp3_header_test();
 	sdp_a_fmtp_test();
 	sdp_a_rtpmap_test();
@@ -105,9 +137,12 @@ int main(int argc, char* argv[])
 	//mpeg_ts_test("hevc_aac.ts");
 	//mpeg_ps_dec_test("sjz.ps");
 	//mpeg_ps_test("sjz.ps");
+	//mpeg_crc32_benchmark_test();
+	//mpeg_ts_mpts_benchmark_test();
 	
 	//mov_2_flv_test("720p.mp4");
 	//mov_reader_test("720p.mp4");
+	//mov_reader_benchmark_test();
 	//mov_writer_test(768, 432, "720p.mp4.flv", "720p.mp4.flv.mp4");
 	//mov_writer_audio("720p.mp4", 1, "aac.mp4");
 	//mov_writer_h264("720p.h264", 1280, 720, "720p.h264.mp4");
@@ -121,6 +156,8 @@ int main(int argc, char* argv[])
 	//avc2flv_test("4k.h264", "out.flv");
 	//hevc2flv_test("BigBuckBunny-3840x2160.h265", "out.flv");
 	//flv_reader_test("out.flv");
+	//mpeg4_annexb_benchmark_test("1080p.h264");
+	//mpeg4_annexb_benchmark_test("BigBuckBunny-3840x2160.h265");
 
 	//hls_segmenter_flv("720p.flv");
 #if defined(_HAVE_FFMPEG_)
@@ -131,6 +168,10 @@ int main(int argc, char* argv[])
 	//hls_server_test(NULL, 80);
 	//http_server_test(NULL, 80);
 
+	//rtp_payload_benchmark_test();
+	//rtp_member_list_benchmark_test();
+	//rtp_queue_benchmark_test(50, 50, 50, 100);
+
 	//rtsp_client_test("192.168.241.129", "test.rtp");
 	//rtsp_example();
 	//rtsp_push_server();
@@ -144,6 +185,7 @@ int main(int argc, char* argv[])
 	//rtmp_server_vod_aio_test("720p.flv");
 	//rtmp_server_publish_aio_test("720p.flv");
 	//rtmp_server_forward_aio_test(NULL, 1935);
+	//rtmp_handshake_benchmark_test();
 
 	//sip_uac_test();
 	//sip_uas_test();